@@ -0,0 +1,10 @@
+-- The script of the scripts command of LobsterBenchmarks: an OnUpdate as small as most game scripts have.
+
+function OnBegin()
+	elapsed = 0
+end
+
+function OnUpdate(dt)
+	elapsed = elapsed + dt
+	transform.WorldPosition.y = math.sin(elapsed / 1000)
+end
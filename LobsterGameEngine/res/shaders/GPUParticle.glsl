@@ -1,14 +1,19 @@
 ///VertexShader
 layout (location = 0) in vec3 in_position;
+layout (location = 1) in float in_size;
+layout (location = 2) in float in_age;  // [0, 1] over the lifetime
+layout (location = 3) in uint in_color;
 out VS_OUT {
     float dist;
+    float size;
+    vec4 color;
 } vs_out;
 
-uniform int EmissionShape;
-
 void main()
 {
-    vs_out.dist = EmissionShape == 0 ? (in_position.y + 1.0) / 2.0 : length(in_position);
+    vs_out.dist = clamp(in_age, 0.0, 1.0);
+    vs_out.size = in_size;
+    vs_out.color = unpackUnorm4x8(in_color);
     gl_Position = sys_world * vec4(in_position, 1.0); 
 }
 
@@ -18,30 +23,21 @@ layout (triangle_strip, max_vertices = 4) out;
 
 in VS_OUT {
     float dist;
+    float size;
+    vec4 color;
 } vs_out[];
 
 out FS_OUT {
     float dist;
     vec2 texcoord;
+    vec4 color;
 } fs_out;
 
-uniform int DeadParticleCount;
-uniform int ParticleCutoff; // [0, 1024]
 uniform float ParticleSize;
 uniform mat4 ParticleOrientation;
 
 void main()
 {
-    // cutoff
-    if(gl_PrimitiveIDIn >= ParticleCutoff) {
-        EndPrimitive();
-        return;
-    }
-    // dead particles
-    if(ParticleCutoff - gl_PrimitiveIDIn < DeadParticleCount) {
-        EndPrimitive();
-        return;
-    }
     vec3 position = gl_in[0].gl_Position.xyz;
     vec3 forward = normalize(position - sys_cameraPosition);
     vec3 up = vec3(0.0, 1.0, 0.0);
@@ -50,28 +46,33 @@ void main()
 
     vec3 unit_right = spriteMat * mat3(ParticleOrientation) * vec3(1, 0, 0);
     vec3 unit_up = spriteMat * mat3(ParticleOrientation) * vec3(0, 1, 0);
+    float size = ParticleSize * vs_out[0].size;
 
-    vec3 a = position - (unit_right - unit_up) * ParticleSize;
+    vec3 a = position - (unit_right - unit_up) * size;
     gl_Position = sys_projection * sys_view * vec4(a, 1.0);
     fs_out.dist = vs_out[0].dist;
+    fs_out.color = vs_out[0].color;
     fs_out.texcoord = vec2(0.0, 0.0);
     EmitVertex();
 
-    vec3 b = position - (unit_right + unit_up) * ParticleSize;
+    vec3 b = position - (unit_right + unit_up) * size;
     gl_Position = sys_projection * sys_view * vec4(b, 1.0);
     fs_out.dist = vs_out[0].dist;
+    fs_out.color = vs_out[0].color;
     fs_out.texcoord = vec2(0.0, 1.0);
     EmitVertex();
 
-    vec3 c = position + (unit_right + unit_up) * ParticleSize;
+    vec3 c = position + (unit_right + unit_up) * size;
     gl_Position = sys_projection * sys_view * vec4(c, 1.0);
     fs_out.dist = vs_out[0].dist;
+    fs_out.color = vs_out[0].color;
     fs_out.texcoord = vec2(1.0, 0.0);
     EmitVertex();
     
-    vec3 d = position + (unit_right - unit_up) * ParticleSize;
+    vec3 d = position + (unit_right - unit_up) * size;
     gl_Position = sys_projection * sys_view * vec4(d, 1.0);
     fs_out.dist = vs_out[0].dist;
+    fs_out.color = vs_out[0].color;
     fs_out.texcoord = vec2(1.0, 1.0);
     EmitVertex();
   
@@ -82,6 +83,7 @@ void main()
 in FS_OUT {
     float dist;
     vec2 texcoord;
+    vec4 color;
 } fs_out;
 out vec4 out_color;
 
@@ -92,7 +94,7 @@ uniform sampler2D ParticleTexture;
 void main()
 {
     vec4 tex_color = texture(ParticleTexture, fs_out.texcoord);
-    vec4 color = mix(ColorStartTransition, ColorEndTransition, fs_out.dist);
+    vec4 color = mix(ColorStartTransition, ColorEndTransition, fs_out.dist) * fs_out.color;
     if(tex_color.a == 0.0) discard;
     out_color = tex_color * color;
 }
\ No newline at end of file
@@ -1,29 +1,58 @@
 ///VertexShader
-layout (location = 0) in vec4 in_data; // <x, y, w, h>
+layout (location = 0) in vec2 in_position;
+layout (location = 1) in vec2 in_texcoord;
+layout (location = 2) in vec4 in_color; // <tint, alpha>
+layout (location = 3) in vec4 in_blend;
+layout (location = 4) in int in_texture;
 out vec2 frag_texcoord;
+out vec4 frag_color;
+out vec4 frag_blend;
+flat out int frag_texture;
 
 void main()
 {
-    frag_texcoord = in_data.zw;
-    gl_Position = sys_projection * sys_world * vec4(in_data.xy, 0.0, 1.0); 
-}  
+    frag_texcoord = in_texcoord;
+    frag_color = in_color;
+    frag_blend = in_blend;
+    frag_texture = in_texture;
+    gl_Position = sys_projection * vec4(in_position, 0.0, 1.0);
+}
 
 ///FragmentShader
 in vec2 frag_texcoord;
+in vec4 frag_color;
+in vec4 frag_blend;
+flat in int frag_texture;
 out vec4 out_color;
 
-uniform float alpha;
-uniform vec4 blend;
 uniform sampler2D sys_background;
-uniform sampler2D sys_spriteTexture;
+uniform sampler2D sys_spriteTextures[8]; // SpriteBatcher::MaxTextures
+
+vec4 spriteColor()
+{
+    // samplers can only be indexed by constants here, the gradients are taken outside the branches
+    vec2 dx = dFdx(frag_texcoord);
+    vec2 dy = dFdy(frag_texcoord);
+    switch (frag_texture) {
+    case 0: return textureGrad(sys_spriteTextures[0], frag_texcoord, dx, dy);
+    case 1: return textureGrad(sys_spriteTextures[1], frag_texcoord, dx, dy);
+    case 2: return textureGrad(sys_spriteTextures[2], frag_texcoord, dx, dy);
+    case 3: return textureGrad(sys_spriteTextures[3], frag_texcoord, dx, dy);
+    case 4: return textureGrad(sys_spriteTextures[4], frag_texcoord, dx, dy);
+    case 5: return textureGrad(sys_spriteTextures[5], frag_texcoord, dx, dy);
+    case 6: return textureGrad(sys_spriteTextures[6], frag_texcoord, dx, dy);
+    default: return textureGrad(sys_spriteTextures[7], frag_texcoord, dx, dy);
+    }
+}
 
 void main()
-{ 
+{
 	vec4 base = texelFetch(sys_background, ivec2(gl_FragCoord.xy), 0);
-    vec4 color = texture(sys_spriteTexture, frag_texcoord);	
-    color = color * (1 - blend.a) + blend * blend.a;
-    color.a *= alpha;
+    vec4 color = spriteColor();
+    color.rgb *= frag_color.rgb;
+    color = color * (1 - frag_blend.a) + frag_blend * frag_blend.a;
+    color.a *= frag_color.a;
 
 	if (color.a < 0.05) discard;
-	out_color = vec4(vec3(color) * color.a + vec3(base) * (1.0 - color.a), 1);    	
+	out_color = vec4(vec3(color) * color.a + vec3(base) * (1.0 - color.a), 1);
 }
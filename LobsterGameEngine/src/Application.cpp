@@ -2,6 +2,8 @@
 #include "Application.h"
 
 #include "system/Input.h"
+#include "system/Random.h"
+#include "system/Replay.h"
 
 //  Placeholder
 #include "audio/AudioSystem.h"
@@ -9,13 +11,25 @@
 #include "components/ComponentCollection.h"
 #include "events/EventDispatcher.h"
 #include "events/EventQueue.h"
+#include "graphics/2D/GameUI.h"
+#include "graphics/2D/GlyphAtlas.h"
+#include "graphics/2D/SpriteBatcher.h"
 #include "graphics/meshes/MeshLoader.h"
+#include "graphics/ParticleSystemManager.h"
 #include "graphics/Renderer.h"
 #include "graphics/Scene.h"
 #include "layer/EditorLayer.h"
 #include "layer/GUILayer.h"
 #include "objects/GameObject.h"
+#include "objects/Prefab.h"
+#include "scripts/Script.h"
+#include "scripts/ScriptProfiler.h"
+#include "scripts/ScriptScheduler.h"
+#include "scripts/ScriptVM.h"
 #include "system/FileSystem.h"
+#include "system/FrameAllocator.h"
+#include "system/MemoryTracker.h"
+#include "system/SlabAllocator.h"
 #include "system/UndoSystem.h"
 
 namespace Lobster
@@ -30,8 +44,12 @@ namespace Lobster
 #endif	
 
     Application::Application() : 
+		m_window(nullptr),
 		m_scene(nullptr),
-		m_renderer(nullptr)
+		m_renderer(nullptr),
+		m_undoSystem(nullptr),
+		m_editorLayer(nullptr),
+		m_GUILayer(nullptr)
     {
         //  Don't touch here, please do all initialization work in Initialize() function
         if(m_instance)
@@ -44,9 +62,11 @@ namespace Lobster
     
     Application::~Application()
     {
+		if (m_autosaveJob.valid()) m_autosaveJob.wait();
 		if (m_renderer) delete m_renderer;
 		if (m_scene) delete m_scene;
 		if (m_undoSystem) delete m_undoSystem;
+		GlyphAtlas::Shutdown();
 		m_renderer = nullptr;
 		m_scene = nullptr;
 		m_undoSystem = nullptr;
@@ -68,28 +88,72 @@ namespace Lobster
 		if (err) throw std::runtime_error("Unable to create directory");
 		LOG("Working Directory: " + m_fileSystem->GetCurrentWorkingDirectory());
 
+		// a headless run plays the game, there is no editor to start it from
+		if (config.headless) mode = GAME;
+
 		// Independent system initialization
+		MemoryTracker::SetBudget(MEMORY_TEXTURE, config.textureBudget * 1048576LL);
+		MemoryTracker::SetBudget(MEMORY_MESH, config.meshBudget * 1048576LL);
+		MemoryTracker::SetBudget(MEMORY_SCRIPT, config.scriptBudget * 1048576LL);
+		MemoryTracker::SetBudget(MEMORY_AUDIO, config.audioBudget * 1048576LL);
 		ThreadPool::Initialize(16);
-		AudioSystem::Initialize();
+		ParticleSystemManager::Initialize(config.particleBudget);
+		AudioSystem::Initialize(config.audioNullDevice, config.audioVoices);
 		PhysicsSystem::Initialize();
 		Profiler::Initialize();
+		if (!config.profileRecordPath.empty()) Profiler::StartRecording();
+		Random::SetSeed(config.randomSeed ? config.randomSeed : (unsigned long long)time(nullptr));
 		EventDispatcher::Initialize();
 		EventQueue::Initialize();
 		Input::Initialize();
+		if (!config.inputReplayPath.empty()) Input::StartReplay(config.inputReplayPath);
+		if (!config.inputRecordPath.empty()) Input::StartRecording();
+		ScriptVM::Initialize();
+		ScriptScheduler::Initialize();
+		// the time budgets defer work by wall clock time, so a capture and its re-simulation would defer different work
+		if (!config.replayCapturePath.empty() || !config.replayPath.empty()) {
+			config.scriptTimeBudget = 0.0;
+			config.eventTimeBudget = 0.0;
+		}
+		ScriptProfiler::Initialize(config.scriptTimeBudget);
 
 		// OpenGL dependent system initialization (Window class create OpenGL context)
-		m_window = new Window(config.width, config.height, config.title, config.vsync);
+		// headless runs have neither: the GPU resources are never created, the libraries only keep their CPU side
+		if (!config.headless) m_window = new Window(config.width, config.height, config.title, config.vsync);
 		TextureLibrary::Initialize();
 		ShaderLibrary::Initialize();
 		MaterialLibrary::Initialize();
 		LightLibrary::Initialize();
+		PrefabLibrary::Initialize();
 		
         //  Initialize Renderer
-        m_renderer = new Renderer();
+        if (!config.headless) m_renderer = new Renderer();
         
 		//	Initialize UndoSystem with length = 50
 		m_undoSystem = new UndoSystem(50);
 
+		if (config.headless) {
+			if (!config.replayPath.empty()) {
+				// the scene and seed of the capture, its frames then drive RunHeadless
+				if (!Replay::LoadPlayback(config.replayPath)) throw std::runtime_error("Unable to load replay " + config.replayPath);
+				const ReplayData& replay = Replay::GetPlayback();
+				OpenScene("");
+				std::stringstream ss(replay.scene);
+				m_scene->Deserialize(ss);
+				std::vector<InputSnapshot> input;
+				for (const ReplayFrame& frame : replay.frames) input.push_back(frame.input);
+				Input::StartReplay(std::move(input));
+				config.headlessFrames = (int)replay.frames.size();
+				Random::SetSeed(replay.seed);
+			}
+			else {
+				OpenScene(config.headlessScene.empty() ? "" : FileSystem::RelativeToAbsolute(FileSystem::Path(config.headlessScene)).c_str());
+				BeginCapture();
+			}
+			m_scene->OnBegin();
+			return;
+		}
+
         //  Initialize GameObjects
 		Timer loadTimer;
 #ifdef LOBSTER_BUILD_EDITOR
@@ -318,6 +382,7 @@ namespace Lobster
 		std::string sceneName = FileSystem::ReadText(FileSystem::Path("output.txt").c_str());
 		LOG(FileSystem::RelativeToAbsolute(FileSystem::Path(sceneName)));
 		OpenScene(FileSystem::RelativeToAbsolute(FileSystem::Path(sceneName)).c_str());
+		BeginCapture();
 		m_scene->OnBegin();
 #endif
 
@@ -335,10 +400,12 @@ namespace Lobster
 	void Application::FixedUpdate(double deltaTime)
 	{ 
 		// application info (config) update
-		int w, h;
-		Input::GetWindowSize(&w, &h);
-		Application::GetInstance()->GetConfig().width = w;
-		Application::GetInstance()->GetConfig().height = h;
+		if (m_window) {
+			int w, h;
+			Input::GetWindowSize(&w, &h);
+			Application::GetInstance()->GetConfig().width = w;
+			Application::GetInstance()->GetConfig().height = h;
+		}
 		//=========================================================
 		// Networking update
 
@@ -372,56 +439,113 @@ namespace Lobster
 
 		//=========================================================
 		// Event update
-		Event* event = EventQueue::GetInstance()->Next();
-		if (event)
+		// drain the queue, events left over when the time budget runs out wait for the next frame
+		auto eventStart = HighResolutionClock::now();
+		while (Event* event = EventQueue::GetInstance()->Next())
 		{
 			EventDispatcher::Dispatch(event);
+			if (config.eventTimeBudget > 0.0 && milliseconds_type(HighResolutionClock::now() - eventStart).count() > config.eventTimeBudget) break;
 		}
+		EventQueueStats eventStats = EventQueue::GetInstance()->ConsumeStats();
+		Profiler::SubmitCounter("Events / Frame", eventStats.dispatched);
+		Profiler::SubmitCounter("Dropped Events / Frame", eventStats.dropped);
+		Profiler::SubmitData("Event Latency (avg)", eventStats.averageLatency);
+		Profiler::SubmitData("Event Latency (max)", eventStats.maxLatency);
 
 		//=========================================================
 		// Scene update
 		Timer sceneUpdateTimer;
 		m_scene->OnUpdate(deltaTime);	// update game scene
+		ParticleSystemManager::Update();	// simulate the particle systems submitted by the scene
+		if (mode == GAME) ScriptScheduler::Update(deltaTime);	// resume coroutines that are due
 		Profiler::SubmitData("Scene Update Time", sceneUpdateTimer.GetElapsedTime());
+		const ParticleStats& particleStats = ParticleSystemManager::GetStats();
+		Profiler::SubmitCounter("Particle Systems", particleStats.systems);
+		Profiler::SubmitCounter("Throttled Particle Systems", particleStats.throttled);
+		Profiler::SubmitCounter("Live Particles", particleStats.liveParticles);
+		Profiler::SubmitCounter("Particle Spawns / s", particleStats.spawnsPerSecond);
+		Profiler::SubmitData("Particle Simulation Time", particleStats.simulationTime);
+		Profiler::SubmitCounter("Sorted Particles", particleStats.sortedParticles);
+		Profiler::SubmitData("Particle Sort Time", particleStats.sortTime);
+		UIStats uiStats = GameUI::ConsumeStats();
+		Profiler::SubmitCounter("UI Sprites", uiStats.sprites);
+		Profiler::SubmitCounter("UI Sprites Generated / Frame", uiStats.generated);
+		Profiler::SubmitCounter("UI Hit Tests / Frame", uiStats.hitTests);
 
 		//=========================================================
 		// Scene late update
 
 		//=========================================================
 		// Audio update
+		AudioSystem::Update(deltaTime);
+		AudioStats audioStats = AudioSystem::ConsumeStats();
+		Profiler::SubmitCounter("Audio Voices", audioStats.activeVoices);
+		Profiler::SubmitCounter("Virtual Audio Voices", audioStats.virtualVoices);
+		Profiler::SubmitCounter("Audio Voice Steals / Frame", audioStats.steals);
+		Profiler::SubmitCounter("Audio Source Updates / Frame", audioStats.sourceUpdates);
+		Profiler::SubmitCounter("Culled Audio Sources", audioStats.culledSources);
 
 		//=========================================================
 		// Renderer update
-		Timer renderTimer;
-		LightLibrary::Update();
-		m_renderer->Render(CameraComponent::GetActiveCamera());
-		Profiler::SubmitData("Render Time", renderTimer.GetElapsedTime());
-		m_renderer->ClearOverlayQueue();
+		if (!config.headless) {
+			Timer renderTimer;
+			LightLibrary::Update();
+			m_renderer->Render(CameraComponent::GetActiveCamera());
+			Profiler::SubmitData("Render Time", renderTimer.GetElapsedTime());
+			Profiler::SubmitCounter("Overlay Sprites", Renderer::GetSpriteBatcher()->GetSpriteCount());
+			Profiler::SubmitCounter("Overlay Draw Calls", Renderer::GetSpriteBatcher()->GetBatchCount());
+		}
+		Renderer::ClearOverlayQueue();
 		//=========================================================
 		// GUI Renderer update
 		#ifdef LOBSTER_BUILD_EDITOR
-		Timer imguiRenderTimer;
-		ImGui::GetIO().DeltaTime = deltaTime;
-		m_editorLayer->OnUpdate(deltaTime);
-		m_renderer->Render(m_editorLayer->GetSceneCamera(), true);
-		m_GUILayer->Begin();
-		m_editorLayer->OnImGuiRender();
-		m_GUILayer->End();
-		Profiler::SubmitData("ImGui Render Time", imguiRenderTimer.GetElapsedTime());
+		if (!config.headless) {
+			Timer imguiRenderTimer;
+			ImGui::GetIO().DeltaTime = deltaTime;
+			m_editorLayer->OnUpdate(deltaTime);
+			m_renderer->Render(m_editorLayer->GetSceneCamera(), true);
+			m_GUILayer->Begin();
+			m_editorLayer->OnImGuiRender();
+			m_GUILayer->End();
+			Profiler::SubmitData("ImGui Render Time", imguiRenderTimer.GetElapsedTime());
+		}
 		#endif
-		m_renderer->ClearAllQueues();
+		Renderer::ClearAllQueues();
 
 		//=========================================================
 		// Window update
 
 		//=========================================================
 		// Memory update
+		m_scene->FlushPending();
+		size_t slabAllocs, slabFrees;
+		SlabAllocator::ConsumeChurn(slabAllocs, slabFrees);
+		Profiler::SubmitCounter("Live GameObjects", GameObject::GetLiveCount());
+		Profiler::SubmitCounter("Slab Allocs / Frame", slabAllocs);
+		Profiler::SubmitCounter("Slab Frees / Frame", slabFrees);
+		size_t heapAllocs, heapFrees;
+		MemoryTracker::ConsumeChurn(heapAllocs, heapFrees);
+		Profiler::SubmitCounter("Heap Allocs / Frame", heapAllocs);
+		Profiler::SubmitCounter("Heap Frees / Frame", heapFrees);
+		Profiler::SubmitCounter("Frame Arena KB", FrameArena::GetBytesUsed() / 1024.0);
+		MemoryTracker::Update();
+		Profiler::SubmitCounter("Lua VM KB", ScriptVM::GetMemoryUsage() / 1024.0);
+		Profiler::SubmitCounter("Lua Alloc KB / Frame", ScriptVM::ConsumeAllocatedBytes() / 1024.0);
+		Profiler::SubmitCounter("Script Updates / Frame", (double)Script::ConsumeUpdateCalls());
+		Profiler::SubmitCounter("Coroutines", (double)ScriptScheduler::GetCoroutineCount());
+		Profiler::SubmitCounter("Coroutine Resumes / Frame", (double)ScriptScheduler::ConsumeResumes());
+		ScriptProfiler::EndFrame();
+		FrameArena::NextFrame();
 		
-		m_window->Swap(); // finish the frame and present it
+		if (m_window) m_window->Swap(); // finish the frame and present it
 	}
 
 	void Application::Run()
 	{
+		if (config.headless) {
+			RunHeadless();
+			return;
+		}
 		Timer timer;
 		double logTime = 0.0;
 		int frames = 0;
@@ -449,19 +573,98 @@ namespace Lobster
 #endif
 
 			accumulateTime += deltaTime;
-			for (int i = 0; i < m_maxFixedUpdates && accumulateTime > intervalTime; ++i)
+			int fixedUpdates = 0;
+			for (; fixedUpdates < m_maxFixedUpdates && accumulateTime > intervalTime; ++fixedUpdates)
 			{
 				FixedUpdate(deltaTime);
 				accumulateTime -= intervalTime;
 			}
 			VariableUpdate(deltaTime);
+			Replay::CaptureFrame(deltaTime, fixedUpdates);
+#ifdef LOBSTER_BUILD_EDITOR
+			Autosave(deltaTime);
+#endif
 
 			frames++;
 			Profiler::SubmitData("Frame Time", frameTime.GetElapsedTime());
+			Profiler::RecordFrame();
+		}
+	}
+
+	// Steps the scene at config.headlessDeltaTime per frame without waiting for real time,
+	// so a run is as fast as the CPU allows and the same on every machine.
+	void Application::RunHeadless()
+	{
+		const std::vector<ReplayFrame>& replayFrames = Replay::GetPlayback().frames;
+		Timer timer;
+		int frames = 0;
+		while (config.headlessFrames <= 0 || frames < config.headlessFrames)
+		{
+			Timer frameTime;
+			// a re-simulation repeats the time steps of the capture
+			double deltaTime = config.headlessDeltaTime;
+			int fixedUpdates = 1;
+			if (frames < (int)replayFrames.size()) {
+				deltaTime = replayFrames[frames].deltaTime;
+				fixedUpdates = replayFrames[frames].fixedUpdates;
+			}
+			for (int i = 0; i < fixedUpdates; i++) FixedUpdate(deltaTime);
+			VariableUpdate(deltaTime);
+			Replay::CaptureFrame(deltaTime, fixedUpdates);
+			frames++;
+			Profiler::SubmitData("Frame Time", frameTime.GetElapsedTime());
+			Profiler::RecordFrame();
 		}
+		double elapsed = timer.GetElapsedTime();
+		INFO("Simulated {} frames in {} ms ({} ms / frame)", frames, elapsed, elapsed / std::max(frames, 1));
+	}
+
+	// Writes unsaved changes next to the scene file every m_autosaveInterval.
+	// The snapshot is taken here, but formatting and writing it happens on the thread pool.
+	void Application::Autosave(double deltaTime)
+	{
+		m_autosaveTime += deltaTime;
+		if (m_autosaveTime < m_autosaveInterval) return;
+		m_autosaveTime = 0.0;
+		if (mode != EDITOR || m_saved || scenePath.empty()) return;
+		// skip this round if the last write is still running
+		if (m_autosaveJob.valid() && m_autosaveJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+
+		Timer snapshotTimer;
+		SceneSnapshot snapshot = m_scene->Snapshot();
+		Profiler::SubmitData("Autosave Snapshot Time", snapshotTimer.GetElapsedTime());
+		// the last job is done, so the file is not in use
+		std::string path = scenePath + ".autosave";
+		if (m_autosaveFile.GetPath() != path) m_autosaveFile = SceneFile(path);
+		SceneFile* file = &m_autosaveFile;
+		m_autosaveJob = ThreadPool::Enqueue([snapshot = std::move(snapshot), file]() {
+			try {
+				file->Write(snapshot);
+			}
+			catch (std::exception e) {
+				WARN("Autosave to {} failed. Reason: {}", file->GetPath(), e.what());
+			}
+		});
+	}
+
+	// Starts capturing the session for re-simulation, if configured. Call right before the scene's OnBegin.
+	void Application::BeginCapture(bool midFrame)
+	{
+		if (config.replayCapturePath.empty() || Replay::IsCapturing()) return;
+		// restart the random streams, a re-simulation starts from the same state
+		Random::SetSeed(Random::GetSeed());
+		Replay::StartCapture(m_scene->Serialize().str(), Random::GetSeed(), midFrame);
+	}
+
+	void Application::EndCapture()
+	{
+		if (Replay::IsCapturing()) Replay::StopCapture(config.replayCapturePath);
 	}
 
 	void Application::SwitchMode(ApplicationMode mode) {
+		// the toolbar switches to GAME during a frame, right before it begins the scene
+		if (mode == GAME) m_instance->BeginCapture(true);
+		else m_instance->EndCapture();
 		m_instance->mode = mode;
 		// TODO switch tab
 		if (mode == EDITOR) {
@@ -474,14 +677,26 @@ namespace Lobster
 
 	void Application::Shutdown()
 	{
+		if (!config.memoryReportPath.empty()) MemoryTracker::Dump(config.memoryReportPath.c_str());
+		if (Input::IsRecording()) Input::StopRecording(config.inputRecordPath);
+		EndCapture();
+		if (!config.profileRecordPath.empty()) Profiler::WriteRecording(config.profileRecordPath.c_str());
+		// joins the audio thread, the null device finishes its files
+		AudioSystem::Shutdown();
 	}
 
-	void Application::OpenScene(const char* scenePath)
+	void Application::OpenScene(const char* scenePath, bool clearLibraries)
 	{
 		if (m_scene) {
 			delete m_scene;
             EditorLayer::s_selectedGameObject = nullptr;
 		}
+		// nothing refers to the cached resources anymore
+		if (clearLibraries) {
+			PrefabLibrary::Clear();
+			MaterialLibrary::Clear();
+			TextureLibrary::Clear();
+		}
 		if (scenePath && scenePath[0] != '\0') {
 			std::string path(scenePath);
 			StringOps::ReplaceAll(path, "\\", "/");
@@ -496,19 +711,21 @@ namespace Lobster
 	}
 
 	Scene* Application::OpenSceneIngame(const char* scenePath) {
-		Scene* temptr = nullptr;
-		temptr = m_scene;
-		if (scenePath && scenePath[0] != '\0') {
-			std::string path(scenePath);
-			StringOps::ReplaceAll(path, "\\", "/");
-			this->scenePath = scenePath;
-			m_scene = new Scene(this->scenePath.c_str());
-		}
-		else {
+		if (!scenePath || scenePath[0] == '\0') {
 			throw std::exception("Empty scenepath cannot be opened.");
 		}
+		// the objects of the old scene give their ids back first, so the loaded ones keep theirs
+		if (m_scene) {
+			delete m_scene;
+			m_scene = nullptr;
+			EditorLayer::s_selectedGameObject = nullptr;
+		}
+		std::string path(scenePath);
+		StringOps::ReplaceAll(path, "\\", "/");
+		this->scenePath = scenePath;
+		m_scene = new Scene(this->scenePath.c_str());
 		Application::GetInstance()->SetScenePath(scenePath);
-		if (temptr) delete temptr;
+		return m_scene;
 	}
 
 	void Application::SetScenePath(const char* scenePath) {
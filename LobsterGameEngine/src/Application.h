@@ -1,6 +1,7 @@
 #pragma once
 #include "layer/LayerStack.h"
 #include "window/Window.h"
+#include "graphics/SceneFile.h"
 
 namespace Lobster
 {
@@ -27,6 +28,40 @@ namespace Lobster
 		glm::vec2 gameTabSize;
 		std::string title = "Lobster Engine";
 		bool vsync = true;
+		// Memory budgets per subsystem in MB, 0 for no budget
+		int textureBudget = 512;
+		int meshBudget = 256;
+		int scriptBudget = 64;
+		int audioBudget = 128;
+		// Lua OnUpdate time per frame in ms after which low priority scripts are deferred, 0 for no budget
+		double scriptTimeBudget = 0.0;
+		// Event dispatch time per frame in ms, the remaining events are dispatched next frame, 0 for no budget
+		double eventTimeBudget = 2.0;
+		// Most particles alive over all particle systems, 0 for no budget. Low priority and distant systems are throttled first
+		int particleBudget = 200000;
+		// If set, memory stats are written to this file on shutdown
+		std::string memoryReportPath;
+		// If set, the input of every frame is recorded to this file on shutdown
+		std::string inputRecordPath;
+		// If set, the input is replayed from this file instead of read from the window
+		std::string inputReplayPath;
+		// Headless mode: no window, rendering or editor, the scene is stepped at a fixed time step as fast as possible
+		bool headless = false;
+		std::string headlessScene;	// scene file relative to the resource directory, empty for an empty scene
+		double headlessDeltaTime = 1000.0 / 60.0;	// ms per simulated frame
+		int headlessFrames = 0;	// frames to simulate before returning from Run(), 0 to run until the process is stopped
+		// Seed of all random streams, 0 for a time based seed
+		unsigned long long randomSeed = 0;
+		// If set, game sessions are captured to this file for re-simulation
+		std::string replayCapturePath;
+		// Headless mode: re-simulate this capture instead of opening headlessScene
+		std::string replayPath;
+		// If set, the profiler data of every frame is written to this CSV file on shutdown
+		std::string profileRecordPath;
+		// Sounds playing at once, the least important of the others are virtual until a voice is free
+		int audioVoices = 32;
+		// If set, no sound device is opened: every audio clip is streamed in real time to a WAV file in this directory
+		std::string audioNullDevice;
 	};
 
     class Application
@@ -46,12 +81,21 @@ namespace Lobster
 		bool m_saved = false;
 		int m_targetFPS = 60;
 		int m_maxFixedUpdates = 10;
+		// Autosave
+		double m_autosaveInterval = 60000.0;	// in ms
+		double m_autosaveTime = 0.0;
+		std::future<void> m_autosaveJob;
+		SceneFile m_autosaveFile;	// only written by m_autosaveJob
 		// Layers
 		//LayerStack m_layerStack;
 		EditorLayer* m_editorLayer; // depends on GUILayer
 		GUILayer* m_GUILayer;
 		void FixedUpdate(double deltaTime);
 		void VariableUpdate(double deltaTime);		
+		void Autosave(double deltaTime);
+		void RunHeadless();
+		void BeginCapture(bool midFrame = false);
+		void EndCapture();
 
     public:
         Application();
@@ -59,7 +103,8 @@ namespace Lobster
         void Initialize();
         void Run();
         void Shutdown();
-		void OpenScene(const char* scenePath);
+		//	clearLibraries also empties the prefab, material and texture caches, once the old scene is gone.
+		void OpenScene(const char* scenePath, bool clearLibraries = false);
 		Scene* OpenSceneIngame(const char* scenePath);
 		void SetScenePath(const char* scenePath);
 		void SetSaved(bool saved);
@@ -67,13 +112,14 @@ namespace Lobster
 		inline Config& GetConfig() { return config; }
         inline Window* GetWindow() { return m_window; }
 		inline Scene* GetCurrentScene() { return m_scene; }
-        inline glm::ivec2 GetWindowSize() { return m_window->GetSize(); }
-        inline float GetWindowAspectRatio() { return (float)m_window->GetSize().x / (float)m_window->GetSize().y; }
+        inline glm::ivec2 GetWindowSize() { return m_window ? m_window->GetSize() : glm::ivec2(config.width, config.height); }
+        inline float GetWindowAspectRatio() { return (float)GetWindowSize().x / (float)GetWindowSize().y; }
 		inline std::string GetScenePath() { return scenePath; }		
 		inline static Application* GetInstance() { return m_instance; }			
 		// Can interchange between editor mode and simulation mode
 		static void SwitchMode(ApplicationMode mode);
 		inline static ApplicationMode GetMode() { return mode; }
+		inline static bool IsHeadless() { return m_instance && m_instance->config.headless; }
     };
     
 }
@@ -1,29 +1,62 @@
 #include "pch.h"
 #include "AudioClip.h"
+#include "AudioStream.h"
+#include "AudioSystem.h"
 
 namespace Lobster {
 
-	AudioClip::AudioClip(const char* name, float pitch, float gain, glm::vec3 pos, glm::vec3 velo, 
+	AudioClip::AudioClip(const char* name, float pitch, float gain, glm::vec3 pos, glm::vec3 velo,
 		bool loop) :
-		m_name(name), m_pitch(pitch), m_gain(gain), m_looping(loop)
+		m_state(AL_INITIAL), m_name(name), m_pitch(pitch), m_gain(gain), m_looping(loop), m_position(pos)
 	{
-		alGenSources((ALsizei)1, &m_source);
-		alGenBuffers((ALsizei)1, &m_buffer);
-		alUpdate();
 	}
 
 	AudioClip::~AudioClip() {
-		// unbind the source
-		alSourcei(m_source, AL_BUFFER, NULL);
-		// remove source and buffer
-		alDeleteSources(1, &m_source);
-		alDeleteBuffers(1, &m_buffer);
+		// the audio thread must be done with the clip first
+		AudioSystem::ForgetClip(this);
+		if (m_stream) delete m_stream;
+		if (b_ownSource && m_source) {
+			alDeleteSources(1, &m_source);
+		}
+		else if (m_source) {
+			AudioSystem::releaseVoice(m_source);
+		}
+		if (m_samples) AudioSystem::releaseSamples(m_samples);
+	}
+
+	SpatialParams AudioClip::spatialParams() const {
+		SpatialParams params;
+		params.source = m_source;
+		params.position = m_position;
+		params.gain = m_mute ? 0.f : m_gain;
+		params.pitch = m_pitch;
+		params.minDistance = m_minDistance;
+		params.maxDistance = m_maxDistance;
+		params.relative = b_relative;
+		return params;
 	}
 
 	void AudioClip::alUpdate() {
-		alSourcef(m_source, AL_PITCH, m_pitch);
-		alSourcef(m_source, AL_GAIN, m_gain);
-		alSourcei(m_source, AL_LOOPING, m_looping);
+		if (m_stream) m_stream->SetLooping(m_looping);
+		if (!m_source) return;
+		m_sent = spatialParams();
+		alSourcef(m_source, AL_PITCH, m_sent.pitch);
+		alSourcef(m_source, AL_GAIN, m_sent.gain);
+		if (!m_stream) alSourcei(m_source, AL_LOOPING, m_looping);
+		alSource3f(m_source, AL_POSITION, m_position.x, m_position.y, m_position.z);
+		alSourcei(m_source, AL_SOURCE_RELATIVE, b_relative);
+		alSourcef(m_source, AL_REFERENCE_DISTANCE, m_minDistance);
+		alSourcef(m_source, AL_MAX_DISTANCE, m_maxDistance);
+	}
+
+	void AudioClip::applyVoice() {
+		// a batched update still queued for this source belongs to its previous clip
+		AudioSystem::dropUpdates(m_source);
+		alSourcei(m_source, AL_BUFFER, m_samples->buffer);
+		alUpdate();
+		// continue where a virtual voice would be
+		alSourcef(m_source, AL_SEC_OFFSET, m_offset);
+		alSourcePlay(m_source);
 	}
 
 	void AudioClip::SetPitch(float pitch) {
@@ -31,59 +64,110 @@ namespace Lobster {
 		if (pitch < 0.f) pitch = 0.f;
 		else if (pitch > 2.f) pitch = 1.f;
 		m_pitch = pitch;
-		alSourcef(m_source, AL_PITCH, pitch);		
 	}
 
-	void AudioClip::SetGain(float gain) {		
-		// perform clipping		
+	void AudioClip::SetGain(float gain) {
+		// perform clipping
 		if (gain < 0.f) gain = 0.f;
-		else if (gain > 1.f) gain = 1.f;		
+		else if (gain > 1.f) gain = 1.f;
+		// stays silent while muted
 		m_gain = gain;
-		if (m_mute) { // set the variable but not to set the volume when muted
-			Mute();
-			return;	
-		}
-		alSourcef(m_source, AL_GAIN, gain);
 	}
 
 	void AudioClip::SetLooping(bool looping) {
-		alSourcef(m_source, AL_LOOPING, looping);
+		if (m_stream) m_stream->SetLooping(looping);
+		else if (m_source) alSourcei(m_source, AL_LOOPING, looping);
 		m_looping = looping;
 	}
 
-	void AudioClip::BindBuffer(ALenum format, ALvoid* data, ALsizei size, ALsizei freq) {
-		alBufferData(m_buffer, format, data, size, freq);
-		alSourcei(m_source, AL_BUFFER, m_buffer);
-	}	
+	void AudioClip::SetPriority(int priority) {
+		m_priority = priority;
+	}
+
+	void AudioClip::SetPosition(const glm::vec3& position) {
+		m_position = position;
+	}
+
+	void AudioClip::SetRelative(bool relative) {
+		b_relative = relative;
+	}
+
+	void AudioClip::SetDistances(float minDistance, float maxDistance) {
+		m_minDistance = minDistance;
+		m_maxDistance = maxDistance;
+	}
+
+	void AudioClip::BindBuffer(SampleBuffer* samples) {
+		m_samples = samples;
+		m_samples->users++;
+	}
+
+	void AudioClip::BindStream(AudioStream* stream, ALuint source) {
+		m_stream = stream;
+		m_source = source;
+		b_ownSource = true;
+		alUpdate();
+	}
+
+	ALint AudioClip::GetSourceState() {
+		// the source of a stream stops for a moment when it runs dry
+		if (m_stream) return m_stream->GetState();
+		return m_state;
+	}
 
 	void AudioClip::Play() {
-		alSourcePlay(m_source);
+		if (m_stream) {
+			m_stream->Play();
+			return;
+		}
+		if (!m_samples) return;
+		if (m_state != AL_PAUSED) m_offset = 0.f;
+		m_state = AL_PLAYING;
+		if (m_source) {
+			// restart on the voice it has
+			alSourceStop(m_source);
+			applyVoice();
+			return;
+		}
+		// a free voice starts it right away, otherwise AudioSystem::Update decides whether it may steal one
+		m_source = AudioSystem::acquireVoice();
+		if (m_source) applyVoice();
 	}
 
 	void AudioClip::Play(const std::function<void()>& callback) {
-		ThreadPool::Enqueue([&, callback]() {
-			alSourcePlay(m_source);
-			alGetSourcei(m_source, AL_SOURCE_STATE, &m_sourceState);
-			while (m_sourceState == AL_PLAYING) {
-				alGetSourcei(m_source, AL_SOURCE_STATE, &m_sourceState);
-			}
-			callback();
-		});		
+		Play();
+		AudioSystem::WatchClip(this, callback);
 	}
 
 	void AudioClip::Pause() {
-		alSourcePause(m_source);
+		if (m_stream) {
+			m_stream->Pause();
+			return;
+		}
+		if (m_state != AL_PLAYING) return;
+		// a paused clip keeps its time, not its voice
+		if (m_source) {
+			alGetSourcef(m_source, AL_SEC_OFFSET, &m_offset);
+			AudioSystem::releaseVoice(m_source);
+			m_source = 0;
+		}
+		m_state = AL_PAUSED;
 	}
 
 	void AudioClip::Stop() {
-		alSourceStop(m_source);
+		if (m_stream) {
+			m_stream->Stop();
+			return;
+		}
+		if (m_source) {
+			AudioSystem::releaseVoice(m_source);
+			m_source = 0;
+		}
+		m_offset = 0.f;
+		m_state = AL_STOPPED;
 	}
 
 	void AudioClip::Mute(bool mute) {
 		m_mute = mute;
-		if (mute)
-			alSourcef(m_source, AL_GAIN, 0.f);
-		else
-			alSourcef(m_source, AL_GAIN, m_gain);
 	}
 }
\ No newline at end of file
@@ -2,30 +2,73 @@
 #include <al.h>
 #include <alc.h>
 
-namespace Lobster {	
+namespace Lobster {
 
+	class AudioStream;
+
+	// Samples of an audio file in an OpenAL buffer, shared by all the clips of that file (see AudioSystem::AddAudioClip)
+	struct SampleBuffer {
+		std::string path;
+		ALuint buffer = 0;
+		ALsizei size = 0;		// bytes
+		float duration = 0.f;	// seconds
+		int users = 0;
+	};
+
+	// The parameters of a source that change from frame to frame, see AudioSystem::Update
+	struct SpatialParams {
+		ALuint source = 0;
+		glm::vec3 position = glm::vec3(0.f);
+		float gain = 1.f;		// 0 when muted, or culled by distance
+		float pitch = 1.f;
+		float minDistance = 1.f;
+		float maxDistance = 100.f;
+		bool relative = false;
+	};
+
+	// A clip plays on one of the voices (OpenAL sources) of the AudioSystem, which only has a few of them.
+	// When there are more clips playing than voices, the least important ones become virtual: they keep
+	// their time without a voice, and continue where they would be once they get one back.
+	// Streamed clips own their source instead.
+	// The setters only store the values, AudioSystem::Update sends the ones that changed to the voice.
 	class AudioClip {
+		friend class AudioSystem;
 	private:
 		// to track the source and buffer of this audio clip in OpenAL
-		ALuint m_source;
-		ALuint m_buffer;
-		ALint m_sourceState;
+		ALuint m_source = 0;	// the voice, 0 while the clip has none
+		bool b_ownSource = false;
+		SampleBuffer* m_samples = nullptr;
+		AudioStream* m_stream = nullptr;	// set for streamed clips, which have no m_samples
+		std::atomic<ALint> m_state;		// of a pooled clip, also read by the audio thread
+		float m_offset = 0.f;			// seconds played, kept up to date while virtual
 
-		std::string m_name;		
+		std::string m_name;
 		float m_pitch;
 		float m_gain;
 		bool m_mute = false;
 		bool m_looping;
+		int m_priority = 0;			// higher keeps its voice over louder clips of lower priority
+		// 3d sound
+		glm::vec3 m_position;
+		bool b_relative = false;
+		float m_minDistance = 1.f;
+		float m_maxDistance = 100.f;
+		SpatialParams m_sent;			// last sent to m_source
+		SpatialParams spatialParams() const;
+		void applyVoice();
 	public:
 		AudioClip(const char* name, float pitch=1.f, float gain=1.f, glm::vec3 pos=glm::vec3(0, 0, 0),
 			glm::vec3 velo=glm::vec3(0, 0, 0), bool loop=false);
 		~AudioClip();
+		// Sends every parameter to the source right away
 		void alUpdate();
-		// Bind the data loaded from AudioSystem into into buffer
-		void BindBuffer(ALenum format, ALvoid* data, ALsizei size, ALsizei freq);
+		// Play the samples loaded by the AudioSystem
+		void BindBuffer(SampleBuffer* samples);
+		// Play through a stream on its own source instead, the clip takes ownership of both
+		void BindStream(AudioStream* stream, ALuint source);
 		// Just to play the sound directly
 		void Play();
-		// Play the sound, and run callback when finished. This function will be passed to ThreadPool.
+		// Play the sound, and run callback on the main thread when finished (see AudioSystem::WatchClip).
 		void Play(const std::function<void()>& callback);
 		// Pause/Stop any audio playing
 		void Pause();
@@ -36,15 +79,20 @@ namespace Lobster {
 		inline float GetPitch() { return m_pitch; }
 		inline float GetGain() { return m_gain; }
 		inline bool GetLooping() { return m_looping; }
+		inline int GetPriority() { return m_priority; }
 		inline ALuint GetSource() { return m_source; }
-		inline ALint GetSourceState() { 
-			alGetSourcei(m_source, AL_SOURCE_STATE, &m_sourceState);
-			return m_sourceState; 
-		}
+		inline AudioStream* GetStream() { return m_stream; }
+		inline bool IsVirtual() { return !m_stream && m_state == AL_PLAYING && m_source == 0; }
+		ALint GetSourceState();
 		// Setters
 		void SetPitch(float pitch);
 		void SetGain(float gain);
 		void SetLooping(bool loop);
 		void Mute(bool mute=true);
+		void SetPriority(int priority);
+		void SetPosition(const glm::vec3& position);
+		// relative to the listener, for sounds without a position
+		void SetRelative(bool relative);
+		void SetDistances(float minDistance, float maxDistance);
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,181 @@
+#include "pch.h"
+#include "AudioDecoder.h"
+//	stb_vorbis defines single letter macros, so it goes after the other headers
+#include "stb_vorbis.c"
+
+namespace Lobster
+{
+
+	//	PCM WAV, the samples are read straight from the data chunk.
+	class WAVDecoder : public AudioDecoder
+	{
+	private:
+		FILE* m_file = nullptr;
+		long m_dataOffset = 0;
+		size_t m_remaining = 0;
+	public:
+		~WAVDecoder()
+		{
+			if (m_file) fclose(m_file);
+		}
+
+		bool Open(const char* path)
+		{
+			struct ChunkHeader
+			{
+				char ID[4];
+				uint32_t size;
+			};
+			struct FormatChunk
+			{
+				uint16_t AudioFormat;    // 1=PCM
+				uint16_t NumOfChan;      // 1=Mono 2=Stereo
+				uint32_t SamplesPerSec;  // Sampling Frequency in Hz
+				uint32_t bytesPerSec;
+				uint16_t blockAlign;     // 2=16-bit mono, 4=16-bit stereo
+				uint16_t bitsPerSample;
+			} format = {};
+
+			m_file = fopen(path, "rb");
+			if (!m_file) return false;
+			char riff[12];
+			if (fread(riff, 1, 12, m_file) != 12 || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) return false;
+			// the chunks we don't need are skipped, data must come after fmt
+			bool hasFormat = false;
+			ChunkHeader chunk;
+			while (fread(&chunk, sizeof(chunk), 1, m_file) == 1) {
+				if (memcmp(chunk.ID, "fmt ", 4) == 0) {
+					if (chunk.size < sizeof(format) || fread(&format, sizeof(format), 1, m_file) != 1) return false;
+					fseek(m_file, (chunk.size - sizeof(format) + 1) & ~1u, SEEK_CUR);
+					hasFormat = true;
+				}
+				else if (memcmp(chunk.ID, "data", 4) == 0) {
+					if (!hasFormat) return false;
+					m_dataOffset = ftell(m_file);
+					m_size = m_remaining = chunk.size;
+					break;
+				}
+				// chunks are padded to an even size
+				else fseek(m_file, (chunk.size + 1) & ~1u, SEEK_CUR);
+			}
+			if (m_dataOffset == 0 || format.AudioFormat != 1) return false;
+			if (format.NumOfChan == 1) m_format = format.bitsPerSample == 8 ? AL_FORMAT_MONO8 : AL_FORMAT_MONO16;
+			else if (format.NumOfChan == 2) m_format = format.bitsPerSample == 8 ? AL_FORMAT_STEREO8 : AL_FORMAT_STEREO16;
+			else return false;
+			if (format.bitsPerSample != 8 && format.bitsPerSample != 16) return false;
+			m_frequency = (ALsizei)format.SamplesPerSec;
+			m_frameSize = format.NumOfChan * format.bitsPerSample / 8;
+			return true;
+		}
+
+		virtual size_t Read(byte* out, size_t size) override
+		{
+			size = std::min(size / m_frameSize * m_frameSize, m_remaining);
+			size_t read = fread(out, 1, size, m_file);
+			m_remaining -= read;
+			return read;
+		}
+
+		virtual bool Rewind() override
+		{
+			m_remaining = m_size;
+			return fseek(m_file, m_dataOffset, SEEK_SET) == 0;
+		}
+	};
+
+	//	Ogg Vorbis, decoded to 16 bit samples by stb_vorbis.
+	class VorbisDecoder : public AudioDecoder
+	{
+	private:
+		stb_vorbis* m_vorbis = nullptr;
+		int m_channels = 0;
+	public:
+		~VorbisDecoder()
+		{
+			if (m_vorbis) stb_vorbis_close(m_vorbis);
+		}
+
+		bool Open(const char* path)
+		{
+			int error = 0;
+			m_vorbis = stb_vorbis_open_filename(path, &error, nullptr);
+			if (!m_vorbis) return false;
+			stb_vorbis_info info = stb_vorbis_get_info(m_vorbis);
+			m_channels = info.channels;
+			if (m_channels == 1) m_format = AL_FORMAT_MONO16;
+			else if (m_channels == 2) m_format = AL_FORMAT_STEREO16;
+			else return false;
+			m_frequency = (ALsizei)info.sample_rate;
+			m_frameSize = m_channels * sizeof(short);
+			m_size = (size_t)stb_vorbis_stream_length_in_samples(m_vorbis) * m_frameSize;
+			return true;
+		}
+
+		virtual size_t Read(byte* out, size_t size) override
+		{
+			size_t shorts = size / m_frameSize * m_channels;
+			int frames = stb_vorbis_get_samples_short_interleaved(m_vorbis, m_channels, reinterpret_cast<short*>(out), (int)std::min<size_t>(shorts, std::numeric_limits<int>::max()));
+			return (size_t)frames * m_frameSize;
+		}
+
+		virtual bool Rewind() override
+		{
+			return stb_vorbis_seek_start(m_vorbis) != 0;
+		}
+	};
+
+	std::vector<byte> AudioDecoder::ReadAll()
+	{
+		std::vector<byte> data;
+		data.reserve(m_size);
+		const size_t block = 65536;
+		size_t used = 0;
+		while (true) {
+			data.resize(used + block);
+			size_t read = Read(data.data() + used, block);
+			used += read;
+			if (read == 0) break;
+		}
+		data.resize(used);
+		return data;
+	}
+
+	AudioDecoder* AudioDecoder::Open(const char* path, AudioType type)
+	{
+		if (!fs::exists(path)) {
+			WARN("Audio file {} not found", path);
+			return nullptr;
+		}
+		if (type == AudioType::UNKNOWN) type = GetType(path);
+		switch (type) {
+		case AudioType::WAV: {
+			WAVDecoder* decoder = new WAVDecoder();
+			if (decoder->Open(path)) return decoder;
+			delete decoder;
+			WARN("{} is not a PCM WAV file", path);
+			return nullptr;
+		}
+		case AudioType::OGG: {
+			VorbisDecoder* decoder = new VorbisDecoder();
+			if (decoder->Open(path)) return decoder;
+			delete decoder;
+			WARN("{} is not a mono or stereo Ogg Vorbis file", path);
+			return nullptr;
+		}
+		default:
+			WARN("Can't open {}, unsupported audio format", path);
+			return nullptr;
+		}
+	}
+
+	AudioType AudioDecoder::GetType(const char* path)
+	{
+		std::string extension = fs::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		if (extension == ".wav") return AudioType::WAV;
+		if (extension == ".ogg") return AudioType::OGG;
+		if (extension == ".mp3") return AudioType::MP3;
+		return AudioType::UNKNOWN;
+	}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <al.h>
+
+namespace Lobster
+{
+
+	enum class AudioType {
+		UNKNOWN, WAV, OGG, MP3, AUDIOTYPE_SIZE
+	};
+
+	//	Reads the samples of an audio file a block at a time, so long clips can be streamed
+	//	instead of loaded whole. WAV is read as is, OGG is decoded to 16 bit samples.
+	class AudioDecoder
+	{
+	protected:
+		ALenum m_format = AL_FORMAT_MONO16;
+		ALsizei m_frequency = 0;
+		size_t m_frameSize = 2;	// bytes per sample of all channels
+		size_t m_size = 0;		// bytes of samples in the whole file, 0 if unknown
+	public:
+		virtual ~AudioDecoder() = default;
+		//	Writes up to size bytes of samples to out, whole frames only. Returns the bytes written, 0 at the end.
+		virtual size_t Read(byte* out, size_t size) = 0;
+		//	Goes back to the first sample.
+		virtual bool Rewind() = 0;
+		//	Reads everything from the current position on.
+		std::vector<byte> ReadAll();
+		inline ALenum GetFormat() const { return m_format; }
+		inline ALsizei GetFrequency() const { return m_frequency; }
+		inline size_t GetFrameSize() const { return m_frameSize; }
+		inline size_t GetSize() const { return m_size; }
+		//	Opens path with the decoder of type, guessed from the extension for UNKNOWN.
+		//	Returns nullptr if the file can't be read.
+		static AudioDecoder* Open(const char* path, AudioType type = AudioType::UNKNOWN);
+		static AudioType GetType(const char* path);
+	};
+
+}
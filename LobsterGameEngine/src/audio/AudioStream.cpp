@@ -0,0 +1,265 @@
+#include "pch.h"
+#include "AudioStream.h"
+#include "system/MemoryTracker.h"
+
+namespace Lobster
+{
+
+	AudioStream::AudioStream(AudioDecoder* decoder) :
+		m_decoder(decoder),
+		m_data(BufferSize)
+	{
+	}
+
+	AudioStream::~AudioStream()
+	{
+		delete m_decoder;
+	}
+
+	bool AudioStream::fill(int buffer)
+	{
+		size_t size = m_decoder->Read(m_data.data(), BufferSize);
+		if (size == 0 && b_looping && m_decoder->Rewind()) {
+			size = m_decoder->Read(m_data.data(), BufferSize);
+		}
+		if (size == 0) return false;
+		queue(buffer, size);
+		return true;
+	}
+
+	void AudioStream::Play()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_state == AL_PAUSED) {
+			play();
+			m_state = AL_PLAYING;
+			return;
+		}
+		stop();
+		m_decoder->Rewind();
+		b_ended = false;
+		for (int i = 0; i < BufferCount; i++) {
+			if (!fill(i)) {
+				b_ended = true;
+				break;
+			}
+		}
+		play();
+		m_state = AL_PLAYING;
+	}
+
+	void AudioStream::Pause()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_state != AL_PLAYING) return;
+		pause();
+		m_state = AL_PAUSED;
+	}
+
+	void AudioStream::Stop()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		stop();
+		m_state = AL_STOPPED;
+	}
+
+	void AudioStream::Update()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_state != AL_PLAYING) return;
+		int buffer;
+		while ((buffer = unqueue()) >= 0) {
+			if (!b_ended && !fill(buffer)) b_ended = true;
+		}
+		if (!isSourcePlaying()) {
+			// ran dry before the refill, or played the last buffer
+			if (queued() > 0) {
+				play();
+				m_underruns++;
+			}
+			else m_state = AL_STOPPED;
+		}
+	}
+
+	ALint AudioStream::GetState()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_state;
+	}
+
+	void AudioStream::SetLooping(bool looping)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		b_looping = looping;
+	}
+
+	// ========= OpenALStream ==========
+	OpenALStream::OpenALStream(AudioDecoder* decoder, ALuint source) :
+		AudioStream(decoder),
+		m_source(source)
+	{
+		alGenBuffers(BufferCount, m_buffers);
+		MemoryTracker::TrackExternal(MEMORY_AUDIO, (long long)BufferCount * BufferSize);
+		// looping is done by rewinding the decoder, a looping source would replay the queue
+		alSourcei(m_source, AL_LOOPING, AL_FALSE);
+	}
+
+	OpenALStream::~OpenALStream()
+	{
+		alSourceStop(m_source);
+		alSourcei(m_source, AL_BUFFER, 0);
+		alDeleteBuffers(BufferCount, m_buffers);
+		MemoryTracker::TrackExternal(MEMORY_AUDIO, -(long long)BufferCount * BufferSize);
+	}
+
+	void OpenALStream::queue(int buffer, size_t size)
+	{
+		alBufferData(m_buffers[buffer], m_decoder->GetFormat(), m_data.data(), (ALsizei)size, m_decoder->GetFrequency());
+		alSourceQueueBuffers(m_source, 1, &m_buffers[buffer]);
+	}
+
+	int OpenALStream::unqueue()
+	{
+		ALint processed = 0;
+		alGetSourcei(m_source, AL_BUFFERS_PROCESSED, &processed);
+		if (processed <= 0) return -1;
+		ALuint id;
+		alSourceUnqueueBuffers(m_source, 1, &id);
+		for (int i = 0; i < BufferCount; i++) {
+			if (m_buffers[i] == id) return i;
+		}
+		return -1;
+	}
+
+	int OpenALStream::queued()
+	{
+		ALint queued = 0;
+		alGetSourcei(m_source, AL_BUFFERS_QUEUED, &queued);
+		return queued;
+	}
+
+	bool OpenALStream::isSourcePlaying()
+	{
+		ALint state;
+		alGetSourcei(m_source, AL_SOURCE_STATE, &state);
+		return state == AL_PLAYING;
+	}
+
+	void OpenALStream::play()
+	{
+		alSourcePlay(m_source);
+	}
+
+	void OpenALStream::pause()
+	{
+		alSourcePause(m_source);
+	}
+
+	void OpenALStream::stop()
+	{
+		alSourceStop(m_source);
+		// a stopped source can drop its whole queue at once
+		alSourcei(m_source, AL_BUFFER, 0);
+	}
+
+	// ========= FileStream ==========
+	FileStream::FileStream(AudioDecoder* decoder, const std::string& path) :
+		AudioStream(decoder),
+		m_file(path, std::ios::binary)
+	{
+		if (!m_file) WARN("Null audio device can't write {}", path);
+		for (std::vector<byte>& buffer : m_buffers) buffer.resize(BufferSize);
+		// the sizes are filled in when the file is closed
+		ALenum format = m_decoder->GetFormat();
+		uint16_t channels = format == AL_FORMAT_STEREO8 || format == AL_FORMAT_STEREO16 ? 2 : 1;
+		uint16_t bits = format == AL_FORMAT_MONO8 || format == AL_FORMAT_STEREO8 ? 8 : 16;
+		uint32_t frequency = m_decoder->GetFrequency();
+		uint32_t byteRate = frequency * (uint32_t)m_decoder->GetFrameSize();
+		uint16_t blockAlign = (uint16_t)m_decoder->GetFrameSize();
+		uint16_t pcm = 1;
+		uint32_t formatSize = 16;
+		uint32_t size = 0;
+		m_file.write("RIFF", 4).write((const char*)&size, 4).write("WAVE", 4);
+		m_file.write("fmt ", 4).write((const char*)&formatSize, 4).write((const char*)&pcm, 2).write((const char*)&channels, 2);
+		m_file.write((const char*)&frequency, 4).write((const char*)&byteRate, 4).write((const char*)&blockAlign, 2).write((const char*)&bits, 2);
+		m_file.write("data", 4).write((const char*)&size, 4);
+	}
+
+	FileStream::~FileStream()
+	{
+		uint32_t dataSize = (uint32_t)m_written;
+		uint32_t riffSize = dataSize + 36;
+		m_file.seekp(4).write((const char*)&riffSize, 4);
+		m_file.seekp(40).write((const char*)&dataSize, 4);
+	}
+
+	void FileStream::advance()
+	{
+		auto now = HighResolutionClock::now();
+		if (b_sourcePlaying) {
+			double seconds = std::chrono::duration<double>(now - m_clock).count();
+			m_position += seconds * m_decoder->GetFrequency() * m_decoder->GetFrameSize();
+			// a buffer is written to the file once it has been played
+			while (!m_queue.empty() && m_position >= m_buffers[m_queue.front()].size()) {
+				const std::vector<byte>& buffer = m_buffers[m_queue.front()];
+				m_file.write((const char*)buffer.data(), buffer.size());
+				m_written += buffer.size();
+				m_position -= buffer.size();
+				m_processed.push_back(m_queue.front());
+				m_queue.pop_front();
+			}
+			if (m_queue.empty()) {
+				b_sourcePlaying = false;
+				m_position = 0.0;
+			}
+		}
+		m_clock = now;
+	}
+
+	void FileStream::queue(int buffer, size_t size)
+	{
+		m_buffers[buffer].assign(m_data.begin(), m_data.begin() + size);
+		m_queue.push_back(buffer);
+	}
+
+	int FileStream::unqueue()
+	{
+		advance();
+		if (m_processed.empty()) return -1;
+		int buffer = m_processed.front();
+		m_processed.pop_front();
+		return buffer;
+	}
+
+	int FileStream::queued()
+	{
+		return (int)(m_queue.size() + m_processed.size());
+	}
+
+	bool FileStream::isSourcePlaying()
+	{
+		advance();
+		return b_sourcePlaying;
+	}
+
+	void FileStream::play()
+	{
+		advance();
+		b_sourcePlaying = !m_queue.empty();
+	}
+
+	void FileStream::pause()
+	{
+		advance();
+		b_sourcePlaying = false;
+	}
+
+	void FileStream::stop()
+	{
+		b_sourcePlaying = false;
+		m_queue.clear();
+		m_processed.clear();
+		m_position = 0.0;
+	}
+
+}
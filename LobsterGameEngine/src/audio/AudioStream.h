@@ -0,0 +1,96 @@
+#pragma once
+#include <al.h>
+#include "audio/AudioDecoder.h"
+
+namespace Lobster
+{
+
+	//	Plays a long clip through a ring of BufferCount small buffers instead of one buffer holding
+	//	the whole clip: the audio thread (see AudioSystem) refills each buffer from the decoder once
+	//	it has been played and queues it again, so only BufferCount * BufferSize bytes of samples
+	//	are in memory however long the clip is.
+	//	Play, Pause and Stop are called from the main thread, Update from the audio thread.
+	class AudioStream
+	{
+	public:
+		static constexpr int BufferCount = 4;
+		static constexpr size_t BufferSize = 32768;	// bytes, about 0.19 s of 44.1 kHz 16 bit stereo
+	protected:
+		AudioDecoder* m_decoder;
+		std::vector<byte> m_data;	// samples of the buffer being filled
+		std::mutex m_mutex;
+		ALint m_state = AL_INITIAL;	// as seen by the game, the source stops for a moment on an underrun
+		bool b_looping = false;
+		bool b_ended = false;		// the decoder has no more samples
+		size_t m_underruns = 0;
+		bool fill(int buffer);
+		// backend, called with m_mutex locked
+		virtual void queue(int buffer, size_t size) = 0;
+		virtual int unqueue() = 0;	// a played buffer, -1 if there is none
+		virtual int queued() = 0;
+		virtual bool isSourcePlaying() = 0;
+		virtual void play() = 0;
+		virtual void pause() = 0;
+		virtual void stop() = 0;	// also drops the queued buffers
+	public:
+		AudioStream(AudioDecoder* decoder);
+		virtual ~AudioStream();
+		//	Starts from the beginning, or resumes when paused.
+		void Play();
+		void Pause();
+		void Stop();
+		//	Queues the buffers played since the last call again, refilled. Called by the audio thread.
+		void Update();
+		ALint GetState();
+		void SetLooping(bool looping);
+		//	Times the source ran out of samples and had to be restarted.
+		inline size_t GetUnderruns() const { return m_underruns; }
+	};
+
+	//	Streams to an OpenAL source.
+	class OpenALStream : public AudioStream
+	{
+	private:
+		ALuint m_source;
+		ALuint m_buffers[BufferCount];
+	protected:
+		virtual void queue(int buffer, size_t size) override;
+		virtual int unqueue() override;
+		virtual int queued() override;
+		virtual bool isSourcePlaying() override;
+		virtual void play() override;
+		virtual void pause() override;
+		virtual void stop() override;
+	public:
+		OpenALStream(AudioDecoder* decoder, ALuint source);
+		virtual ~OpenALStream();
+	};
+
+	//	Streams to a WAV file at the speed of a sound card, for the null audio device
+	//	(Config::audioNullDevice): a buffer counts as played once its duration has passed.
+	class FileStream : public AudioStream
+	{
+	private:
+		std::ofstream m_file;
+		size_t m_written = 0;
+		std::vector<byte> m_buffers[BufferCount];
+		std::deque<int> m_queue;		// buffers not played yet, the first one is playing
+		std::deque<int> m_processed;
+		double m_position = 0.0;		// bytes of the first buffer played
+		bool b_sourcePlaying = false;
+		std::chrono::time_point<HighResolutionClock> m_clock;
+		void advance();
+	protected:
+		virtual void queue(int buffer, size_t size) override;
+		virtual int unqueue() override;
+		virtual int queued() override;
+		virtual bool isSourcePlaying() override;
+		virtual void play() override;
+		virtual void pause() override;
+		virtual void stop() override;
+	public:
+		FileStream(AudioDecoder* decoder, const std::string& path);
+		virtual ~FileStream();
+	};
+
+}
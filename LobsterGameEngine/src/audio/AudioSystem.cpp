@@ -1,13 +1,24 @@
 #include "pch.h"
 #include "AudioSystem.h"
+#include "AudioStream.h"
+#include "events/EventQueue.h"
+#include "system/MemoryTracker.h"
 
 namespace Lobster
 {
 
 	Lobster::AudioSystem* AudioSystem::s_instance = nullptr;
 
-	AudioSystem::AudioSystem()
+	AudioSystem::AudioSystem(const std::string& nullDevice, int voices) :
+		m_nullDevice(nullDevice)
 	{
+		m_thread = std::thread(&AudioSystem::serviceLoop, this);
+		EventChannel<AudioFinishedEvent>::Subscribe([](AudioFinishedEvent* e) { onClipFinished(e->Callback); });
+		if (!m_nullDevice.empty()) {
+			fs::create_directories(m_nullDevice);
+			INFO("AudioSystem initialized with the null device, audio is written to {}", m_nullDevice);
+			return;
+		}
 		// Creating OpenAL related resources
 		{
 			// Get OpenAL Device
@@ -32,6 +43,17 @@ namespace Lobster
 			}
 		}
 
+		// the voice pool, as many as the device allows
+		alGetError();
+		for (int i = 0; i < voices; i++) {
+			ALuint voice;
+			alGenSources(1, &voice);
+			if (alGetError() != AL_NO_ERROR) break;
+			m_voices.push_back(voice);
+		}
+		m_freeVoices = m_voices;
+		if ((int)m_voices.size() < voices) WARN("Only {} of {} audio voices could be created", m_voices.size(), voices);
+
 		INFO("AudioSystem initialized!");
 	}
 
@@ -41,33 +63,223 @@ namespace Lobster
 		for (AudioClip* ac : m_audioClips) {
 			delete ac;
 		}
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			b_running = false;
+		}
+		m_wake.notify_one();
+		m_thread.join();
 		// Release all OpenAL related resources
 		INFO("AudioSystem shutting down...");
+		if (!m_context) return;
+		if (!m_voices.empty()) alDeleteSources((ALsizei)m_voices.size(), m_voices.data());
+		for (auto& entry : m_samples) {
+			alDeleteBuffers(1, &entry.second->buffer);
+			delete entry.second;
+		}
 		m_device = alcGetContextsDevice(m_context);
 		alcMakeContextCurrent(NULL);
 		alcDestroyContext(m_context);
 		alcCloseDevice(m_device);
 	}
 
-	void AudioSystem::Initialize()
+	void AudioSystem::Initialize(const std::string& nullDevice, int voices)
 	{
 		if (s_instance) {
 			throw std::runtime_error("AudioSystem already initialized!");
 			return;
 		}
-		s_instance = new AudioSystem();
+		s_instance = new AudioSystem(nullDevice, voices);
+	}
+
+	void AudioSystem::Shutdown()
+	{
+		delete s_instance;
+		s_instance = nullptr;
+	}
+
+	void AudioSystem::serviceLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (b_running) {
+			applyPending();
+			for (AudioStream* stream : m_streams) {
+				stream->Update();
+			}
+			// a full event queue keeps the watch for the next round
+			m_watches.erase(std::remove_if(m_watches.begin(), m_watches.end(), [](const Watch& watch) {
+				return watch.clip->GetSourceState() != AL_PLAYING && EventQueue::GetInstance()->AddEvent<AudioFinishedEvent>(watch.callback);
+			}), m_watches.end());
+			if (m_streams.empty() && m_watches.empty()) m_wake.wait(lock);
+			else m_wake.wait_for(lock, std::chrono::milliseconds(ServiceInterval));
+		}
+	}
+
+	void AudioSystem::applyPending()
+	{
+		for (const SourceUpdate& update : m_pendingSources) {
+			const SpatialParams& params = update.params;
+			if (update.changes & CHANGE_POSITION) alSource3f(params.source, AL_POSITION, params.position.x, params.position.y, params.position.z);
+			if (update.changes & CHANGE_GAIN) alSourcef(params.source, AL_GAIN, params.gain);
+			if (update.changes & CHANGE_PITCH) alSourcef(params.source, AL_PITCH, params.pitch);
+			if (update.changes & CHANGE_DISTANCES) {
+				alSourcef(params.source, AL_REFERENCE_DISTANCE, params.minDistance);
+				alSourcef(params.source, AL_MAX_DISTANCE, params.maxDistance);
+			}
+			if (update.changes & CHANGE_RELATIVE) alSourcei(params.source, AL_SOURCE_RELATIVE, params.relative);
+		}
+		m_pendingSources.clear();
+		if (b_listenerPending) {
+			const glm::vec3& position = m_pendingListener.position;
+			alListener3f(AL_POSITION, position.x, position.y, position.z);
+			alListenerfv(AL_ORIENTATION, m_pendingListener.orientation);
+			b_listenerPending = false;
+		}
+	}
+
+	void AudioSystem::collectUpdates()
+	{
+		// nothing to send them to
+		if (!m_context) return;
+		m_sourceUpdates.clear();
+		m_stats.culledSources = 0;
+		for (AudioClip* clip : m_audioClips) {
+			if (!clip->m_source) continue;
+			SpatialParams params = clip->spatialParams();
+			const SpatialParams& sent = clip->m_sent;
+			// out of range, it only needs to be silent
+			if (!params.relative && glm::length(params.position - m_listener.position) > params.maxDistance) {
+				params.gain = 0.f;
+				params.position = sent.position;
+				m_stats.culledSources++;
+			}
+			uint changes = 0;
+			if (params.position != sent.position) changes |= CHANGE_POSITION;
+			if (params.gain != sent.gain) changes |= CHANGE_GAIN;
+			if (params.pitch != sent.pitch) changes |= CHANGE_PITCH;
+			if (params.minDistance != sent.minDistance || params.maxDistance != sent.maxDistance) changes |= CHANGE_DISTANCES;
+			if (params.relative != sent.relative) changes |= CHANGE_RELATIVE;
+			if (changes == 0) continue;
+			clip->m_sent = params;
+			m_sourceUpdates.push_back({ params, changes });
+		}
+		m_stats.sourceUpdates += m_sourceUpdates.size();
+		bool listenerChanged = m_listener.position != m_listenerSent.position ||
+			memcmp(m_listener.orientation, m_listenerSent.orientation, sizeof(m_listener.orientation)) != 0;
+		if (m_sourceUpdates.empty() && !listenerChanged) return;
+		m_listenerSent = m_listener;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			// the audio thread is usually done with the last batch, then the buffers just swap
+			if (m_pendingSources.empty()) m_pendingSources.swap(m_sourceUpdates);
+			else m_pendingSources.insert(m_pendingSources.end(), m_sourceUpdates.begin(), m_sourceUpdates.end());
+			if (listenerChanged) {
+				m_pendingListener = m_listener;
+				b_listenerPending = true;
+			}
+		}
+		m_wake.notify_one();
+	}
+
+	void AudioSystem::dropUpdates(ALuint source)
+	{
+		std::lock_guard<std::mutex> lock(s_instance->m_mutex);
+		std::vector<SourceUpdate>& pending = s_instance->m_pendingSources;
+		pending.erase(std::remove_if(pending.begin(), pending.end(), [source](const SourceUpdate& update) { return update.params.source == source; }), pending.end());
+	}
+
+	void AudioSystem::WatchClip(AudioClip* clip, const std::function<void()>& callback)
+	{
+		uint id = s_instance->m_nextCallback++;
+		s_instance->m_callbacks[id] = { clip, callback };
+		{
+			std::lock_guard<std::mutex> lock(s_instance->m_mutex);
+			s_instance->m_watches.push_back({ clip, id });
+		}
+		s_instance->m_wake.notify_one();
+	}
+
+	void AudioSystem::onClipFinished(uint callback)
+	{
+		auto it = s_instance->m_callbacks.find(callback);
+		// gone with its clip
+		if (it == s_instance->m_callbacks.end()) return;
+		std::function<void()> function = std::move(it->second.function);
+		s_instance->m_callbacks.erase(it);
+		function();
+	}
+
+	void AudioSystem::ForgetClip(AudioClip* clip)
+	{
+		if (!s_instance) return;
+		std::unordered_map<uint, Callback>& callbacks = s_instance->m_callbacks;
+		for (auto it = callbacks.begin(); it != callbacks.end();) {
+			if (it->second.clip == clip) it = callbacks.erase(it);
+			else it++;
+		}
+		// its source is deleted or given to another clip next
+		if (clip->m_source) dropUpdates(clip->m_source);
+		std::lock_guard<std::mutex> lock(s_instance->m_mutex);
+		std::vector<AudioStream*>& streams = s_instance->m_streams;
+		streams.erase(std::remove(streams.begin(), streams.end(), clip->GetStream()), streams.end());
+		std::vector<Watch>& watches = s_instance->m_watches;
+		watches.erase(std::remove_if(watches.begin(), watches.end(), [clip](const Watch& watch) { return watch.clip == clip; }), watches.end());
 	}
 
 	AudioClip* AudioSystem::AddAudioClip(const char* file, AudioType type) {
-		// TODO base on type, classify into different loading method
-		// load the file
-		ALsizei size, freq;
-		ALenum format;
-		ALvoid *data;
-		LoadWAVFile(file, &format, &data, &size, &freq);
-		// TODO check if loaded successfully
-		AudioClip* ac = new AudioClip(fs::path(file).filename().string().c_str());		
-		ac->BindBuffer(format, data, size, freq);
+		MemoryScope scope(MEMORY_AUDIO);
+		// the decoder warns about what it can't open
+		fs::path path = fs::path(file).lexically_normal();
+		AudioClip* ac;
+		// the samples of a file are loaded once
+		auto cached = s_instance->m_samples.find(path.string());
+		if (cached != s_instance->m_samples.end()) {
+			ac = new AudioClip(path.filename().string().c_str());
+			ac->BindBuffer(cached->second);
+			s_instance->m_audioClips.push_back(ac);
+			return ac;
+		}
+		AudioDecoder* decoder = AudioDecoder::Open(file, type);
+		if (!decoder) return nullptr;
+		ac = new AudioClip(path.filename().string().c_str());
+		// long clips, and the ones of unknown length, are streamed. The null device streams everything
+		size_t size = decoder->GetSize();
+		if (IsNullDevice() || size == 0 || size > StreamThreshold) {
+			AudioStream* stream;
+			ALuint source = 0;
+			if (IsNullDevice()) {
+				// clips of the same file get a file each
+				std::string name = path.stem().string();
+				int copies = s_instance->m_nullFiles[name]++;
+				if (copies > 0) name += "_" + std::to_string(copies);
+				stream = new FileStream(decoder, (fs::path(s_instance->m_nullDevice) / (name + ".wav")).string());
+			}
+			else {
+				// a stream can't be virtual, it gets a source of its own
+				alGenSources(1, &source);
+				stream = new OpenALStream(decoder, source);
+			}
+			ac->BindStream(stream, source);
+			{
+				std::lock_guard<std::mutex> lock(s_instance->m_mutex);
+				s_instance->m_streams.push_back(stream);
+			}
+			s_instance->m_wake.notify_one();
+		}
+		else {
+			std::vector<byte> data = decoder->ReadAll();
+			SampleBuffer* samples = new SampleBuffer();
+			samples->path = path.string();
+			samples->size = (ALsizei)data.size();
+			samples->duration = (float)data.size() / decoder->GetFrameSize() / decoder->GetFrequency();
+			alGenBuffers(1, &samples->buffer);
+			// OpenAL keeps its own copy of the samples
+			alBufferData(samples->buffer, decoder->GetFormat(), data.data(), samples->size, decoder->GetFrequency());
+			MemoryTracker::TrackExternal(MEMORY_AUDIO, samples->size);
+			s_instance->m_samples[samples->path] = samples;
+			ac->BindBuffer(samples);
+			delete decoder;
+		}
 		s_instance->m_audioClips.push_back(ac);
 		return ac;
 	}
@@ -110,6 +322,7 @@ namespace Lobster
 	}
 
 	void AudioSystem::SetRolloffType(VolumeRolloff type) {
+		s_instance->m_rolloff = type;
 		switch (type) {
 		case LINEAR:
 			alDistanceModel(AL_LINEAR_DISTANCE_CLAMPED);
@@ -123,71 +336,121 @@ namespace Lobster
 		}
 	}
 
-	void AudioSystem::LoadWAVFile(const char * path, ALsizei * format, ALvoid ** data, ALsizei * size, ALsizei * freq)
-	{
-		struct WAVHeader {
-			/* RIFF Chunk Descriptor */
-			uint8_t         RIFF[4];        // RIFF Header Magic header
-			uint32_t        ChunkSize;      // RIFF Chunk Size
-			uint8_t         WAVE[4];        // WAVE Header
-			/* "fmt" sub-chunk */
-			uint8_t         fmt[4];         // FMT header
-			uint32_t        Subchunk1Size;  // Size of the fmt chunk
-			uint16_t        AudioFormat;    // Audio format 1=PCM,6=Mu-Law,7=A-Law,     257=IBM Mu-Law, 258=IBM A-Law, 259=ADPCM
-			uint16_t        NumOfChan;      // Number of channels 1=Mono 2=Stereo
-			uint32_t        SamplesPerSec;  // Sampling Frequency in Hz
-			uint32_t        bytesPerSec;    // bytes per second
-			uint16_t        blockAlign;     // 2=16-bit mono, 4=16-bit stereo
-			uint16_t        bitsPerSample;  // Number of bits per sample
-		} header;
-
-		struct DataChunk
-		{
-			uint8_t ID[4]; //"data" = 0x61746164
-			uint32_t size;  //Chunk data bytes
-		};
-
-		// reading header
-		FILE* file = fopen(path, "rb");
-		if (!file) {
-			throw std::runtime_error("Audio file not found!");
-			return;
-		}
-		fread(&header, sizeof(header), 1, file);
-		// reading data
-		DataChunk chunk;
-		while (true) {
-			fread(&chunk, sizeof(chunk), 1, file);
-			if (*(unsigned int *)&chunk.ID == 0x61746164)
-				break;
-			fseek(file, chunk.size, SEEK_CUR);
+	void AudioSystem::SetListener(const glm::vec3& position, const glm::vec3& forward, const glm::vec3& up) {
+		ListenerParams& listener = s_instance->m_listener;
+		listener.position = position;
+		listener.orientation[0] = forward.x; listener.orientation[1] = forward.y; listener.orientation[2] = forward.z;
+		listener.orientation[3] = up.x; listener.orientation[4] = up.y; listener.orientation[5] = up.z;
+	}
+
+	ALuint AudioSystem::acquireVoice() {
+		if (!s_instance || s_instance->m_freeVoices.empty()) return 0;
+		ALuint voice = s_instance->m_freeVoices.back();
+		s_instance->m_freeVoices.pop_back();
+		return voice;
+	}
+
+	void AudioSystem::releaseVoice(ALuint voice) {
+		if (!s_instance) return;
+		// updates still pending for the clip that had it would apply to the next one
+		dropUpdates(voice);
+		alSourceStop(voice);
+		alSourcei(voice, AL_BUFFER, 0);
+		s_instance->m_freeVoices.push_back(voice);
+	}
+
+	void AudioSystem::releaseSamples(SampleBuffer* samples) {
+		if (!s_instance || --samples->users > 0) return;
+		alDeleteBuffers(1, &samples->buffer);
+		MemoryTracker::TrackExternal(MEMORY_AUDIO, -(long long)samples->size);
+		s_instance->m_samples.erase(samples->path);
+		delete samples;
+	}
+
+	float AudioSystem::audibility(AudioClip* clip) const {
+		if (clip->m_mute) return 0.f;
+		if (clip->b_relative) return clip->m_gain;
+		float distance = glm::length(clip->m_position - m_listener.position);
+		// AudioSource::m_maxDistance is where the volume reaches zero
+		if (distance > clip->m_maxDistance) return 0.f;
+		float reference = clip->m_minDistance;
+		distance = std::max(distance, reference);
+		if (m_rolloff == LINEAR) {
+			return clip->m_gain * (1.f - (distance - reference) / std::max(clip->m_maxDistance - reference, 0.001f));
 		}
-		byte* value = new byte[chunk.size];
-		fread(value, 1, chunk.size, file);
-		fclose(file);
+		// the inverse and exponent models are the same with a rolloff factor of 1
+		return clip->m_gain * reference / std::max(distance, 0.001f);
+	}
 
-		// return value
-		if (header.NumOfChan == 1) {
-			// mono
-			if (header.bitsPerSample == 8) {
-				*format = AL_FORMAT_MONO8;
+	void AudioSystem::Update(double deltaTime) {
+		AudioSystem* s = s_instance;
+		std::vector<Candidate>& candidates = s->m_candidates;
+		candidates.clear();
+		for (AudioClip* clip : s->m_audioClips) {
+			if (clip->m_stream || clip->m_state != AL_PLAYING) continue;
+			if (clip->m_source) {
+				ALint state;
+				alGetSourcei(clip->m_source, AL_SOURCE_STATE, &state);
+				if (state == AL_STOPPED) {
+					clip->Stop();
+					continue;
+				}
 			}
-			else if (header.bitsPerSample == 16) {
-				*format = AL_FORMAT_MONO16;
+			else {
+				// a virtual voice keeps the time the clip would be at
+				clip->m_offset += (float)(deltaTime / 1000.0) * clip->m_pitch;
+				float duration = clip->m_samples->duration;
+				if (clip->m_offset >= duration) {
+					if (clip->m_looping && duration > 0.f) clip->m_offset = fmod(clip->m_offset, duration);
+					else {
+						clip->Stop();
+						continue;
+					}
+				}
 			}
+			candidates.push_back({ clip, s->audibility(clip), false });
 		}
-		else if (header.NumOfChan == 2) {
-			// stereo
-			if (header.bitsPerSample == 8) {
-				*format = AL_FORMAT_STEREO8;
-			}
-			else if (header.bitsPerSample == 16) {
-				*format = AL_FORMAT_STEREO16;
+
+		// highest priority first, then the most audible
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+			if (a.clip->m_priority != b.clip->m_priority) return a.clip->m_priority > b.clip->m_priority;
+			return a.audibility * (a.clip->m_source ? Hysteresis : 1.f) > b.audibility * (b.clip->m_source ? Hysteresis : 1.f);
+		});
+		size_t granted = 0;
+		for (Candidate& candidate : candidates) {
+			candidate.keep = candidate.audibility > MinAudibility && granted < s->m_voices.size();
+			if (candidate.keep) granted++;
+		}
+		// take the voices first, so they can be given in the same frame
+		for (Candidate& candidate : candidates) {
+			AudioClip* clip = candidate.clip;
+			if (candidate.keep || !clip->m_source) continue;
+			alGetSourcef(clip->m_source, AL_SEC_OFFSET, &clip->m_offset);
+			releaseVoice(clip->m_source);
+			clip->m_source = 0;
+			if (candidate.audibility > MinAudibility) s->m_stats.steals++;
+		}
+		size_t virtualVoices = 0;
+		for (Candidate& candidate : candidates) {
+			AudioClip* clip = candidate.clip;
+			if (candidate.keep && !clip->m_source) {
+				clip->m_source = acquireVoice();
+				if (clip->m_source) clip->applyVoice();
 			}
+			if (!clip->m_source) virtualVoices++;
 		}
-		*data = (ALvoid*)value;
-		*size = (ALsizei)chunk.size;
-		*freq = (ALsizei)header.SamplesPerSec;
+		s->collectUpdates();
+		s->m_stats.voices = s->m_voices.size();
+		s->m_stats.activeVoices = s->m_voices.size() - s->m_freeVoices.size();
+		s->m_stats.virtualVoices = virtualVoices;
+		s->m_stats.cachedSamples = s->m_samples.size();
+	}
+
+	AudioStats AudioSystem::ConsumeStats() {
+		AudioStats stats = s_instance->m_stats;
+		s_instance->m_stats.steals = 0;
+		s_instance->m_stats.sourceUpdates = 0;
+		return stats;
 	}
 
 }
\ No newline at end of file
@@ -2,26 +2,117 @@
 #include <al.h>
 #include <alc.h>
 #include "audio/AudioClip.h"
+#include "audio/AudioDecoder.h"
 
 namespace Lobster
 {
 
-	enum class AudioType {
-		UNKNOWN, WAV, OGG, MP3, AUDIOTYPE_SIZE
-	};
+	class AudioStream;
 
 	enum VolumeRolloff { LINEAR, INVERSE_SQUARE, EXPONENTIAL };
 
+	struct AudioStats
+	{
+		size_t voices = 0;			// in the pool
+		size_t activeVoices = 0;	// clips playing on a voice
+		size_t virtualVoices = 0;	// clips playing without one
+		size_t steals = 0;			// voices taken from a playing clip since the last call
+		size_t cachedSamples = 0;	// files with their samples loaded
+		size_t sourceUpdates = 0;	// sources whose parameters changed since the last call
+		size_t culledSources = 0;	// sources with a voice silenced for being beyond their max distance
+	};
+
+	//	Owns the OpenAL device and the audio clips.
+	//	A single audio thread services every clip every ServiceInterval ms, and sleeps while there is
+	//	nothing to service: it refills the buffers of streamed clips, the ones longer than StreamThreshold
+	//	(see AudioStream), and watches the clips played with a callback. When one of those stops, the
+	//	callback is run on the main thread through the EventQueue, so any number of clips costs one thread.
+	//	The other clips share the samples of their file, and play on a fixed pool of voices. Update gives
+	//	the voices to the playing clips of highest priority, then the most audible ones; the rest, and
+	//	every clip too far or too quiet to be heard, become virtual voices that keep their time.
+	//	Update also sends the parameters of the voices to OpenAL: it diffs them against the ones sent last
+	//	frame, and hands the changed ones to the audio thread in one batch, so the game loop makes no
+	//	OpenAL calls for sources that didn't move. Sources beyond their max distance are silenced and
+	//	their positions aren't sent until they come back in range.
+	//	With a null device, no sound device is opened and every clip is streamed to a WAV file instead,
+	//	so audio works without sound hardware.
 	class AudioSystem
 	{
+		friend class AudioClip;
+	public:
+		static constexpr size_t StreamThreshold = 1048576;	// bytes of samples, about 6 s of 44.1 kHz 16 bit stereo
+		static constexpr int ServiceInterval = 10;			// ms
+		static constexpr float MinAudibility = 0.001f;		// quieter clips never get a voice
+		static constexpr float Hysteresis = 1.1f;			// audibility bonus of the clips holding a voice, so close ones don't swap every frame
 	private:
-		ALCcontext* m_context;
-		ALCdevice* m_device;
+		struct Candidate
+		{
+			AudioClip* clip;
+			float audibility;
+			bool keep;
+		};
+		struct Callback
+		{
+			AudioClip* clip;
+			std::function<void()> function;
+		};
+		struct Watch
+		{
+			AudioClip* clip;
+			uint callback;
+		};
+		enum SourceChange { CHANGE_POSITION = 1, CHANGE_GAIN = 2, CHANGE_PITCH = 4, CHANGE_DISTANCES = 8, CHANGE_RELATIVE = 16 };
+		struct SourceUpdate
+		{
+			SpatialParams params;
+			uint changes;	// SourceChange bits
+		};
+		struct ListenerParams
+		{
+			glm::vec3 position = glm::vec3(0.f);
+			float orientation[6] = { 0.f, 0.f, -1.f, 0.f, 1.f, 0.f };	// at, then up
+		};
+		ALCcontext* m_context = nullptr;
+		ALCdevice* m_device = nullptr;
 		static AudioSystem* s_instance;
 		std::vector<AudioClip*> m_audioClips;
+		std::string m_nullDevice;	// directory of the null device, empty for a sound device
+		std::unordered_map<std::string, int> m_nullFiles;	// clips streamed to each file name
+		std::unordered_map<uint, Callback> m_callbacks;		// main thread only
+		uint m_nextCallback = 1;
+		std::unordered_map<std::string, SampleBuffer*> m_samples;	// by path
+		std::vector<ALuint> m_voices;
+		std::vector<ALuint> m_freeVoices;
+		std::vector<Candidate> m_candidates;
+		ListenerParams m_listener;
+		ListenerParams m_listenerSent;
+		std::vector<SourceUpdate> m_sourceUpdates;	// collected by Update
+		VolumeRolloff m_rolloff = INVERSE_SQUARE;
+		AudioStats m_stats;
+		// audio thread
+		std::thread m_thread;
+		std::mutex m_mutex;				// guards m_streams, m_watches and the pending updates
+		std::condition_variable m_wake;
+		std::vector<AudioStream*> m_streams;
+		std::vector<Watch> m_watches;
+		std::vector<SourceUpdate> m_pendingSources;
+		ListenerParams m_pendingListener;
+		bool b_listenerPending = false;
+		bool b_running = true;
+		void serviceLoop();
+		void applyPending();
+		void collectUpdates();
+		static void dropUpdates(ALuint source);
+		float audibility(AudioClip* clip) const;
+		static void onClipFinished(uint callback);
+		static ALuint acquireVoice();	// 0 if all are taken
+		static void releaseVoice(ALuint voice);
+		static void releaseSamples(SampleBuffer* samples);
 	public:
 		~AudioSystem();
-		static void Initialize();
+		//	nullDevice is the directory of the null device, empty to open the default sound device.
+		static void Initialize(const std::string& nullDevice = "", int voices = 32);
+		static void Shutdown();
 		static void ListAllDevices(const ALCchar* devices);
 		static std::vector<AudioClip*>& GetAudioList();
 		// Add an audio clip in full path
@@ -30,10 +121,20 @@ namespace Lobster
 		static void RemoveAudioClip(std::string name);
 		static void SetRolloffType(VolumeRolloff type);
 		// TODO rolloff factor?!
+		static void SetListener(const glm::vec3& position, const glm::vec3& forward, const glm::vec3& up);
+		//	Keeps time for the virtual voices, shares the voices among the playing clips and sends
+		//	the parameters that changed to the audio thread. Call once per frame.
+		static void Update(double deltaTime);
+		//	Returns the voice counts, and the steals and source updates since the last call.
+		static AudioStats ConsumeStats();
+		//	Runs callback on the main thread once clip stops playing.
+		static void WatchClip(AudioClip* clip, const std::function<void()>& callback);
+		//	Forgets the stream and the callbacks of a clip being deleted, once it returns the audio thread no longer uses them.
+		static void ForgetClip(AudioClip* clip);
+		inline static bool IsNullDevice() { return !s_instance->m_nullDevice.empty(); }
 		
 	private:
-		AudioSystem();
-		static void LoadWAVFile(const char * path, ALsizei * format, ALvoid ** data, ALsizei * size, ALsizei * freq);
+		AudioSystem(const std::string& nullDevice, int voices);
 	};
 
 }
\ No newline at end of file
@@ -32,13 +32,14 @@ namespace Lobster {
 	void AudioSource::OnUpdate(double deltaTime) {
 		if (Application::GetMode() != GAME) return;
 		if (m_clip) {			
-			// update data for attached clip
+			// update data for attached clip, AudioSystem::Update sends what changed
 			m_clip->SetGain(m_gain);
 			m_clip->SetPitch(m_pitch);
+			m_clip->SetPriority(m_priority);
+			m_clip->SetDistances(m_minDistance, m_maxDistance);
 			// update source position
 			if (transform && m_enable3d) {
-				glm::vec3 position = transform->WorldPosition;
-				alSource3f(m_clip->GetSource(), AL_POSITION, position[0], position[1], position[2]);
+				m_clip->SetPosition(transform->WorldPosition);
 			}
 		}		
 	}
@@ -104,6 +105,19 @@ namespace Lobster {
 				m_isChanging = -1;
 			}
 
+			if (ImGui::SliderInt("Priority", &m_priority, 0, 10)) {
+				m_isChanging = 4;
+			}
+			if (m_isChanging != 4) {
+				m_prevProp[4] = (float)m_priority;
+			} else if (Input::IsMouseUp(GLFW_MOUSE_BUTTON_LEFT)) {
+				if ((int)m_prevProp[4] != m_priority) {
+					if (m_clip) m_clip->SetPriority(m_priority);
+					UndoSystem::GetInstance()->Push(new PropertyAssignmentCommand(this, &m_priority, (int)m_prevProp[4], m_priority, "Set priority to " + std::to_string(m_priority) + " for " + GetOwner()->GetName()));
+				}
+				m_isChanging = -1;
+			}
+
 			if (ImGui::TreeNode("3D Sound Setting")) {
 				ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.5f); // reduce width
 
@@ -152,10 +166,7 @@ namespace Lobster {
 	}
 
 	void AudioSource::SetMinMaxDistance() {
-		if (m_clip) {
-			alSourcef(m_clip->GetSource(), AL_REFERENCE_DISTANCE, m_minDistance);
-			alSourcef(m_clip->GetSource(), AL_MAX_DISTANCE, m_maxDistance);
-		}
+		if (m_clip) m_clip->SetDistances(m_minDistance, m_maxDistance);
 	}
 
 	void AudioSource::OnBegin() {		
@@ -173,7 +184,7 @@ namespace Lobster {
 			if (src->m_clip) {
 				src->m_clip->Stop();
 				// delete the audio clip as well
-				delete src->m_clip;
+				AudioSystem::RemoveAudioClip(src->m_clip);
 				src->m_clip = nullptr;
 			}			
 		}
@@ -232,26 +243,19 @@ namespace Lobster {
 	void AudioListener::OnUpdate(double deltaTime) {
 		// update the positional information and play audio (automatically)
 		if (Application::GetMode() == ApplicationMode::GAME) {			
-			for (AudioSource* src : AudioSource::sourceList) {								
+			// set the listener of OpenAL, sent by AudioSystem::Update if it moved
+			glm::vec3 forward = transform->Forward();
+			AudioSystem::SetListener(transform->WorldPosition, glm::vec3(forward.x, forward.y, -forward.z), transform->Up());
+			for (AudioSource* src : AudioSource::sourceList) {
 				if (!src->m_clip || !src->IsAutoPlay()) continue;
 				if (src->m_enable3d) {
 					// Note: AudioClip::position will not update itself
 					// so we update it here according to the object's actual position
-
-					// set the listener position of OpenAL
-					alSourcei(src->m_clip->GetSource(), AL_SOURCE_RELATIVE, AL_FALSE);
-					glm::vec3 position = transform->WorldPosition;
-					alListener3f(AL_POSITION, position[0], position[1], position[2]);
-
-					// set the listener orientation
-					float ori[6];
-					ori[0] = transform->Forward()[0]; ori[1] = transform->Forward()[1]; ori[2] = -transform->Forward()[2];
-					ori[3] = transform->Up()[0]; ori[4] = transform->Up()[1]; ori[5] = transform->Up()[2];
-					alListenerfv(AL_ORIENTATION, ori);
+					src->m_clip->SetRelative(false);
 				}
 				else {
-					alSourcei(src->m_clip->GetSource(), AL_SOURCE_RELATIVE, AL_TRUE);
-					alSource3f(src->m_clip->GetSource(), AL_POSITION, 0.0f, 0.0f, 0.0f);
+					src->m_clip->SetRelative(true);
+					src->m_clip->SetPosition(glm::vec3(0.0f));
 				}
 				if (src->m_loop) src->done = false;						
 				if (!src->done && src->m_clip->GetSourceState() != AL_PLAYING) {
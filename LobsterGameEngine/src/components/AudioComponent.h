@@ -3,6 +3,7 @@
 #include "audio/AudioSystem.h"
 #include "audio/AudioClip.h"
 #include "objects/GameObject.h"
+#include "utils/Serialization.h"
 
 namespace Lobster {
 	
@@ -12,8 +13,8 @@ namespace Lobster {
 		static std::vector<AudioSource*> sourceList;
 	private:
 		static const char* rolloff[];
-		int m_isChanging = -1;		//	Used for undo system. 0 = gain, 1 = pitch, 2 = minDistance, 3 = maxDistance.
-		float m_prevProp[4];		//	Used for undo system.
+		int m_isChanging = -1;		//	Used for undo system. 0 = gain, 1 = pitch, 2 = minDistance, 3 = maxDistance, 4 = priority.
+		float m_prevProp[5];		//	Used for undo system.
 
 		// normally this is not set until OnBegin(), to specify a file to load,
 		// set the name of the audio clip in m_clipName
@@ -26,6 +27,7 @@ namespace Lobster {
 		bool m_muted = false;
 		float m_gain = 1.0;
 		float m_pitch = 1.0;		
+		int m_priority = 0;		// keeps a voice over louder sounds of lower priority
 		// 3d sound setting
 		bool m_enable3d = true;
 		float m_minDistance = 1.f;		// the distance starting to weaken volume
@@ -65,6 +67,7 @@ namespace Lobster {
 			ar(m_enable3d);
 			ar(m_minDistance, m_maxDistance);
 			ar(m_rolloff);
+			ar(cereal::make_nvp("priority", m_priority));
 		}
 		template <class Archive>
 		void load(Archive & ar)
@@ -77,6 +80,8 @@ namespace Lobster {
 			ar(m_enable3d);
 			ar(m_minDistance, m_maxDistance);
 			ar(reinterpret_cast<VolumeRolloff>(m_rolloff));
+			// added later, older scenes don't have it
+			if (!Serialization::LoadOptional(ar, "priority", m_priority)) m_priority = 0;
 		}
 	};
 
@@ -100,21 +100,25 @@ namespace Lobster
 			if (ImGui::Button("Edit UI")) {
 				if (!gameUI) {
 					gameUI = new GameUI();
+					GetOwner()->MarkEdited();
 				}
 				b_uiEditor = true;
 			}
 			// properties control
 			ImGui::PushItemWidth(80);
 			ImGui::DragFloat("Near", &m_nearPlane, 0.1f, 0.01f, m_farPlane);
+			if (ImGui::IsItemDeactivatedAfterEdit()) GetOwner()->MarkEdited();
 			ImGui::SameLine();
 			ImGui::DragFloat("Far", &m_farPlane, 0.1f, m_nearPlane, 1000.f);
+			if (ImGui::IsItemDeactivatedAfterEdit()) GetOwner()->MarkEdited();
 			ImGui::PopItemWidth();
 			ResizeProjection(m_width, m_height);
 
 			// show the UI editor
 			if (b_uiEditor) {
 				ImGuiUIEditor* editor = EditorLayer::GetUIEditor();
-				editor->SetUI(gameUI);
+				// the GameUI is saved with the camera's object
+				editor->SetUI(gameUI, GetOwner());
 				editor->Show(&b_uiEditor);
 			}			
 		}
@@ -122,10 +126,7 @@ namespace Lobster
 
 	void CameraComponent::DrawUI() {
 		if (!gameUI) return;
-		for (Sprite2D* sprite : gameUI->GetSpriteList()) {
-			sprite->OnUpdate(0); // trivial input
-			sprite->OnLateUpdate(0); // for callbacks
-		}
+		gameUI->OnUpdate(0); // trivial input
 	}
 
 	void CameraComponent::Serialize(cereal::JSONOutputArchive & oarchive)
@@ -1,4 +1,5 @@
 #pragma once
+#include "system/SlabAllocator.h"
 
 namespace Lobster
 {
@@ -28,7 +29,8 @@ namespace Lobster
 	//	This class is an abstract class for inheriting components.
 	//	If you don't know what a component does / have no idea what a ECS (Entity-Component System),
 	//	I highly recommend the following video to start with: https://www.youtube.com/watch?v=2rW7ALyHaas
-    class Component
+	//	Components are allocated from the slab allocator, see SlabAllocator.h.
+    class Component : public SlabAllocated
     {
         friend Script;
 
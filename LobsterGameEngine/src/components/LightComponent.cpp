@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "LightComponent.h"
+#include "Application.h"
 #include "imgui/ImGuiScene.h"
 #include "graphics/FrameBuffer.h"
 #include "graphics/Renderer.h"
@@ -118,7 +119,7 @@ namespace Lobster
 		b_dirty = true;
 	}
 
-	void LightComponent::RenderDepthMap(const std::list<RenderCommand>& queue)
+	void LightComponent::RenderDepthMap(const RenderQueue& queue)
 	{
 		Shader* shader = ShaderLibrary::Use("shaders/ShadowMapping.glsl");
 		shader->Bind();
@@ -173,6 +174,8 @@ namespace Lobster
 			throw std::runtime_error("LightLibrary already existed!");
 		}
 		s_instance = new LightLibrary();
+		// headless runs have no OpenGL and never render the lights
+		if (Application::IsHeadless()) return;
 
 		// directional lights
 		glGenBuffers(1, &s_instance->m_ubo);
@@ -223,7 +226,7 @@ namespace Lobster
 	void LightLibrary::Update()
 	{
 		int i = 0;
-		const std::list<RenderCommand>& queue = Renderer::s_instance->m_opaqueQueue;
+		const RenderQueue& queue = Renderer::s_instance->m_opaqueQueue;
 		for (auto dirLight : s_instance->m_directionalLights) {
 			if (i >= MAX_DIRECTIONAL_SHADOW) break;
 			dirLight->RenderDepthMap(queue);
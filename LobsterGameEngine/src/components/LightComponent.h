@@ -67,7 +67,7 @@ namespace Lobster
 		inline LightType GetType() const{ return m_type; }
     private:
 		void ChangeLightType();
-		void RenderDepthMap(const std::list<RenderCommand>& queue);
+		void RenderDepthMap(const RenderQueue& queue);
 
         friend class cereal::access;
         template <class Archive>
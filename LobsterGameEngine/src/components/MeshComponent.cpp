@@ -77,7 +77,8 @@ namespace Lobster
 	void MeshComponent::LoadFromFile(const char * meshPath, const char * materialPath)
 	{
 		// import mesh and load defined materials from model file
-		m_meshInfo = MeshLoader::Load(meshPath);
+		m_sharedMesh = MeshLoader::LoadShared(meshPath);
+		m_meshInfo = *m_sharedMesh;
 		// load animation from file only if .anim file not found
 		if (m_animations.empty() && !m_meshInfo.BoneMap.empty()) {
 			m_animations = MeshLoader::LoadAnimation(meshPath);
@@ -118,7 +119,8 @@ namespace Lobster
     
     MeshComponent::~MeshComponent()
     {
-        //	Release memory
+        //	Release memory, shared geometry is released by the last owner
+		if (m_sharedMesh) return;
 		for (int i = 0; i < m_meshInfo.Meshes.size(); ++i) {
 			VertexArray* va = m_meshInfo.Meshes[i];
 			if (va)	delete va;
@@ -224,6 +226,7 @@ namespace Lobster
 							if (ImGui::Button("Save")) {
 								anim.Name = validName;
 								SaveAnimation(i);
+								GetOwner()->MarkEdited();
 							}
 							if (invalid) {
 								ImGui::PopItemFlag();
@@ -239,6 +242,7 @@ namespace Lobster
 						if (!path.empty()) {
 							m_animations.push_back(LoadAnimation(path.c_str()));
 							b_dirty = true;
+							GetOwner()->MarkEdited();
 						}
 					}
 					ImGui::TreePop();
@@ -267,6 +271,7 @@ namespace Lobster
 							if (!path.empty()) {
 								path = FileSystem::Path(path);
 								m_meshInfo.Materials[i] = MaterialLibrary::Use(path.c_str());
+								GetOwner()->MarkEdited();
 							}
 						}
 						material->OnImGuiRender();
@@ -40,6 +40,9 @@ namespace Lobster
 		// Mesh data
 		std::string m_meshPath;
 		MeshInfo m_meshInfo;
+		//	Keeps the geometry loaded from file alive; it is shared with every other mesh component using the same file.
+		//	Primitive shapes are not shared and own their vertex arrays.
+		std::shared_ptr<const MeshInfo> m_sharedMesh;
 	private:
 		// Skeletal animation data
 		bool b_dirty = false;
@@ -86,7 +89,8 @@ namespace Lobster
 			// Mesh & Materials
 			std::vector<std::string> materialNames;
 			for (auto material : m_meshInfo.Materials) {
-				material->SaveConfiguration();
+				// only write material files that changed or have never been written
+				if (material->IsDirty() || !FileSystem::Exist(material->GetPath())) material->SaveConfiguration();
 				materialNames.push_back(material->GetName());
 			}
 			ar(FileSystem::PathUnderRes(m_meshPath));
@@ -1,8 +1,10 @@
 #include "pch.h"
 #include "ParticleComponent.h"
+#include "components/CameraComponent.h"
 #include "graphics/Renderer.h"
 #include "graphics/VertexBuffer.h"
 #include "graphics/IndexBuffer.h"
+#include "graphics/ParticleSystemManager.h"
 #include "graphics/VertexLayout.h"
 #include "objects/GameObject.h"
 #include "system/Input.h"
@@ -26,39 +28,47 @@ namespace Lobster
 		m_emissionAngle(M_PI/6),
 		m_colorStartTransition(glm::vec4(1.0)),
 		m_colorEndTransition(glm::vec4(1.0)),
-		m_particleCount(0),
-		m_particleCutoff(MAX_PARTICLES / 2),
+		m_particleCutoff(512),
+		m_priority(0),
+		b_depthSort(false),
+		b_sortedIndices(false),
+		m_quota(512),
+		m_simulationDeltaTime(0.0f),
+		m_spawned(0),
 		m_particleSize(0.125f),
+		m_sizeVariance(0.0f),
 		m_particleOrientation(0.0f),
 		m_particleTexture(nullptr),
+		m_uploadCapacity(0),
 		m_material(nullptr),
 		m_vertexArray(nullptr),
-		m_vertexBuffer(nullptr)
+		m_vertexBuffer(nullptr),
+		m_indexBuffer(nullptr),
+		m_random(Random::Stream(RANDOM_PARTICLES).Next())
 	{
-		srand(time(NULL));
-		FillVolume();
-
 		m_material = MaterialLibrary::UseShader("shaders/GPUParticle.glsl");
 		m_material->SetRenderingMode(RenderingMode::MODE_TRANSPARENT);
 		m_material->GetShader()->SetUniform("sys_particleSize", m_particleSize);
 		m_vertexBuffer = new VertexBuffer(DrawMode::DYNAMIC_DRAW);
-		IndexBuffer* indexBuffer = new IndexBuffer();
+		m_indexBuffer = new IndexBuffer();
 		VertexLayout* layout = new VertexLayout();
 		layout->Add<float>("in_position", 3);
+		layout->Add<float>("in_size", 1);
+		layout->Add<float>("in_age", 1);
+		layout->Add<uint>("in_color", 1);
 		std::vector<VertexBuffer*> vb;
 		std::vector<IndexBuffer*> ib;
-		m_vertexBuffer->SetData(m_particlePositions, sizeof(m_particlePositions));
 		vb.push_back(m_vertexBuffer);
-		std::vector<uint> indices(MAX_PARTICLES);
-		std::iota(std::begin(indices), std::end(indices), 0);
-		indexBuffer->SetData(indices.data(), MAX_PARTICLES);
-		ib.push_back(indexBuffer);
+		ib.push_back(m_indexBuffer);
+		Reserve();
+		Upload();
 
 		m_vertexArray = new VertexArray(layout, vb, ib, PrimitiveType::POINTS);
 	}
 
 	ParticleComponent::~ParticleComponent()
 	{
+		ParticleSystemManager::Remove(this);
 		if (m_material) delete m_material;
 		if (m_vertexArray) delete m_vertexArray;
 		m_material = nullptr;
@@ -72,51 +82,26 @@ namespace Lobster
 		gameObject->AddComponent(physics);
 	}
 
+	void ParticleComponent::OnBegin()
+	{
+		// the game starts from a known seed, reseed so the particles do not depend on editing history
+		m_random.Seed(Random::Stream(RANDOM_PARTICLES).Next());
+		ResetParticleCount();
+		_volumeFilled = false;
+	}
+
 	void ParticleComponent::OnUpdate(double deltaTime)
 	{
 		// Update particle position
 		if (Application::GetMode() == EDITOR) return;
 		if (b_animated) {
-			// Emit all at once
-			if (!b_emitOneByOne && !_volumeFilled) {
-				m_particleCount = m_particleCutoff;
-				FillVolume();
-				_volumeFilled = true;
-			}
-			// One-by-one
-			else if (b_emitOneByOne && _volumeFilled) {
-				m_particleCount = 0;
-				_volumeFilled = false;
-			}
-			// Check EmitOnce() end condition
-			if (_killExpiredParticle && _deathCount == m_particleCutoff) {
-				_killExpiredParticle = false;
-				b_animated = false;
-				ResetParticleCount();
-			}
-			// Calculate new particle position
-			switch (m_shape)
-			{
-			case EmitterShape::BOX:
-				BoxEmitter(deltaTime); break;
-			case EmitterShape::CONE:
-				ConeEmitter(deltaTime); break;
-			case EmitterShape::SPHERE:
-				SphereEmitter(deltaTime); break;
-			default:
-				break;
-			}
-			// Set vertex data
-			m_vertexBuffer->SetData(m_particlePositions, sizeof(m_particlePositions));
+			m_simulationDeltaTime = float(deltaTime / 1000.0);
+			ParticleSystemManager::Submit(this, deltaTime);
 		}
 
 		// Update shader uniforms
-		int cutoff = std::min(m_particleCutoff, m_particleCount);
-		m_material->SetRawUniform("EmissionShape", (void*)&m_shape);
 		m_material->SetRawUniform("ColorStartTransition", (void*)glm::value_ptr(m_colorStartTransition));
 		m_material->SetRawUniform("ColorEndTransition", (void*)glm::value_ptr(m_colorEndTransition));
-		m_material->SetRawUniform("DeadParticleCount", &_deathCount);
-		m_material->SetRawUniform("ParticleCutoff", &cutoff);
 		m_material->SetRawUniform("ParticleSize", &m_particleSize);
 		m_material->SetRawUniform("ParticleOrientation", (void*)glm::value_ptr(glm::rotate(m_particleOrientation, glm::vec3(0, 0, 1))));
 		m_material->SetRawTexture2D(0, m_particleTexture ? m_particleTexture : TextureLibrary::Use("textures/ui/sphere.png"));
@@ -129,6 +114,68 @@ namespace Lobster
 		Renderer::Submit(command);
 	}
 
+	void ParticleComponent::beginSimulation(int quota)
+	{
+		m_quota = std::min(quota, m_particleCutoff);
+		Reserve();
+		// Emit all at once
+		if (!b_emitOneByOne && !_volumeFilled) {
+			FillVolume();
+			_volumeFilled = true;
+		}
+		// One-by-one
+		else if (b_emitOneByOne && _volumeFilled) {
+			ResetParticleCount();
+			_volumeFilled = false;
+		}
+		// Check EmitOnce() end condition
+		if (_killExpiredParticle && _deathCount >= m_particleCutoff) {
+			_killExpiredParticle = false;
+			b_animated = false;
+			ResetParticleCount();
+		}
+	}
+
+	size_t ParticleComponent::endSimulation()
+	{
+		m_spawned = 0;
+		// Remove the expired particles
+		int expired = (int)m_pool.Kill();
+		if (_killExpiredParticle) {
+			_deathCount += expired;
+		}
+		// Expired particles are emitted again, up to the quota
+		else {
+			for (int i = 0; i < expired && (int)m_pool.GetCount() < m_quota; i++) {
+				Spawn(false);
+			}
+		}
+		if (!b_emitOneByOne) {
+			while ((int)m_pool.GetCount() < m_quota && !_killExpiredParticle) Spawn(false);
+		}
+		// emit new particle one by one
+		else {
+			_simulateElapsedTime += m_simulationDeltaTime * m_emissionSpeed; // in seconds
+			if (_simulateElapsedTime > m_emissionRate) {
+				int emitted = (int)m_pool.GetCount() + (_killExpiredParticle ? _deathCount : 0);
+				if (emitted < m_quota) Spawn(false);
+				_simulateElapsedTime = 0.0f;
+			}
+		}
+		// Vertex data, uploaded by Upload() on the main thread
+		if (m_pool.GetCount() > 0) m_pool.WriteVertices(m_vertices.data());
+		return m_spawned;
+	}
+
+	void ParticleComponent::sort()
+	{
+		CameraComponent* camera = CameraComponent::GetActiveCamera();
+		if (!b_depthSort || !camera) return;
+		// particles are simulated in the space of the emitter
+		glm::vec3 eye = glm::vec3(glm::inverse(transform->GetMatrix()) * glm::vec4(camera->GetPosition(), 1.0f));
+		m_sorter.Sort(m_pool, eye);
+	}
+
 	void ParticleComponent::OnImGuiRender()
 	{
 		if (ImGui::CollapsingHeader("Particle System", &m_show, ImGuiTreeNodeFlags_DefaultOpen))
@@ -188,6 +235,45 @@ namespace Lobster
 					}
 					m_isChanging = -1;
 				}
+
+				if (ImGui::SliderInt("Priority", &m_priority, 0, 10)) {
+					m_isChanging = 9;
+				}
+				if (m_isChanging != 9) {
+					m_prevProp[9] = m_priority;
+				} else if (Input::IsMouseUp(GLFW_MOUSE_BUTTON_LEFT)) {
+					if (m_prevProp[9] != m_priority) {
+						UndoSystem::GetInstance()->Push(new PropertyAssignmentCommand(this, &m_priority, (int) round(m_prevProp[9]), m_priority, "Set particle priority to " + std::to_string(m_priority) + " for " + GetOwner()->GetName()));
+					}
+					m_isChanging = -1;
+				}
+				ImGui::TreePop();
+			}
+
+			if (ImGui::TreeNode("Forces")) {
+				if (ImGui::DragFloat3("Gravity", glm::value_ptr(m_forces.gravity), 0.05f)) {
+					m_isChanging = 6;
+				}
+				if (m_isChanging != 6) {
+					m_prevGravity = m_forces.gravity;
+				} else if (ImGui::IsItemActive() == false) {
+					if (m_prevGravity != m_forces.gravity) {
+						UndoSystem::GetInstance()->Push(new PropertyAssignmentCommand(this, &m_forces.gravity, m_prevGravity, m_forces.gravity, "Set particle gravity to " + StringOps::ToString(m_forces.gravity) + " for " + GetOwner()->GetName()));
+					}
+					m_isChanging = -1;
+				}
+
+				if (ImGui::DragFloat("Drag", &m_forces.drag, 0.01f, 0.f, 10.f)) {
+					m_isChanging = 7;
+				}
+				if (m_isChanging != 7) {
+					m_prevProp[7] = m_forces.drag;
+				} else if (ImGui::IsItemActive() == false) {
+					if (m_prevProp[7] != m_forces.drag) {
+						UndoSystem::GetInstance()->Push(new PropertyAssignmentCommand(this, &m_forces.drag, m_prevProp[7], m_forces.drag, "Set particle drag to " + StringOps::ToString(m_forces.drag) + " for " + GetOwner()->GetName()));
+					}
+					m_isChanging = -1;
+				}
 				ImGui::TreePop();
 			}
 
@@ -246,6 +332,18 @@ namespace Lobster
 					m_isChanging = -1;
 				}
 
+				if (ImGui::SliderFloat("Size Variance", &m_sizeVariance, 0.f, 1.f)) {
+					m_isChanging = 8;
+				}
+				if (m_isChanging != 8) {
+					m_prevProp[8] = m_sizeVariance;
+				} else if (Input::IsMouseUp(GLFW_MOUSE_BUTTON_LEFT)) {
+					if (m_prevProp[8] != m_sizeVariance) {
+						UndoSystem::GetInstance()->Push(new PropertyAssignmentCommand(this, &m_sizeVariance, m_prevProp[8], m_sizeVariance, "Set particle size variance to " + StringOps::ToString(m_sizeVariance) + " for " + GetOwner()->GetName()));
+					}
+					m_isChanging = -1;
+				}
+
 				if (ImGui::SliderAngle("Orientation", &m_particleOrientation, 0.f, 360.f)) {
 					m_isChanging = 4;
 				}
@@ -257,6 +355,9 @@ namespace Lobster
 					}
 					m_isChanging = -1;
 				}
+				if (ImGui::Checkbox("Depth Sort", &b_depthSort)) {
+					UndoSystem::GetInstance()->Push(new PropertyAssignmentCommand(this, &b_depthSort, !b_depthSort, b_depthSort, std::string(b_depthSort ? "Enabled" : "Disabled") + " depth sorting of particles for " + GetOwner()->GetName()));
+				}
 				ImVec2 previewSize(24, 24);
 				Texture2D* notFound = TextureLibrary::Placeholder();
 				if (ImGui::ImageButton(m_particleTexture ? m_particleTexture->Get() : notFound->Get(), previewSize)) {
@@ -277,7 +378,8 @@ namespace Lobster
 	}
 
 	void ParticleComponent::ResetParticleCount() {
-		m_particleCount = 0;
+		m_pool.Clear();
+		m_sorter.Reset();
 		_simulateElapsedTime = 0.f;
 	}
 
@@ -307,149 +409,97 @@ namespace Lobster
 
 	void ParticleComponent::FillVolume()
 	{
-		//Timer timer;
+		// start with the volume already full, as if the emitter had been running for a whole lifetime
+		m_pool.Reserve(m_particleCutoff);
+		m_pool.Clear();
+		m_sorter.Reset();
+		for (int i = 0; i < std::min(m_quota, m_particleCutoff); ++i) {
+			Spawn(true);
+		}
+	}
+
+	float ParticleComponent::GetLifetime() const
+	{
+		if (m_emissionSpeed <= 0.0f) return FLT_MAX;
+		// the box is 2 units tall, cone and sphere have a radius of 1
+		return (m_shape == EmitterShape::BOX ? 2.f : 1.f) / m_emissionSpeed;
+	}
+
+	void ParticleComponent::Spawn(bool prewarm)
+	{
+		glm::vec3 position(0.f);
+		glm::vec3 direction(0.f);
+		float life = prewarm ? RandomNumber() : 0.f;
 		switch (m_shape)
 		{
 		case EmitterShape::BOX:
-			for (int i = 0; i < MAX_PARTICLES; ++i) {
-				float x = RandomNumber() * 2.f - 1.f;
-				float y = RandomNumber() * 2.f - 1.f;
-				float z = RandomNumber() * 2.f - 1.f;
-				m_particlePositions[i] = { x, y, z };
-			}
+			position = { RandomNumber() * 2.f - 1.f, -1.f, RandomNumber() * 2.f - 1.f };
+			direction = { 0.f, 1.f, 0.f };
 			break;
 		case EmitterShape::CONE:
-			for (int i = 0; i < MAX_PARTICLES; ++i) {
-				float h = 1.f * std::cbrt(RandomNumber());
-				float r = tan(m_emissionAngle) * h * std::sqrt(RandomNumber());
-				float t = 2.f * M_PI *RandomNumber();
-				m_particlePositions[i] = { r*cos(t), h, r*sin(t) };
-			}
+		{
+			float r = tan(m_emissionAngle) * std::sqrt(RandomNumber());
+			float t = 2.f * M_PI * RandomNumber();
+			direction = glm::normalize(glm::vec3(r*cos(t), 1.f, r*sin(t)));
+			// uniform in the volume, not along the radius
+			life = std::cbrt(life);
 			break;
+		}
 		case EmitterShape::SPHERE:
-			for (int i = 0; i < MAX_PARTICLES; ++i) {
-				float u = RandomNumber() * 2.f - 1.f;
-				float x1 = RandomNumber() * 2.f - 1.f;
-				float x2 = RandomNumber() * 2.f - 1.f;
-				float x3 = RandomNumber() * 2.f - 1.f;
-				float mag = std::sqrt(x1*x1 + x2*x2 + x3*x3);
-				x1 /= mag; 
-				x2 /= mag; 
-				x3 /= mag;
-				float c = std::cbrt(u);
-				m_particlePositions[i] = { x1*c, x2*c, x3*c };
-			}
+		{
+			float z = RandomNumber() * 2.f - 1.f;
+			float t = 2.f * M_PI * RandomNumber();
+			float r = std::sqrt(1.f - z*z);
+			direction = { r*cos(t), r*sin(t), z };
+			life = std::cbrt(life);
 			break;
+		}
 		default:
 			break;
 		}
-		//LOG("Particle position generation: {}s", timer.GetElapsedTime());
+		float lifetime = GetLifetime();
+		float age = m_emissionSpeed > 0.0f ? life * lifetime : 0.f;
+		glm::vec3 velocity = direction * m_emissionSpeed;
+		float size = 1.f - m_sizeVariance * RandomNumber();
+		if (m_pool.Emit(position + velocity * age, velocity, lifetime, size, 0xFFFFFFFF, age)) m_spawned++;
 	}
 
-	void ParticleComponent::BoxEmitter(double deltaTime)
+	void ParticleComponent::Upload()
 	{
-		// emit new particle one by one
-		if (b_emitOneByOne) {
-			_simulateElapsedTime += deltaTime * m_emissionSpeed / 1000.0; // in seconds
-			if (_simulateElapsedTime > m_emissionRate) {
-				if (m_particleCount + 1 < MAX_PARTICLES) {
-					float x = RandomNumber() * 2.f - 1.f;
-					float y = -1.f;
-					float z = RandomNumber() * 2.f - 1.f;
-					m_particlePositions[m_particleCount++] = { x, y, z };
-				}
-				_simulateElapsedTime = 0.0f;
-			}
+		uint count = (uint)m_pool.GetCount();
+		if (count > 0) {
+			m_vertexBuffer->SetSubData(m_vertices.data(), count * sizeof(ParticleVertex));
 		}
-
-		// animate particles
-		for (int i = 0; i < m_particleCount; ++i) {
-			m_particlePositions[i].y += deltaTime * m_emissionSpeed / 1000.f;
-			if (m_particlePositions[i].y > 1.f) {
-				m_particlePositions[i].y = std::fmod(m_particlePositions[i].y, 2.f) - 1.99f;
-				if (_killExpiredParticle) {
-					_deathCount++;
-				}
-			}
+		if (b_depthSort && m_sorter.GetOrder().size() == count) {
+			m_indexBuffer->SetSubData(m_sorter.GetOrder().data(), count);
+			b_sortedIndices = true;
 		}
-	}
-
-	void ParticleComponent::ConeEmitter(double deltaTime)
-	{
-		// emit new particle one by one
-		if (b_emitOneByOne) {
-			_simulateElapsedTime += deltaTime * m_emissionSpeed / 1000.0; // in seconds
-			if (_simulateElapsedTime > m_emissionRate) {
-				if (m_particleCount + 1 < MAX_PARTICLES) {
-					float h = 1.f * std::cbrt(RandomNumber());
-					float r = tan(m_emissionAngle) * h * std::sqrt(RandomNumber());
-					float t = 2.f * M_PI *RandomNumber();
-					m_particlePositions[m_particleCount++] = 0.001f * glm::vec3(r*cos(t), h, r*sin(t));
-				}
-				_simulateElapsedTime = 0.0f;
-			}
-		}
-
-		// animate particles
-		for (int i = 0; i < m_particleCount; ++i) {
-			glm::vec3 direction = glm::normalize(m_particlePositions[i]);
-			m_particlePositions[i] += direction * float(deltaTime * m_emissionSpeed / 1000.f);
-			float dist = glm::length(m_particlePositions[i]);
-			if (dist > 1.f) {
-				dist = std::fmod(dist, 1.f);
-				float h = 1.f * std::cbrt(RandomNumber());
-				float r = tan(m_emissionAngle) * h * std::sqrt(RandomNumber());
-				float t = 2.f * M_PI *RandomNumber();
-				glm::vec3 position = { r*cos(t), h, r*sin(t) };
-				m_particlePositions[i] = glm::normalize(position) * dist;
-				if (_killExpiredParticle) {
-					_deathCount++;
-				}
-			}
+		else if (b_sortedIndices) {
+			std::vector<uint> indices(m_uploadCapacity);
+			std::iota(std::begin(indices), std::end(indices), 0);
+			m_indexBuffer->SetData(indices.data(), m_uploadCapacity);
+			b_sortedIndices = false;
 		}
+		m_indexBuffer->SetCount(count);
 	}
 
-	void ParticleComponent::SphereEmitter(double deltaTime)
+	void ParticleComponent::Reserve()
 	{
-		// emit new particle one by one
-		if (b_emitOneByOne) {
-			_simulateElapsedTime += deltaTime * m_emissionSpeed / 1000.0; // in seconds
-			if (_simulateElapsedTime > m_emissionRate) {
-				if (m_particleCount + 1 < MAX_PARTICLES) {
-					float u = RandomNumber() * 2.f - 1.f;
-					float x1 = RandomNumber() * 2.f - 1.f;
-					float x2 = RandomNumber() * 2.f - 1.f;
-					float x3 = RandomNumber() * 2.f - 1.f;
-					float mag = std::sqrt(x1*x1 + x2 * x2 + x3 * x3);
-					x1 /= mag;
-					x2 /= mag;
-					x3 /= mag;
-					float c = std::cbrt(u);
-					m_particlePositions[m_particleCount++] = glm::normalize(glm::vec3(x1*c, x2*c, x3*c)) * 0.001f;
-				}
-				_simulateElapsedTime = 0.0f;
-			}
-		}
-
-		// animate particle
-		for (int i = 0; i < m_particleCount; ++i) {
-			glm::vec3 direction = glm::normalize(m_particlePositions[i]);
-			m_particlePositions[i] += direction * float(deltaTime * m_emissionSpeed / 1000.f);
-			float dist = glm::length(m_particlePositions[i]);
-			if (dist > 1.f) {
-				dist = std::fmod(dist, 1.f);
-				m_particlePositions[i] = direction * dist;
-				if (_killExpiredParticle) {
-					_deathCount++;
-				}
-			}
+		m_pool.Reserve(m_particleCutoff);
+		// the buffers only grow with the pool, the live range is uploaded every frame
+		if (m_pool.GetCapacity() > m_uploadCapacity) {
+			m_uploadCapacity = m_pool.GetCapacity();
+			m_vertices.resize(m_uploadCapacity);
+			m_vertexBuffer->SetData(nullptr, m_uploadCapacity * sizeof(ParticleVertex));
+			std::vector<uint> indices(m_uploadCapacity);
+			std::iota(std::begin(indices), std::end(indices), 0);
+			m_indexBuffer->SetData(indices.data(), m_uploadCapacity);
 		}
 	}
 
 	inline float ParticleComponent::RandomNumber() const
 	{
-		float number = (float(rand()) / float(RAND_MAX));
-		return number;
+		return m_random.NextFloat();
 	}
 
 }
\ No newline at end of file
@@ -1,5 +1,9 @@
 #pragma once
 #include "Component.h"
+#include "graphics/ParticlePool.h"
+#include "graphics/ParticleSorter.h"
+#include "system/Random.h"
+#include "utils/Serialization.h"
 
 namespace Lobster
 {
@@ -7,6 +11,7 @@ namespace Lobster
 	class Material;
 	class VertexArray;
 	class VertexBuffer;
+	class IndexBuffer;
 	class Texture2D;
 
 	enum class EmitterShape : uint
@@ -14,12 +19,15 @@ namespace Lobster
 		BOX, CONE, SPHERE
 	};
 
+	//	Particle emitter. OnUpdate submits the system to the ParticleSystemManager, which simulates all of them together.
 	class ParticleComponent : public Component
 	{
+		friend class ParticleSystemManager;
 	private:
 		static const char* shapes[];
-		int m_isChanging = -1;		//	Used for undo system. 0 = emission rate, 1 = emission angle, 2 = particle color, 3 = particle size, 4 = particle orientation.
-		float m_prevProp[6];		//	Used for undo system.
+		int m_isChanging = -1;		//	Used for undo system. 0 = emission rate, 1 = emission angle, 2 = particle color, 3 = particle size, 4 = particle orientation, 5 = emission speed, 6 = gravity, 7 = drag, 8 = size variance, 9 = priority.
+		float m_prevProp[10];		//	Used for undo system.
+		glm::vec3 m_prevGravity;	//	Used for undo system.
 		int m_isChangingColor = -1;	//	Used for undo system. 0 = changing start color, 1 = changing end color.
 		glm::vec4 m_prevColor[2];	//	Used for undo system.
 		Texture2D* m_prevTexture;	//	Used for undo system.
@@ -36,21 +44,34 @@ namespace Lobster
 		float m_emissionAngle;
 		glm::vec4 m_colorStartTransition;
 		glm::vec4 m_colorEndTransition;
-		int m_particleCount;
-		int m_particleCutoff;
+		int m_particleCutoff;		//	Most particles alive at once
+		int m_priority;				//	Higher priority systems are throttled last when over the global particle budget
+		bool b_depthSort;			//	Draw back to front, for correct blending
+		bool b_sortedIndices;		//	The index buffer holds a sorted order, not the identity
+		int m_quota;				//	Cutoff given by the ParticleSystemManager for this frame
+		float m_simulationDeltaTime;	//	Seconds
+		size_t m_spawned;			//	Since the last endSimulation()
 		float m_particleSize;
+		float m_sizeVariance;		//	0 = every particle has m_particleSize, 1 = sizes spread down to 0
 		float m_particleOrientation;
 		Texture2D* m_particleTexture;
-		glm::vec3 m_particlePositions[MAX_PARTICLES];
+		ParticlePool m_pool;
+		ParticleForces m_forces;
+		ParticleSorter m_sorter;
+		std::vector<ParticleVertex> m_vertices;	//	Staging for the upload of the live range
+		size_t m_uploadCapacity;	//	Particles the GPU buffers have room for
 		Material* m_material;
 		VertexArray* m_vertexArray;
 		VertexBuffer* m_vertexBuffer;
+		IndexBuffer* m_indexBuffer;
+		mutable Random m_random;	// seeded from the particle stream, so replays emit the same particles
 	private:
 		void ResetParticleCount();
 	public:
 		ParticleComponent();
 		virtual ~ParticleComponent() override;
 		virtual void OnAttach() override;
+		virtual void OnBegin() override;
 		virtual void OnUpdate(double deltaTime) override;
 		virtual void OnImGuiRender() override;
 		virtual void Serialize(cereal::JSONOutputArchive& oarchive) override;
@@ -59,12 +80,20 @@ namespace Lobster
 		void Pause() { b_animated = true; }
 		void Simulate() { b_animated = false; }
 		void EmitOnce();
+		inline size_t GetParticleCount() const { return m_pool.GetCount(); }
 
 	private:
 		void FillVolume();
-		void BoxEmitter(double deltaTime);
-		void ConeEmitter(double deltaTime);
-		void SphereEmitter(double deltaTime);
+		//	Spawns one particle at the emitter. A prewarmed particle starts at a random point of its life.
+		void Spawn(bool prewarm);
+		float GetLifetime() const;	//	Seconds for a particle to cross the emitter volume
+		void Reserve();	//	Grows the pool and GPU buffers to the cutoff
+		void Upload();
+		//	Simulation steps run by the ParticleSystemManager. begin and Upload on the main thread,
+		//	endSimulation on any thread, after the pool is integrated. Returns the particles spawned.
+		void beginSimulation(int quota);
+		size_t endSimulation();
+		void sort();	//	Main thread, after endSimulation
 		inline float RandomNumber() const;
 	private:
 		friend class cereal::access;
@@ -76,7 +105,8 @@ namespace Lobster
 			ar(m_emissionAngle);
 			ar(m_emissionSpeed);
 			ar(m_emissionRate);
-			ar(m_particleCount);
+			int particleCount = (int)m_pool.GetCount();	//	Kept for compatibility, the particles themselves are not saved
+			ar(particleCount);
 			ar(m_particleCutoff);
 			ar(m_particleSize);
 			ar(m_colorStartTransition);
@@ -84,6 +114,11 @@ namespace Lobster
 			ar(m_particleOrientation);
 			std::string textureName = m_particleTexture == nullptr ? "" : m_particleTexture->GetName();
 			ar(textureName);
+			ar(cereal::make_nvp("gravity", m_forces.gravity));
+			ar(cereal::make_nvp("drag", m_forces.drag));
+			ar(cereal::make_nvp("sizeVariance", m_sizeVariance));
+			ar(cereal::make_nvp("priority", m_priority));
+			ar(cereal::make_nvp("depthSort", b_depthSort));
 		}
 		template <class Archive>
 		void load(Archive & ar)
@@ -93,7 +128,8 @@ namespace Lobster
 			ar(m_emissionAngle);
 			ar(m_emissionSpeed);
 			ar(m_emissionRate);
-			ar(m_particleCount);
+			int particleCount;
+			ar(particleCount);
 			ar(m_particleCutoff);
 			ar(m_particleSize);
 			ar(m_colorStartTransition);
@@ -102,6 +138,15 @@ namespace Lobster
 			std::string textureName;
 			ar(textureName);
 			m_particleTexture = textureName.empty() ? nullptr : TextureLibrary::Use(textureName.c_str());
+			//	Saved before forces existed
+			m_forces = ParticleForces();
+			m_sizeVariance = 0.0f;
+			if (Serialization::LoadOptional(ar, "gravity", m_forces.gravity)) {
+				ar(cereal::make_nvp("drag", m_forces.drag));
+				ar(cereal::make_nvp("sizeVariance", m_sizeVariance));
+			}
+			if (!Serialization::LoadOptional(ar, "priority", m_priority)) m_priority = 0;
+			if (!Serialization::LoadOptional(ar, "depthSort", b_depthSort)) b_depthSort = false;
 		}
 	};
 
@@ -0,0 +1,16 @@
+#pragma once
+#include "Event.h"
+
+namespace Lobster
+{
+
+	//	A clip played with a callback has stopped, posted by the audio thread.
+	class AudioFinishedEvent : public Event
+	{
+	public:
+		uint Callback;	// see AudioSystem::WatchClip
+	public:
+		AudioFinishedEvent(uint callback) : Event(EVENT_AUDIO_FINISHED), Callback(callback) {}
+	};
+
+}
@@ -9,7 +9,9 @@ namespace Lobster
 		EVENT_KEY_PRESSED, EVENT_KEY_RELEASED,
 		EVENT_MOUSE_PRESSED, EVENT_MOUSE_RELEASED, EVENT_MOUSE_MOVED, EVENT_MOUSE_SCROLLED,
 		EVENT_WINDOW_CLOSED, EVENT_WINDOW_FOCUSED, EVENT_WINDOW_RESIZED, EVENT_WINDOW_FOCUS, EVENT_WINDOW_MOVED, EVENT_WINDOW_MINIMIZED,
-		EVENT_VIEWPORT_RESIZED, EVENT_IMGUI_ITEM_SELECTED
+		EVENT_VIEWPORT_RESIZED, EVENT_IMGUI_ITEM_SELECTED,
+		EVENT_AUDIO_FINISHED,
+		EVENT_TYPE_COUNT
     };    
     
 	//	This struct defines what an event looks like.
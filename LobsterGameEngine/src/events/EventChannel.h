@@ -0,0 +1,103 @@
+#pragma once
+#include "Event.h"
+
+namespace Lobster
+{
+
+	typedef uint EventHandle;	// 0 is never a valid handle
+
+	//	Typed broadcast channel, one per event class.
+	//	Listeners are kept by value in a contiguous array (a function pointer and a small inline functor),
+	//	so subscribing does not allocate per listener and a broadcast is a linear walk without lookups.
+	//	Listeners may subscribe and unsubscribe during a broadcast: new listeners join once it is over,
+	//	and an unsubscribed listener is never called again.
+	// Usage:
+	//  EventHandle handle = EventChannel<KeyPressedEvent>::Subscribe([this](KeyPressedEvent* e) { ... });
+	//  EventChannel<KeyPressedEvent>::Unsubscribe(handle);
+	template<typename T>
+	class EventChannel
+	{
+	public:
+		static constexpr size_t FunctorSize = 2 * sizeof(void*);
+	private:
+		struct Delegate
+		{
+			void(*invoke)(const void* functor, T* event);
+			EventHandle handle;	// 0 once unsubscribed
+			alignas(void*) unsigned char functor[FunctorSize];
+		};
+		static std::vector<Delegate> s_delegates;
+		static std::vector<Delegate> s_pending;	// subscribed during a broadcast
+		static EventHandle s_nextHandle;
+		static uint s_depth;	// broadcasts in progress, they may nest
+		static uint s_removed;	// unsubscribed during a broadcast, still in s_delegates
+
+		static void flush()
+		{
+			if (s_removed > 0) {
+				s_delegates.erase(std::remove_if(s_delegates.begin(), s_delegates.end(), [](const Delegate& d) { return d.handle == 0; }), s_delegates.end());
+				s_removed = 0;
+			}
+			s_delegates.insert(s_delegates.end(), s_pending.begin(), s_pending.end());
+			s_pending.clear();
+		}
+
+	public:
+		//	Accepts any callable taking T*, small and trivially copyable: functions, captureless lambdas, [this] lambdas.
+		template<typename F>
+		static EventHandle Subscribe(F functor)
+		{
+			static_assert(sizeof(F) <= FunctorSize && alignof(F) <= alignof(void*), "Functor is too large for an EventChannel, capture a pointer instead");
+			static_assert(std::is_trivially_copyable<F>::value && std::is_trivially_destructible<F>::value, "Functor must be trivially copyable");
+			Delegate delegate;
+			delegate.invoke = [](const void* f, T* event) { (*reinterpret_cast<const F*>(f))(event); };
+			delegate.handle = s_nextHandle++;
+			new (delegate.functor) F(functor);
+			// s_delegates must not grow while it is walked
+			if (s_depth > 0) s_pending.push_back(delegate);
+			else s_delegates.push_back(delegate);
+			return delegate.handle;
+		}
+
+		static void Unsubscribe(EventHandle handle)
+		{
+			if (handle == 0) return;
+			for (auto it = s_pending.begin(); it != s_pending.end(); it++) {
+				if (it->handle == handle) {
+					s_pending.erase(it);
+					return;
+				}
+			}
+			for (auto it = s_delegates.begin(); it != s_delegates.end(); it++) {
+				if (it->handle != handle) continue;
+				if (s_depth > 0) {
+					it->handle = 0;
+					s_removed++;
+				}
+				else s_delegates.erase(it);
+				return;
+			}
+		}
+
+		//	Calls every listener right away. Queued events reach here through EventDispatcher::Dispatch.
+		static void Broadcast(T* event)
+		{
+			s_depth++;
+			size_t count = s_delegates.size();
+			for (size_t i = 0; i < count; i++) {
+				const Delegate& delegate = s_delegates[i];
+				if (delegate.handle) delegate.invoke(delegate.functor, event);
+			}
+			if (--s_depth == 0) flush();
+		}
+
+		inline static size_t GetCount() { return s_delegates.size() - s_removed + s_pending.size(); }
+	};
+
+	template<typename T> std::vector<typename EventChannel<T>::Delegate> EventChannel<T>::s_delegates;
+	template<typename T> std::vector<typename EventChannel<T>::Delegate> EventChannel<T>::s_pending;
+	template<typename T> EventHandle EventChannel<T>::s_nextHandle = 1;
+	template<typename T> uint EventChannel<T>::s_depth = 0;
+	template<typename T> uint EventChannel<T>::s_removed = 0;
+
+}
@@ -5,3 +5,4 @@
 #include "WindowEvent.h"
 #include "MouseEvent.h"
 #include "ImGuiEvent.h"
+#include "AudioEvent.h"
@@ -7,51 +7,31 @@ namespace Lobster
 
 	EventDispatcher* EventDispatcher::s_instance = nullptr;
 
-	void EventDispatcher::AddCallback(EventType type, IEventCallback* callback)
+	void EventDispatcher::Initialize()
 	{
-		CallbackList& callbacks = s_instance->m_callbackMap[type];
-		CallbackList::iterator position = find(callbacks.begin(), callbacks.end(), callback);
-
-		if (position != callbacks.end())
-		{
-			WARN("Action existed in delegate list.");
-			return;
-		}
-
-		callbacks.push_back(callback);
-	}
-
-	void EventDispatcher::RemoveCallback(EventType type, IEventCallback* callback)
-	{
-		CallbackList& callbacks = s_instance->m_callbackMap[type];
-		CallbackList::iterator position = find(callbacks.begin(), callbacks.end(), callback);
-
-		if (position == callbacks.end())
-		{
-			return;
-		}
-
-		callbacks.erase(position);
+		if (s_instance) return;
+		s_instance = new EventDispatcher;
+		s_instance->bind<KeyPressedEvent>(EVENT_KEY_PRESSED);
+		s_instance->bind<KeyReleasedEvent>(EVENT_KEY_RELEASED);
+		s_instance->bind<MousePressedEvent>(EVENT_MOUSE_PRESSED);
+		s_instance->bind<MouseReleasedEvent>(EVENT_MOUSE_RELEASED);
+		s_instance->bind<MouseMovedEvent>(EVENT_MOUSE_MOVED);
+		s_instance->bind<MouseScrolledEvent>(EVENT_MOUSE_SCROLLED);
+		s_instance->bind<WindowClosedEvent>(EVENT_WINDOW_CLOSED);
+		s_instance->bind<WindowFocusedEvent>(EVENT_WINDOW_FOCUSED);
+		s_instance->bind<WindowResizedEvent>(EVENT_WINDOW_RESIZED);
+		s_instance->bind<WindowMovedEvent>(EVENT_WINDOW_MOVED);
+		s_instance->bind<WindowMinimizedEvent>(EVENT_WINDOW_MINIMIZED);
+		s_instance->bind<ViewportResizedEvent>(EVENT_VIEWPORT_RESIZED);
+		s_instance->bind<ImGuiItemSelectedEvent>(EVENT_IMGUI_ITEM_SELECTED);
+		s_instance->bind<AudioFinishedEvent>(EVENT_AUDIO_FINISHED);
 	}
 
 	void EventDispatcher::Dispatch(Event* event)
 	{
-		EventType type = event->GetType();
-		bool noListeners = s_instance->m_callbackMap.find(type) == s_instance->m_callbackMap.end();
-		if (noListeners)
-		{
-			EventQueue::GetInstance()->Pop();
-			return; //  No one is listening to you, stupid event! Go away!
-		}
-
-		CallbackList& callbacks = s_instance->m_callbackMap[type];
-		for (IEventCallback* callback : callbacks)
-		{
-			(*callback)(event);
-		}
-		EventQueue::GetInstance()->Pop();	//  No one is listening to you, stupid event! Go away!
+		auto broadcast = s_instance->m_channels[event->GetType()];
+		if (broadcast) broadcast(event);	//  No one is listening to you otherwise, stupid event! Go away!
+		EventQueue::GetInstance()->Pop();
 	}
 
-
-
 } // namespace SSF
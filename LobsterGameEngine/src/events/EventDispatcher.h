@@ -1,21 +1,25 @@
 #pragma once
-#include "EventCallback.h"
+#include "EventChannel.h"
 #include "EventCollection.h"
-#include <unordered_map>
 
 namespace Lobster
 {
 
+	//	Forwards queued events to the EventChannel of their type. Listeners subscribe to the channels directly.
 	class EventDispatcher
 	{
 	private:
 		static EventDispatcher* s_instance;
-		std::unordered_map<EventType, CallbackList> m_callbackMap;
+		void(*m_channels[EVENT_TYPE_COUNT])(Event* event) = {};
+		template<typename T>
+		void bind(EventType type)
+		{
+			m_channels[type] = [](Event* event) { EventChannel<T>::Broadcast(static_cast<T*>(event)); };
+		}
 	public:
-		static void Initialize() { if (!s_instance) s_instance = new EventDispatcher; }
+		static void Initialize();
+		//	Broadcasts the front event of the EventQueue and pops it.
 		static void Dispatch(Event* event);
-		static void AddCallback(EventType type, IEventCallback* callback);
-		static void RemoveCallback(EventType type, IEventCallback* callback);
 	};
 
 } // namespace SSF
@@ -3,15 +3,25 @@
 
 namespace Lobster
 {
-    
+
     EventQueue* EventQueue::s_instance = nullptr;
-    
-	EventQueue::EventQueue()
+
+	EventQueue::EventQueue() :
+		m_slots(new Slot[Capacity]),
+		m_tail(0),
+		m_dropped(0)
     {
+		// a slot is free for position p when its sequence is p, and holds an event when it is p + 1
+		for (size_t i = 0; i < Capacity; i++)
+		{
+			m_slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
     }
-    
+
     EventQueue::~EventQueue()
     {
+		Clear();
+		delete[] m_slots;
     }
 
 	void EventQueue::Initialize()
@@ -21,30 +31,79 @@ namespace Lobster
 			s_instance = new EventQueue();
 		}
 	}
-    
-	Event* EventQueue::Next()
+
+	EventQueue::Slot* EventQueue::acquire(size_t& position)
 	{
-		if (!m_queue.empty())
+		position = m_tail.load(std::memory_order_relaxed);
+		while (true)
 		{
-			return m_queue.front();
+			Slot* slot = &m_slots[position & (Capacity - 1)];
+			size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+			if (diff == 0)
+			{
+				// on failure, position is reloaded with the current tail
+				if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) return slot;
+			}
+			else if (diff < 0)
+			{
+				// the consumer has not released this slot yet, the queue is full
+				m_dropped.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+			else
+			{
+				position = m_tail.load(std::memory_order_relaxed);
+			}
 		}
-		return nullptr;
+	}
+
+	void EventQueue::publish(Slot* slot, size_t position)
+	{
+		slot->time = HighResolutionClock::now();
+		slot->sequence.store(position + 1, std::memory_order_release);
+	}
+
+	Event* EventQueue::Next()
+	{
+		Slot* slot = &m_slots[m_head & (Capacity - 1)];
+		if (slot->sequence.load(std::memory_order_acquire) != m_head + 1) return nullptr;
+		return reinterpret_cast<Event*>(slot->storage);
 	}
 
 	void EventQueue::Pop()
 	{
-		Event* front = m_queue.front();
-		if(front) delete m_queue.front();
-		front = nullptr;
-		m_queue.pop();
+		Slot* slot = &m_slots[m_head & (Capacity - 1)];
+		if (slot->sequence.load(std::memory_order_acquire) != m_head + 1) return;
+		double latency = milliseconds_type(HighResolutionClock::now() - slot->time).count();
+		m_latencyTotal += latency;
+		m_latencyMax = std::max(m_latencyMax, latency);
+		m_dispatched++;
+		reinterpret_cast<Event*>(slot->storage)->~Event();
+		// hand the slot back to the producers for the position one lap ahead
+		slot->sequence.store(m_head + Capacity, std::memory_order_release);
+		m_head++;
 	}
 
     void EventQueue::Clear()
     {
-		while (!m_queue.empty())
+		while (Next())
 		{
-			m_queue.pop();
+			Pop();
 		}
     }
-    
+
+	EventQueueStats EventQueue::ConsumeStats()
+	{
+		EventQueueStats stats;
+		stats.dispatched = m_dispatched;
+		stats.dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+		stats.averageLatency = m_dispatched > 0 ? m_latencyTotal / m_dispatched : 0.0;
+		stats.maxLatency = m_latencyMax;
+		m_dispatched = 0;
+		m_latencyTotal = 0.0;
+		m_latencyMax = 0.0;
+		return stats;
+	}
+
 }
@@ -1,34 +1,67 @@
 #pragma once
 #include "Event.h"
 
-namespace Lobster 
+namespace Lobster
 {
-    
+
+	struct EventQueueStats
+	{
+		size_t dispatched = 0;
+		size_t dropped = 0;			// events refused because the queue was full
+		double averageLatency = 0.0;	// ms from AddEvent to Pop
+		double maxLatency = 0.0;
+	};
+
     //  EventQueue is a global singleton class for polling and issuing event.
-	//	Any unhandled events should stay in the queue until it is handled (To be discussed).
+	//	Events are constructed in place in a fixed ring of slots, so adding one never allocates.
+	//	Any thread may add events (lock-free, multi-producer); only the main thread calls Next / Pop.
+	//	When the ring is full, new events are dropped and counted, which also caps event spam within a frame.
     class EventQueue
     {
+	public:
+		static constexpr size_t Capacity = 1024;	// power of two
+		static constexpr size_t SlotSize = 64;		// bytes, the largest event must fit
     private:
-        //  TODO:
-        //  Don't use dynamic queue, use a fixed size stack array instead.
-        //  This can restrict the number of event in a fraction of a second, to prevent spam.
-		std::queue<Event*> m_queue;
+		struct Slot
+		{
+			std::atomic<size_t> sequence;
+			std::chrono::time_point<HighResolutionClock> time;
+			alignas(16) unsigned char storage[SlotSize];
+		};
+		Slot* m_slots;
+		alignas(64) std::atomic<size_t> m_tail;	// next position to write, shared by the producers
+		alignas(64) size_t m_head = 0;			// next position to read, main thread only
+		std::atomic<size_t> m_dropped;
+		size_t m_dispatched = 0;
+		double m_latencyTotal = 0.0;
+		double m_latencyMax = 0.0;
 		static EventQueue* s_instance;
+		Slot* acquire(size_t& position);
+		void publish(Slot* slot, size_t position);
     public:
         EventQueue();
         ~EventQueue();
 		Event* Next();
 		void Pop();
         void Clear();
+		//	Returns the counts and latencies since the last call.
+		EventQueueStats ConsumeStats();
 		static void Initialize();
 		inline static EventQueue* GetInstance() { return s_instance; }
+		//	Returns false if the queue is full and the event was dropped.
         template<typename T, typename ...Args>
-        inline void AddEvent(Args && ...args)
+        inline bool AddEvent(Args && ...args)
         {
-            T* newEvent = new T(args...);
-			m_queue.push(newEvent);
+			static_assert(std::is_base_of<Event, T>::value, "T must be an Event");
+			static_assert(sizeof(T) <= SlotSize && alignof(T) <= 16, "Event is too large for an EventQueue slot");
+			size_t position;
+			Slot* slot = acquire(position);
+			if (!slot) return false;
+			new (slot->storage) T(std::forward<Args>(args)...);
+			publish(slot, position);
+			return true;
         }
-		inline uint GetCount() const { return (uint)m_queue.size(); }
+		inline uint GetCount() const { return (uint)(m_tail.load(std::memory_order_relaxed) - m_head); }
     };
-    
+
 }
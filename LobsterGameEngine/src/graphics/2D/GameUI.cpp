@@ -1,8 +1,12 @@
 #include "pch.h"
 #include "GameUI.h"
+#include "Application.h"
+#include "system/Input.h"
 
 namespace Lobster {
 
+	UIStats GameUI::s_stats;
+
 	GameUI::GameUI() {
 		
 	}
@@ -18,13 +22,15 @@ namespace Lobster {
 
 	void GameUI::AddSprite(Sprite2D* sprite) {
 		assert(sprite != nullptr);
-		spriteList.push_back(sprite);
-		SortSprites();
+		spriteList.insert(std::upper_bound(spriteList.begin(), spriteList.end(), sprite, Sprite2D::Compare), sprite);
+		b_gridDirty = true;
 	}
 
 	void GameUI::RemoveSprite(Sprite2D* sprite) {
 		if (!sprite) return;
 		spriteList.erase(std::find(spriteList.begin(), spriteList.end(), sprite));
+		m_mouseOver.erase(std::remove(m_mouseOver.begin(), m_mouseOver.end(), sprite), m_mouseOver.end());
+		b_gridDirty = true;
 		delete sprite;
 	}
 
@@ -63,6 +69,63 @@ namespace Lobster {
 		return nullptr;
 	}
 
+	void GameUI::OnUpdate(double dt) {
+		if (b_gridDirty) buildGrid();
+		hitTest();
+		for (Sprite2D* sprite : spriteList) {
+			sprite->OnUpdate(dt);
+			sprite->OnLateUpdate(dt); // for callbacks
+			if (sprite->b_moved) b_gridDirty = true;
+		}
+		s_stats.sprites += spriteList.size();
+	}
+
+	void GameUI::buildGrid() {
+		for (auto& cell : m_grid) cell.clear();
+		for (Sprite2D* sprite : spriteList) {
+			sprite->b_moved = false;
+			sprite->m_gridButton = sprite->isButton;
+			if (!sprite->isButton) continue;
+			const glm::vec4& bounds = sprite->m_bounds;
+			if (bounds.x > 1.f || bounds.y > 1.f || bounds.x + bounds.z < 0.f || bounds.y + bounds.w < 0.f) continue;
+			int x0 = glm::clamp((int)(bounds.x * GridSize), 0, GridSize - 1);
+			int y0 = glm::clamp((int)(bounds.y * GridSize), 0, GridSize - 1);
+			int x1 = glm::clamp((int)((bounds.x + bounds.z) * GridSize), 0, GridSize - 1);
+			int y1 = glm::clamp((int)((bounds.y + bounds.w) * GridSize), 0, GridSize - 1);
+			for (int cy = y0; cy <= y1; cy++) {
+				for (int cx = x0; cx <= x1; cx++) m_grid[cy * GridSize + cx].push_back(sprite);
+			}
+		}
+		b_gridDirty = false;
+	}
+
+	void GameUI::hitTest() {
+		for (Sprite2D* sprite : m_mouseOver) sprite->m_mouseOver = false;
+		m_mouseOver.clear();
+		double mx, my;
+		Input::GetMousePos(mx, my);
+		Config& config = Application::GetInstance()->GetConfig();
+		float px = mx / config.width, py = my / config.height;
+		if (px < 0.f || px > 1.f || py < 0.f || py > 1.f) return;
+		int cx = std::min((int)(px * GridSize), GridSize - 1);
+		int cy = std::min((int)(py * GridSize), GridSize - 1);
+		for (Sprite2D* sprite : m_grid[cy * GridSize + cx]) {
+			s_stats.hitTests++;
+			if (Sprite2D::Contains(sprite->m_bounds, px, py)) {
+				sprite->m_mouseOver = true;
+				m_mouseOver.push_back(sprite);
+			}
+		}
+	}
+
+	UIStats GameUI::ConsumeStats() {
+		UIStats stats = s_stats;
+		stats.generated = Sprite2D::s_generated;
+		s_stats = UIStats();
+		Sprite2D::s_generated = 0;
+		return stats;
+	}
+
 	void GameUI::Serialize(cereal::JSONOutputArchive& oarchive) {
 		oarchive(*this);
 	}
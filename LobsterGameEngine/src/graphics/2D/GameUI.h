@@ -91,19 +91,40 @@ namespace Lobster {
 		}
 	};
 
+	struct UIStats {
+		size_t sprites = 0;
+		size_t generated = 0;	// sprites whose overlay commands were generated again
+		size_t hitTests = 0;	// sprites tested against the mouse
+	};
+
+	// The sprites stay in z order, and each one keeps its overlay commands until it is marked dirty,
+	// so a HUD that doesn't change only submits the commands it already has. The mouse is only tested
+	// against the buttons in its cell of a grid over the window, built again when a button moved.
 	class GameUI {
+	public:
+		static constexpr int GridSize = 8;	// cells per side
 	private:
 		std::vector<Sprite2D*> spriteList;	// a list of sprites sorted by z-values
+		std::vector<Sprite2D*> m_grid[GridSize * GridSize];	// the buttons over each cell
+		std::vector<Sprite2D*> m_mouseOver;	// the sprites the mouse was over last frame
+		bool b_gridDirty = true;
+		static UIStats s_stats;
+		void buildGrid();
+		void hitTest();
 	public:
 		GameUI();
 		~GameUI();
-		void SortSprites();				// to sort spriteList in DESCENDING ORDER
-		void AddSprite(Sprite2D* sprite);		
+		void SortSprites();				// to sort spriteList in ASCENDING ORDER (back to front)
+		void AddSprite(Sprite2D* sprite);	// inserted at its z, the others stay where they are
 		void RemoveSprite(Sprite2D* sprite);
 		void GoFront(Sprite2D* sprite); // move the item to the front by one layer
 		void GoBack(Sprite2D* sprite);	// move the item to the back by one layer
 		std::vector<Sprite2D*>& GetSpriteList();
 		Sprite2D* GetSpriteByLabel(std::string label);
+		// updates the sprites back to front, and submits their overlay commands
+		void OnUpdate(double dt);
+		// of all the GameUIs since the last call
+		static UIStats ConsumeStats();
 
 		void Serialize(cereal::JSONOutputArchive& oarchive);
 		void Deserialize(cereal::JSONInputArchive& iarchive);
@@ -199,7 +220,6 @@ namespace Lobster {
 					sprite->alignType = info.alignType;
 					std::copy(info.color, info.color + 4, sprite->color);
 					AddSprite(sprite);
-					sprite->getTexture(true);
 					break;
 				}
 				case Sprite2D::SpriteType::DynamicTextSprite:
@@ -211,7 +231,6 @@ namespace Lobster {
 					sprite->alignType = info.alignType;
 					std::copy(info.color, info.color + 4, sprite->color);
 					AddSprite(sprite);
-					sprite->getTexture(true);
 					break;
 				}
 				}				
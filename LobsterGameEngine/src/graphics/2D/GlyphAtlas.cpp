@@ -0,0 +1,181 @@
+#include "pch.h"
+#include "GlyphAtlas.h"
+#include "graphics/Texture.h"
+#include "system/MemoryTracker.h"
+
+namespace Lobster
+{
+
+	FT_Library GlyphAtlas::s_library = nullptr;
+	std::unordered_map<std::string, GlyphAtlas*> GlyphAtlas::s_atlases;
+
+	GlyphAtlas::GlyphAtlas(FT_Face face, int size) :
+		m_face(face),
+		m_size(size)
+	{
+		FT_Set_Pixel_Sizes(m_face, 0, m_size);
+		// start with about enough room for printable ASCII
+		int perRow = std::max(1, Width / (m_size + Padding));
+		int needed = (95 / perRow + 1) * (m_size + Padding) + Padding;
+		int height = 64;
+		while (height < needed) height *= 2;
+		m_height = height;
+		m_pixels.assign((size_t)Width * m_height * 4, 255);
+		for (size_t i = 3; i < m_pixels.size(); i += 4) m_pixels[i] = 0;
+		for (uint c = 32; c < 127; c++) render(c);
+	}
+
+	GlyphAtlas::~GlyphAtlas()
+	{
+		if (m_texture) delete m_texture;
+		FT_Done_Face(m_face);
+	}
+
+	GlyphAtlas* GlyphAtlas::Use(const std::string& path, int pixelSize)
+	{
+		if (pixelSize < 1) pixelSize = 1;
+		std::string key = path + "@" + std::to_string(pixelSize);
+		auto it = s_atlases.find(key);
+		if (it != s_atlases.end()) return it->second;
+		if (!s_library && FT_Init_FreeType(&s_library)) {
+			WARN("Unable to initialize FreeType Library.");
+			s_library = nullptr;
+			return nullptr;
+		}
+		FT_Face face;
+		FT_Error error = FT_New_Face(s_library, path.c_str(), 0, &face);
+		if (error == FT_Err_Unknown_File_Format) {
+			WARN("{}: Unsupported format", path);
+			return nullptr;
+		}
+		else if (error) {
+			WARN("{}: File cannot be opened", path);
+			return nullptr;
+		}
+		MemoryScope scope(MEMORY_TEXTURE);
+		GlyphAtlas* atlas = new GlyphAtlas(face, pixelSize);
+		s_atlases[key] = atlas;
+		return atlas;
+	}
+
+	void GlyphAtlas::Shutdown()
+	{
+		for (auto& [key, atlas] : s_atlases) delete atlas;
+		s_atlases.clear();
+		if (s_library) FT_Done_FreeType(s_library);
+		s_library = nullptr;
+	}
+
+	const Glyph* GlyphAtlas::render(uint c)
+	{
+		Glyph glyph = {};
+		glyph.index = FT_Get_Char_Index(m_face, c);
+		// characters the font doesn't have get its missing glyph, like FT_Load_Char does
+		if (FT_Load_Glyph(m_face, glyph.index, FT_LOAD_RENDER) == 0) {
+			FT_GlyphSlot slot = m_face->glyph;
+			const FT_Bitmap& bitmap = slot->bitmap;
+			glyph.advance = slot->advance.x >> 6;
+			glyph.bearingX = slot->bitmap_left;
+			glyph.bearingY = slot->bitmap_top;
+			if ((int)bitmap.width + 2 * Padding <= Width) {
+				glyph.width = bitmap.width;
+				glyph.height = bitmap.rows;
+			}
+		}
+		if (glyph.width > 0 && glyph.height > 0) {
+			// next row
+			if (m_penX + glyph.width + Padding > Width) {
+				m_penX = Padding;
+				m_penY += m_rowHeight + Padding;
+				m_rowHeight = 0;
+			}
+			if (m_penY + glyph.height + Padding > m_height) {
+				MemoryScope scope(MEMORY_TEXTURE);
+				size_t used = m_pixels.size();
+				while (m_penY + glyph.height + Padding > m_height) m_height *= 2;
+				m_pixels.resize((size_t)Width * m_height * 4, 255);
+				for (size_t i = used + 3; i < m_pixels.size(); i += 4) m_pixels[i] = 0;
+			}
+			glyph.x = m_penX;
+			glyph.y = m_penY;
+			const FT_Bitmap& bitmap = m_face->glyph->bitmap;
+			for (int row = 0; row < glyph.height; row++) {
+				const byte* src = bitmap.buffer + row * bitmap.pitch;
+				byte* dst = &m_pixels[((size_t)(glyph.y + row) * Width + glyph.x) * 4 + 3];
+				for (int col = 0; col < glyph.width; col++) dst[col * 4] = src[col];
+			}
+			m_penX += glyph.width + Padding;
+			m_rowHeight = std::max(m_rowHeight, glyph.height);
+			if (m_dirtyBegin == m_dirtyEnd) m_dirtyBegin = m_dirtyEnd = glyph.y;
+			m_dirtyBegin = std::min(m_dirtyBegin, glyph.y);
+			m_dirtyEnd = std::max(m_dirtyEnd, glyph.y + glyph.height);
+		}
+		return &(m_glyphs[c] = glyph);
+	}
+
+	const Glyph* GlyphAtlas::GetGlyph(uint c)
+	{
+		auto it = m_glyphs.find(c);
+		if (it != m_glyphs.end()) return &it->second;
+		return render(c);
+	}
+
+	int GlyphAtlas::GetKerning(uint left, uint right)
+	{
+		if (!FT_HAS_KERNING(m_face)) return 0;
+		unsigned long long key = (unsigned long long)left << 32 | right;
+		auto it = m_kerning.find(key);
+		if (it != m_kerning.end()) return it->second;
+		FT_Vector delta = {};
+		FT_Get_Kerning(m_face, GetGlyph(left)->index, GetGlyph(right)->index, FT_KERNING_DEFAULT, &delta);
+		return m_kerning[key] = (int)(delta.x >> 6);
+	}
+
+	float GlyphAtlas::Layout(const std::string& text, float x, float baseline, std::vector<GlyphQuad>& quads)
+	{
+		float pen = x;
+		uint previous = 0;
+		for (unsigned char c : text) {
+			const Glyph* glyph = GetGlyph(c);
+			if (previous) pen += GetKerning(previous, c);
+			if (glyph->width > 0) {
+				quads.push_back({ pen + glyph->bearingX, baseline - glyph->bearingY, glyph->width, glyph->height, glyph->x, glyph->y });
+			}
+			pen += glyph->advance;
+			previous = c;
+		}
+		return pen - x;
+	}
+
+	float GlyphAtlas::Measure(const std::string& text)
+	{
+		float width = 0.f;
+		uint previous = 0;
+		for (unsigned char c : text) {
+			if (previous) width += GetKerning(previous, c);
+			width += GetGlyph(c)->advance;
+			previous = c;
+		}
+		return width;
+	}
+
+	Texture2D* GlyphAtlas::GetTexture()
+	{
+		if (!m_texture) {
+			MemoryScope scope(MEMORY_TEXTURE);
+			std::string name = std::string("glyphs-") + m_face->family_name + "@" + std::to_string(m_size);
+			m_texture = new Texture2D(m_pixels.data(), name.c_str(), Width, m_height);
+		}
+		else if (m_texture->GetHeight() != m_height) {
+			// the atlas grew, the texture is allocated again
+			MemoryScope scope(MEMORY_TEXTURE);
+			m_texture->SetRaw(m_pixels.data(), Width, m_height);
+		}
+		else if (m_dirtyBegin < m_dirtyEnd) {
+			m_texture->SetRows(&m_pixels[(size_t)m_dirtyBegin * Width * 4], m_dirtyBegin, m_dirtyEnd - m_dirtyBegin);
+		}
+		m_dirtyBegin = m_dirtyEnd = 0;
+		return m_texture;
+	}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+namespace Lobster
+{
+
+	class Texture2D;
+
+	//	Metrics of a rendered glyph, and where its bitmap is in the atlas, in pixels.
+	struct Glyph
+	{
+		uint index;				// in the face, for kerning
+		int x, y;				// top left in the atlas
+		int width, height;
+		int bearingX, bearingY;	// from the pen position on the baseline to the top left of the bitmap
+		int advance;
+	};
+
+	//	A laid out character: where to draw it relative to the origin of the text, and where its bitmap is
+	//	in the atlas (the atlas can grow after the layout, so the texture coordinates are computed when drawing).
+	struct GlyphQuad
+	{
+		float x, y;
+		int w, h;
+		int atlasX, atlasY;
+	};
+
+	//	The glyphs of a font at one pixel size, rendered once by FreeType and packed in rows into one
+	//	texture shared by every text of that font and size. Printable ASCII is rendered when the atlas
+	//	is created, any other character the first time it is laid out; the atlas doubles in height when
+	//	a glyph doesn't fit. Changing a text only lays out quads again, nothing is rendered.
+	class GlyphAtlas
+	{
+	public:
+		static constexpr int Width = 512;
+		static constexpr int Padding = 1;	// pixels around each glyph, so linear filtering doesn't bleed into the next one
+	private:
+		static FT_Library s_library;
+		static std::unordered_map<std::string, GlyphAtlas*> s_atlases;	// by path and size
+		FT_Face m_face;
+		int m_size;
+		std::vector<byte> m_pixels;		// RGBA, white with the coverage as alpha, the color is applied when drawing
+		int m_height = 0;
+		int m_penX = Padding, m_penY = Padding, m_rowHeight = 0;	// where the next glyph goes
+		std::unordered_map<uint, Glyph> m_glyphs;
+		std::unordered_map<unsigned long long, int> m_kerning;	// left << 32 | right
+		Texture2D* m_texture = nullptr;
+		int m_dirtyBegin = 0, m_dirtyEnd = 0;	// rows changed since the last upload
+		GlyphAtlas(FT_Face face, int size);
+		const Glyph* render(uint c);
+	public:
+		~GlyphAtlas();
+		//	The atlas of a font file at pixelSize, created on first use. nullptr if the font can't be loaded.
+		static GlyphAtlas* Use(const std::string& path, int pixelSize);
+		//	Deletes every atlas and releases FreeType, needs the OpenGL context for the textures.
+		static void Shutdown();
+		//	Rendered on first use, characters the font doesn't have get its missing glyph.
+		const Glyph* GetGlyph(uint c);
+		int GetKerning(uint left, uint right);
+		//	Lays text out on one line from the pen position (x, baseline), returns its width.
+		float Layout(const std::string& text, float x, float baseline, std::vector<GlyphQuad>& quads);
+		float Measure(const std::string& text);
+		//	Uploads the rows of the glyphs rendered since the last call, or the whole atlas when it grew.
+		//	Needs the OpenGL context.
+		Texture2D* GetTexture();
+		inline FT_Face GetFace() const { return m_face; }
+		inline const char* GetFamilyName() const { return m_face->family_name; }
+		inline int GetSize() const { return m_size; }
+		inline int GetHeight() const { return m_height; }
+		inline size_t GetGlyphCount() const { return m_glyphs.size(); }
+	};
+
+}
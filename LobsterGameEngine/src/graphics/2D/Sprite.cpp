@@ -4,6 +4,7 @@
 #include "graphics/Renderer.h"
 #include "system/Input.h"
 #include "Scripts/Script.h"
+#include "scripts/ScriptVM.h"
 
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/polymorphic.hpp>
@@ -17,6 +18,7 @@ namespace Lobster {
 	// ============================================================
 
 	int Sprite2D::zLv = Z_LEVEL_MAX;
+	size_t Sprite2D::s_generated = 0;
 
 	Sprite2D::Sprite2D(float mouseX, float mouseY) : x(mouseX), y(mouseY), alpha(1.f) {
 		z = zLv--; // z value count down		
@@ -24,6 +26,22 @@ namespace Lobster {
 
 	void Sprite2D::SetZIndex(uint z) {
 		this->z = z;
+		MarkDirty();
+	}
+
+	void Sprite2D::SetX(float x) {
+		this->x = x;
+		MarkDirty();
+	}
+
+	void Sprite2D::SetY(float y) {
+		this->y = y;
+		MarkDirty();
+	}
+
+	void Sprite2D::SetAlpha(float alpha) {
+		this->alpha = alpha;
+		MarkDirty();
 	}
 
 	bool Sprite2D::Compare(Sprite2D* s1, Sprite2D* s2) {
@@ -50,22 +68,56 @@ namespace Lobster {
 		}
 	}
 
-	// do button related work
+	// do button related work, then submit the commands
 	void Sprite2D::OnUpdate(double dt) {
-		bool isMouseOver = IsMouseOver();
-		if (!isButton) return;
-		if (isMouseOver && !m_hovered) {
-			m_hovered = true;
-		}
-		if (isMouseOver && Input::IsMouseDown(GLFW_MOUSE_BUTTON_LEFT) && !m_clicked) {
-			m_clicked = true;
-		}
-		if (Input::IsMouseUp(GLFW_MOUSE_BUTTON_LEFT)) {
-			m_clicked = false;
-		}
-		if (!isMouseOver) {
-			m_hovered = false;
+		if (isButton) {
+			if (m_mouseOver && !m_hovered) {
+				m_hovered = true;
+			}
+			if (m_mouseOver && Input::IsMouseDown(GLFW_MOUSE_BUTTON_LEFT) && !m_clicked) {
+				m_clicked = true;
+			}
+			if (Input::IsMouseUp(GLFW_MOUSE_BUTTON_LEFT)) {
+				m_clicked = false;
+			}
+			if (!m_mouseOver) {
+				m_hovered = false;
+			}
 		}
+		// hover/click color
+		int blendState = 0;
+		if (Application::GetMode() == ApplicationMode::GAME && isButton && m_mouseOver) {
+			blendState = Input::IsMouseDown(GLFW_MOUSE_BUTTON_LEFT) ? 2 : 1;
+		}
+		if (blendState != m_blendState) {
+			m_blendState = blendState;
+			MarkDirty();
+		}
+		if (b_dirty) {
+			glm::vec4 bounds = m_bounds;
+			m_commands.clear();
+			generate();
+			b_dirty = false;
+			s_generated++;
+			if (bounds != m_bounds || isButton != m_gridButton) b_moved = true;
+		}
+		Renderer::Submit(m_commands.data(), m_commands.size());
+	}
+
+	void Sprite2D::applyBlend(RenderOverlayCommand& command) const {
+		const float* blend = m_blendState == 2 ? colorOnClick : m_blendState == 1 ? colorOnHover : nullptr;
+		if (!blend) return;
+		command.blendR = blend[0];
+		command.blendG = blend[1];
+		command.blendB = blend[2];
+		command.blendA = blend[3];
+	}
+
+	bool Sprite2D::IsMouseOver() {
+		double mx, my;
+		Input::GetMousePos(mx, my);
+		Config& config = Application::GetInstance()->GetConfig();
+		return Contains(m_bounds, mx / config.width, my / config.height);
 	}
 
 	void Sprite2D::OnLateUpdate(double dt)
@@ -81,15 +133,19 @@ namespace Lobster {
 		}
 	}
 
-	void Sprite2D::BasicMenuItem(GameUI* ui, ImVec2 winSize) {
+	bool Sprite2D::BasicMenuItem(GameUI* ui, ImVec2 winSize) {
+		// the menu edits the fields directly
+		MarkDirty();
+		bool edited = false;
 		// Label Property ======
 		static char label_[32];
 		if (ImGui::InputText("Label", label_, 32)) {
 			m_label = label_;
+			edited = true;
 		}
 		ImGui::Separator();
 		// Button Property ======
-		if (ImGui::Checkbox("Button", &isButton));
+		edited |= ImGui::Checkbox("Button", &isButton);
 		if (!isButton) {
 			ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
 			ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
@@ -103,22 +159,28 @@ namespace Lobster {
 				std::string displayName = dirEntry.path().filename().string();
 				scripts.push_back(displayName);
 			}
-			if (ImGui::ColorEdit4("Color OnHover", colorOnHover));
+			edited |= ImGui::ColorEdit4("Color OnHover", colorOnHover);
 			if (ImGui::BeginCombo("Script OnHover", (scriptNameOnHover.empty() ? "None" : scriptNameOnHover.c_str()))) {
-				for (std::string& file : scripts)
-					if (ImGui::Selectable(file.c_str()))
+				for (std::string& file : scripts) {
+					if (ImGui::Selectable(file.c_str())) {
 						scriptNameOnHover = file;
+						edited = true;
+					}
+				}
 				ImGui::EndCombo();
 			}
-			ImGui::InputText("Function OnHover", &funcOnHover[0], 32);
-			if (ImGui::ColorEdit4("Color OnClick", colorOnClick));
+			edited |= ImGui::InputText("Function OnHover", &funcOnHover[0], 32);
+			edited |= ImGui::ColorEdit4("Color OnClick", colorOnClick);
 			if (ImGui::BeginCombo("Script OnClick", (scriptNameOnClick.empty() ? "None" : scriptNameOnClick.c_str()))) {
-				for (std::string& file : scripts)
-					if (ImGui::Selectable(file.c_str()))
+				for (std::string& file : scripts) {
+					if (ImGui::Selectable(file.c_str())) {
 						scriptNameOnClick = file;
+						edited = true;
+					}
+				}
 				ImGui::EndCombo();
 			}
-			ImGui::InputText("Function OnClick", &funcOnClick[0], 32);
+			edited |= ImGui::InputText("Function OnClick", &funcOnClick[0], 32);
 			ImGui::TreePop();
 		}
 		if (!isButton) {
@@ -129,17 +191,21 @@ namespace Lobster {
 		ImGui::Separator();
 		if (ImGui::MenuItem("Go to Front")) {
 			ui->GoFront(this);
+			edited = true;
 		}
 		if (ImGui::MenuItem("Go to Back")) {
 			ui->GoBack(this);
+			edited = true;
 		}
 		// Clone/Delete options ======
 		ImGui::Separator();
 		ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 0, 0, 255));
 		if (ImGui::MenuItem("Delete")) {
 			ui->RemoveSprite(this);
+			edited = true;
 		}
 		ImGui::PopStyleColor();
+		return edited;
 	}
 
 	// ============================================================
@@ -175,71 +241,60 @@ namespace Lobster {
 		else if (y + ph > 1.f) y = 1.f - ph;
 	}
 
-	void ImageSprite2D::ImGuiMenu(GameUI* ui, ImVec2 winSize) {
+	bool ImageSprite2D::ImGuiMenu(GameUI* ui, ImVec2 winSize) {
 		bool autoWidth = false, autoHeight = false;
-		if (ImGui::Checkbox("Relative Size", &relativeSize));
+		bool edited = ImGui::Checkbox("Relative Size", &relativeSize);
 		// sprite width
 		if (ImGui::Button("Auto##auto_width")) {
 			w = h * m_width / m_height;
 			_w = w / winSize.x;
+			edited = true;
 		}
 		ImGui::SameLine();
 		ImGui::SetNextItemWidth(100.0f);
 		if (relativeSize) {
 			if (ImGui::SliderFloat("Width (%)", &_w, 0.f, 1.f)) {
 				w = winSize.x * _w;
+				edited = true;
 			}
 		}
 		else if (ImGui::SliderFloat("Width (px)", &w, 1.f, winSize.x, "%1.f")) {
 			_w = w / winSize.x;
+			edited = true;
 		}
 		// sprite height
 		if (ImGui::Button("Auto##auto_height")) {
 			h = w * m_height / m_width;
 			_h = h / winSize.y;
+			edited = true;
 		}
 		ImGui::SameLine();
 		ImGui::SetNextItemWidth(100.0f);
 		if (relativeSize) {
 			if (ImGui::SliderFloat("Height (%)", &_h, 0.f, 1.f)) {
 				h = winSize.y * _h;
+				edited = true;
 			}
 		}
 		else if (ImGui::SliderFloat("Height (px)", &h, 1.f, winSize.y, "%1.f")) {
 			_h = h / winSize.y;
+			edited = true;
 		}
-		ImGui::SliderFloat("Alpha", &alpha, 0.f, 1.f, "%.2f");
+		edited |= ImGui::SliderFloat("Alpha", &alpha, 0.f, 1.f, "%.2f");
 		ImGui::Separator();
 		// basic functions
-		BasicMenuItem(ui, winSize);
+		edited |= BasicMenuItem(ui, winSize);
+		return edited;
 	}
 
 	void ImageSprite2D::OnImGuiRender() {
 		ImGui::ImageButton(GetTexID(), ImVec2(w, h));
 	}
 
-	void ImageSprite2D::OnUpdate(double dt) {
-		// run script
-		Sprite2D::OnUpdate(dt);
-		// hover/click color
-		RenderOverlayCommand ocommand;		
-		if (Application::GetMode() == ApplicationMode::GAME && isButton) {
-			bool mouseOver = IsMouseOver();
-			if (mouseOver && Input::IsMouseDown(GLFW_MOUSE_BUTTON_LEFT)) {
-				ocommand.blendR = colorOnClick[0];
-				ocommand.blendG = colorOnClick[1];
-				ocommand.blendB = colorOnClick[2];
-				ocommand.blendA = colorOnClick[3];
-			}
-			else if (mouseOver) {
-				ocommand.blendR = colorOnHover[0];
-				ocommand.blendG = colorOnHover[1];
-				ocommand.blendB = colorOnHover[2];
-				ocommand.blendA = colorOnHover[3];
-			}
-		}
-		// submit draw command
+	void ImageSprite2D::generate() {
 		Config& config = Application::GetInstance()->GetConfig();
+		RenderOverlayCommand ocommand;
+		applyBlend(ocommand);
 		ocommand.UseTexture = tex;
 		ocommand.type = RenderOverlayCommand::Image;
 		ocommand.x = x * config.defaultWidth;
@@ -247,165 +302,135 @@ namespace Lobster {
 		ocommand.w = w;
 		ocommand.h = h;
 		ocommand.alpha = alpha;
-		ocommand.z = (float)z / Z_LEVEL_MAX;
-		Renderer::Submit(ocommand);		
-	}
-
-	bool ImageSprite2D::IsMouseOver() {
-		double mx, my;
-		Input::GetMousePos(mx, my);
-		Config& config = Application::GetInstance()->GetConfig();
-		float winX = mx / config.width;
-		float winY = my / config.height;
-		if (winX >= x && winX <= x + _w && winY >= y && winY <= y + _h) return true;
-		return false;
+		ocommand.z = z;
+		m_commands.push_back(ocommand);
+		m_bounds = glm::vec4(x, y, w / config.defaultWidth, h / config.defaultHeight);
 	}
 
 	// ============================================================
 	// TextSprite2D
 	// ============================================================
 
-	FT_Library TextSprite2D::s_library = nullptr;
 	Texture2D* TextSprite2D::m_iconTex[3] = {};
 
 	TextSprite2D::TextSprite2D(const char* text, const char* typeface, float fontSize, float winW, float winH, float mouseX, float mouseY) : 
 		Sprite2D(mouseX, mouseY), text(text), fontName(typeface) {	
 		spriteType = SpriteType::TextSprite;
-		// initialize static library, only called once
-		if (!s_library) {
-			FT_Error error = FT_Init_FreeType(&s_library);
-			if (error) { ERROR("Unable to initialize FreeType Library."); throw; }
-			// load the icons for button
+		// load the icons for button, only called once
+		if (!m_iconTex[0]) {
 			for (int i = 0; i < 3; i++) {
 				m_iconTex[i] = TextureLibrary::Use(FileSystem::Path(m_iconPath[i]).c_str());
 			}
 		}
+		// set font size
+		SetFontSize(fontSize);
 		// initialize face
 		std::string resPath = FileSystem::Path(FileSystem::Join(PATH_FONT, typeface));
 		loadFace(resPath);
-		// set font size
-		SetFontSize(fontSize);
-		// load the texture into it first
-		getTexture();
 	}
 
 	void TextSprite2D::SetFontSize(float size) {
+		// the atlas of the new size is picked up by layout()
 		fontSize = size;
-		FT_Set_Pixel_Sizes(m_face, 0, size);
+		MarkDirty();
 	}
 
 	void TextSprite2D::SetColor(float r, float g, float b, float a) {
 		color[0] = r; color[1] = g; color[2] = b; color[3] = a;
+		MarkDirty();
 	}
 
-	Texture2D* TextSprite2D::getTexture(bool reload) {
-		// z-value should be unique in all sprites
-		char id[8];
-		sprintf(id, "%d", z);
-		// search if the texture already exists
-		Texture2D* texture = TextureLibrary::Use(id, nullptr, 0, 0);
-		if (reload || !texture) {
-			int off = 0;
-			int pixelWidth = 0; // bounding box width in pixel
-			// first iteration: calculate bounding box and kerning information
-			for (int n = 0; n < text.size(); n++) {
-				FT_Load_Char(m_face, text[n], FT_LOAD_RENDER);
-				FT_Bitmap bmp = m_face->glyph->bitmap;
-				pixelWidth += (bmp.width ? bmp.width : (m_face->glyph->advance.x >> 6));
-			}
-			// define the buffer to pass to OpenGL
-			int ww = fontSize * text.size();
-			int hh = fontSize * 2;
-			std::vector<byte> buffer(ww * hh * 4, 0); // RGBA 4 channels
-			// second iteration: render text into texture
-			for (int n = 0; n < text.size(); n++) {
-				// load glyph image into the slot (erase previous one) and renderer immediately
-				FT_Load_Char(m_face, text[n], FT_LOAD_RENDER);
-				FT_Bitmap bmp = m_face->glyph->bitmap;
-				int bW = bmp.width;
-				int bH = bmp.rows;
-				// create the texture buffer of the entire text
-				int top = hh * 0.66 - m_face->glyph->bitmap_top; // approx. vert center aligned
-				int left = 0;
-				if (alignType == Center) left = (ww - pixelWidth) / 2;
-				else if (alignType == Right) left = ww - pixelWidth;
-				for (int h = 0; h < bH; ++h) {
-					for (int w = 0; w < bW; ++w) {		
-						int pos = 4 * ((top + h) * ww + off + w + left);
-						buffer[pos] = color[0] * 255;
-						buffer[pos + 1] = color[1] * 255;
-						buffer[pos + 2] = color[2] * 255;
-						buffer[pos + 3] = bmp.buffer[h * bW + w];						
-					}
-				}
-				// shift position
-				off += (m_face->glyph->advance.x >> 6);
-			}
-			// load the buffer into texture
-			texture = TextureLibrary::Use(id, buffer.data(), ww, hh);
-		}
-		return texture;
+	const std::vector<GlyphQuad>& TextSprite2D::layout() {
+		if (m_atlas && m_atlas->GetSize() != (int)fontSize) {
+			m_atlas = GlyphAtlas::Use(m_fontPath, (int)fontSize);
+		}
+		if (m_atlas == m_layoutAtlas && text == m_layoutText && alignType == m_layoutAlign) return m_quads;
+		m_layoutAtlas = m_atlas;
+		m_layoutText = text;
+		m_layoutAlign = alignType;
+		m_quads.clear();
+		// e.g. laid out by the editor preview, the commands have the old quads
+		MarkDirty();
+		if (!m_atlas) return m_quads;
+		// same box as before the atlas: fontSize per character wide, baseline at 2/3 of twice the font size
+		float width = fontSize * text.size();
+		float left = 0.f;
+		if (alignType == Center) left = (width - m_atlas->Measure(text)) / 2;
+		else if (alignType == Right) left = width - m_atlas->Measure(text);
+		m_atlas->Layout(text, left, fontSize * 2 * 0.66f, m_quads);
+		return m_quads;
 	}
 
 	void TextSprite2D::loadFace(std::string fullpath) {
-		// release memory
-		if (m_face) {
-			FT_Done_Face(m_face);
-			m_face = nullptr;
-		}
-		// reinitialize face		
-		FT_Error error = FT_New_Face(s_library, fullpath.c_str(), 0, &m_face);
-		if (error == FT_Err_Unknown_File_Format) {
-			ERROR("{}: Unsupported format", fullpath.c_str());
-			throw;
-		}
-		else if (error) {
-			ERROR("{}: File cannot be opened", fullpath.c_str());
-			throw;
-		}
+		// the atlas warns when the font can't be loaded, the text is not drawn then
+		m_fontPath = fullpath;
+		m_atlas = GlyphAtlas::Use(m_fontPath, (int)fontSize);
 	}
 
 	void TextSprite2D::OnUpdate(double dt) {
-		// run script
-		Sprite2D::OnUpdate(dt);
-		// hover/click color
-		RenderOverlayCommand ocommand;
-		if (Application::GetMode() == ApplicationMode::GAME && isButton) {
-			bool mouseOver = IsMouseOver();
-			if (mouseOver && Input::IsMouseDown(GLFW_MOUSE_BUTTON_LEFT)) {
-				ocommand.blendR = colorOnClick[0];
-				ocommand.blendG = colorOnClick[1];
-				ocommand.blendB = colorOnClick[2];
-				ocommand.blendA = colorOnClick[3];
-			}
-			else if (mouseOver) {
-				ocommand.blendR = colorOnHover[0];
-				ocommand.blendG = colorOnHover[1];
-				ocommand.blendB = colorOnHover[2];
-				ocommand.blendA = colorOnHover[3];
-			}
+		// the text is also assigned directly, e.g. by DynamicTextSprite2D
+		if (text != m_layoutText) MarkDirty();
+		if (m_atlas) {
+			// uploads the glyphs other texts rendered, the texture coordinates change when the atlas grew
+			m_atlas->GetTexture();
+			if (m_atlas->GetHeight() != m_layoutHeight) MarkDirty();
 		}
-		// submit draw command
+		Sprite2D::OnUpdate(dt);
+	}
+
+	void TextSprite2D::generate() {
 		Config& config = Application::GetInstance()->GetConfig();
-		Texture2D* texture = getTexture();
+		m_bounds = glm::vec4(x, y, fontSize * text.size() / config.defaultWidth, fontSize * 2 / config.defaultHeight);
+		// a quad per character, all from the glyph atlas
+		const std::vector<GlyphQuad>& quads = layout();
+		if (quads.empty()) return;
+		Texture2D* texture = m_atlas->GetTexture();
+		m_layoutHeight = m_atlas->GetHeight();
+		float atlasW = (float)GlyphAtlas::Width, atlasH = (float)m_layoutHeight;
+		RenderOverlayCommand ocommand;
+		applyBlend(ocommand);
 		ocommand.UseTexture = texture;
 		ocommand.type = RenderOverlayCommand::Text;
-		ocommand.x = x * config.defaultWidth;
-		ocommand.y = y * config.defaultHeight;
-		ocommand.w = fontSize * text.size();
-		ocommand.h = fontSize * 2;
 		ocommand.alpha = alpha;
-		ocommand.z = (float)z / Z_LEVEL_MAX;
-		Renderer::Submit(ocommand);
-	}	
+		ocommand.tintR = color[0];
+		ocommand.tintG = color[1];
+		ocommand.tintB = color[2];
+		ocommand.z = z;
+		for (const GlyphQuad& quad : quads) {
+			ocommand.x = x * config.defaultWidth + quad.x;
+			ocommand.y = y * config.defaultHeight + quad.y;
+			ocommand.w = (float)quad.w;
+			ocommand.h = (float)quad.h;
+			ocommand.u0 = quad.atlasX / atlasW;
+			ocommand.v0 = quad.atlasY / atlasH;
+			ocommand.u1 = (quad.atlasX + quad.w) / atlasW;
+			ocommand.v1 = (quad.atlasY + quad.h) / atlasH;
+			m_commands.push_back(ocommand);
+		}
+	}
 
 	void TextSprite2D::OnImGuiRender() {
 		int length = fontSize * text.size();
 		ImGui::SetWindowFontScale(fontSize / ImGui::GetFontSize());
 		ImGui::PushStyleColor(0, ImVec4(color[0], color[1], color[2], 1.f));
 		ImGui::PushStyleVar(ImGuiStyleVar_ButtonTextAlign, ImVec2(0.f, 0.5f));
-		if (m_preview) {
-			ImGui::ImageButton(getTexture()->Get(), ImVec2(fontSize * text.size(), fontSize * 2));
+		if (m_preview && m_atlas) {
+			// the quads drawn in the game, over an invisible button to drag
+			ImVec2 origin = ImGui::GetCursorScreenPos();
+			ImGui::PushID(this);
+			ImGui::InvisibleButton("Preview", ImVec2(fontSize * text.size(), fontSize * 2));
+			ImGui::PopID();
+			const std::vector<GlyphQuad>& quads = layout();
+			ImTextureID texture = m_atlas->GetTexture()->Get();
+			float atlasW = (float)GlyphAtlas::Width, atlasH = (float)m_atlas->GetHeight();
+			ImU32 tint = ImGui::ColorConvertFloat4ToU32(ImVec4(color[0], color[1], color[2], alpha));
+			for (const GlyphQuad& quad : quads) {
+				ImVec2 p0(origin.x + quad.x, origin.y + quad.y);
+				ImVec2 p1(p0.x + quad.w, p0.y + quad.h);
+				ImVec2 uv0(quad.atlasX / atlasW, quad.atlasY / atlasH);
+				ImVec2 uv1((quad.atlasX + quad.w) / atlasW, (quad.atlasY + quad.h) / atlasH);
+				ImGui::GetWindowDrawList()->AddImage(texture, p0, p1, uv0, uv1, tint);
+			}
 		}
 		else {
 			ImGui::Button(text.c_str(), ImVec2(0, fontSize * 2));
@@ -415,12 +440,13 @@ namespace Lobster {
 		ImGui::SetWindowFontScale(1.f);
 	}
 
-	void TextSprite2D::ImGuiMenuHelper() {
+	bool TextSprite2D::ImGuiMenuHelper() {
+		bool edited = false;
 		// alignment buttons
 		for (int type = HorizontalAlignType::Left; type < HorizontalAlignType::Count; type++) {
 			if (ImGui::ImageButton(m_iconTex[type]->Get(), ImVec2(16, 16))) {
 				alignType = (HorizontalAlignType)type;
-				getTexture(true);
+				edited = true;
 			}
 			ImGui::SameLine();
 		}
@@ -430,14 +456,14 @@ namespace Lobster {
 		ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
 		ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
 		fs::path subdir = FileSystem::Path(PATH_FONT);
-		if (ImGui::BeginCombo("Font Type", m_face->family_name)) {
+		if (ImGui::BeginCombo("Font Type", m_atlas ? m_atlas->GetFamilyName() : fontName.c_str())) {
 			for (const auto& dirEntry : fs::recursive_directory_iterator(subdir)) {
 				std::string displayName = dirEntry.path().stem().string();
 				if (ImGui::Selectable(displayName.c_str(), false)) {
 					// with unknown reason, switching font after constructor does not work
 					std::string path = FileSystem::Join(PATH_FONT, dirEntry.path().filename().string());
 					loadFace(FileSystem::Path(path));
-					getTexture(true);
+					edited = true;
 				}
 			}
 			ImGui::EndCombo();
@@ -455,28 +481,24 @@ namespace Lobster {
 		}
 		// ===================================
 		// font size
-		ImGui::InputFloat("Font Size", &fontSize, 1.f, 1.f, "%.1f");
+		edited |= ImGui::InputFloat("Font Size", &fontSize, 1.f, 1.f, "%.1f");
 		// color picker
-		if (ImGui::ColorEdit3("Font Color", color)) {
-			getTexture(true);
-		}
-		if (ImGui::SliderFloat("Alpha", &alpha, 0.f, 1.f, "%.2f")) {
-			getTexture(true);
-		}
+		edited |= ImGui::ColorEdit3("Font Color", color);
+		edited |= ImGui::SliderFloat("Alpha", &alpha, 0.f, 1.f, "%.2f");
 		ImGui::Separator();
+		return edited;
 	}
 
-	void TextSprite2D::ImGuiMenu(GameUI* ui, ImVec2 winSize) {
+	bool TextSprite2D::ImGuiMenu(GameUI* ui, ImVec2 winSize) {
 		// preview mode
 		ImGui::Checkbox("Preview", &m_preview);
 		// text content		
-		if (ImGui::InputText("Text", &text[0], MAX_TEXT_LENGTH)) {
-			getTexture(true); // reload texture
-		}
+		bool edited = ImGui::InputText("Text", &text[0], MAX_TEXT_LENGTH);
 		// text formatting
-		ImGuiMenuHelper();
+		edited |= ImGuiMenuHelper();
 		// basic functions
-		BasicMenuItem(ui, winSize);
+		edited |= BasicMenuItem(ui, winSize);
+		return edited;
 	}
 
 	void TextSprite2D::Clip() {
@@ -489,15 +511,6 @@ namespace Lobster {
 		else if (y + height > 1.f) y = 1.f - height;
 	}
 
-	bool TextSprite2D::IsMouseOver() {
-		double mx, my;
-		Input::GetMousePos(mx, my);
-		float w = fontSize * text.size();
-		float h = fontSize * 2;
-		if (mx >= x && mx <= x + w && my >= y && my <= y + h) return true;
-		return false;
-	}
-
 	// ============================================================
 	// DynamicTextSprite2D
 	// ============================================================
@@ -509,21 +522,30 @@ namespace Lobster {
 		text = "<" + var + ">";
 	}
 
+	DynamicTextSprite2D::~DynamicTextSprite2D() {
+		if (script) delete script;
+	}
+
 	void DynamicTextSprite2D::OnBegin() {
 		// load script
+		if (script) {
+			delete script;
+			script = nullptr;
+		}
 		if (!scriptName.empty() && !var.empty()) {
 			script = new Script(scriptName.c_str());
+			// only re-read the variable when the script assigns it
+			script->Watch(var);
 		}
 		TextSprite2D::OnBegin();
-		script->OnBegin();		
+		if (script) script->OnBegin();
 	}
 
 	void DynamicTextSprite2D::OnUpdate(double dt) {
-		static std::string prevText = text;
 		if (script && Application::GetMode() == GAME) {
 			script->OnUpdate(dt);
-			luabridge::LuaRef ref = script->GetVar(var.c_str());
-			static char prevErrmsg[512];
+			// the variable is watched, so it is only read and formatted again after the script assigned it
+			luabridge::LuaRef ref = script->ConsumeChange(var) ? script->GetVar(var.c_str()) : luabridge::LuaRef(ScriptVM::GetState());
 			if (!ref.isNil()) {
 				try {
 					switch (type) {
@@ -545,11 +567,10 @@ namespace Lobster {
 					}
 				}
 				catch (std::exception& e) {
-					char errmsg[512];
-					sprintf(errmsg, "%s in %s: %s", var.c_str(), scriptName.c_str(), e.what());
-					if (strcmp(prevErrmsg, errmsg) != 0) {
+					std::string errmsg = var + " in " + scriptName + ": " + e.what();
+					if (prevErrmsg != errmsg) {
 						WARN(errmsg);
-						strcpy(prevErrmsg, errmsg);
+						prevErrmsg = errmsg;
 					}
 					text = "<" + var + ">";
 				}
@@ -558,25 +579,23 @@ namespace Lobster {
 		else {
 			text = "<" + var + ">";
 		}
-		// reload texture if content changed
-		if (prevText != text) {
-			getTexture(true);
-			prevText = text;
-		}		
-		// render the text
+		// render the text, only laid out again if it changed
 		TextSprite2D::OnUpdate(dt);
 	}
 
-	void DynamicTextSprite2D::ImGuiMenu(GameUI* ui, ImVec2 winSize) {
+	bool DynamicTextSprite2D::ImGuiMenu(GameUI* ui, ImVec2 winSize) {
+		bool edited = false;
 		// script to track
 		if (ImGui::BeginCombo("Script", (scriptName.empty() ? "None" : scriptName.c_str()))) {
 			if (ImGui::Selectable("None")) {
 				scriptName.clear();
+				edited = true;
 			}
 			for (const auto& dirEntry : fs::recursive_directory_iterator(FileSystem::Path(PATH_SCRIPTS))) {
 				std::string displayName = dirEntry.path().filename().string();
 				if (ImGui::Selectable(displayName.c_str())) {
 					scriptName = displayName;
+					edited = true;
 				}
 			}
 			ImGui::EndCombo();
@@ -586,14 +605,15 @@ namespace Lobster {
 		if (ImGui::InputText("Variable", &var[0], MAX_TEXT_LENGTH)) {
 			var = var.c_str(); // i know, this is stupid, but it works to fix a bug
 			text = "<" + var + ">";
-			getTexture(true); // reload texture
+			edited = true;
 		}
 		// variable type to track
 		const static char* vtypeStr[] = { "int", "float", "string" };
-		ImGui::Combo("Type", (int*)&type, vtypeStr, IM_ARRAYSIZE(vtypeStr));
+		edited |= ImGui::Combo("Type", (int*)&type, vtypeStr, IM_ARRAYSIZE(vtypeStr));
 		// text formatting
-		ImGuiMenuHelper();
-		BasicMenuItem(ui, winSize);
+		edited |= ImGuiMenuHelper();
+		edited |= BasicMenuItem(ui, winSize);
+		return edited;
 	}
 
 } 
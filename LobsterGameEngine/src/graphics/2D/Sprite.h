@@ -1,6 +1,8 @@
 #pragma once
 #include "pch.h"
 #include "graphics/texture.h"
+#include "graphics/Renderer.h"
+#include "graphics/2D/GlyphAtlas.h"
 
 namespace Lobster {
 	class GameUI;
@@ -8,11 +10,21 @@ namespace Lobster {
 
 	// Sprite2D is only applicable in GameUI
 	// For 3D sprite and particles, use Sprite3D
+	// A sprite keeps its overlay commands and submits them every frame, they are only generated again
+	// when it is marked dirty. Anything that changes how it looks must call MarkDirty.
 	class Sprite2D {
 		friend class GameUI;
 	protected:
-		int z;	// z-index (smaller goes to the front, allow negative)
+		int z;	// z-index (larger goes to the front, allow negative)
 		static int zLv;
+		static size_t s_generated;	// sprites generated again since the last GameUI::ConsumeStats
+		bool b_dirty = true;		// the overlay commands must be generated again
+		bool b_moved = false;		// the bounds or the button flag changed since GameUI built its hit-test grid
+		bool m_mouseOver = false;	// set every frame by GameUI, from its hit-test grid
+		bool m_gridButton = false;	// isButton when the grid was built
+		int m_blendState = 0;		// 0, hovered or clicked, the blend color of the commands
+		glm::vec4 m_bounds = glm::vec4(0.f);	// x, y, width, height as fractions of the window, when last generated
+		std::vector<RenderOverlayCommand> m_commands;
 		std::string m_label; // used for get sprite directly in script
 		bool m_clicked = false;
 		bool m_hovered = false;
@@ -26,7 +38,11 @@ namespace Lobster {
 		std::string scriptNameOnHover, scriptNameOnClick;
 		std::string funcOnHover = "OnHover", funcOnClick = "OnClick";
 
-		void BasicMenuItem(GameUI* ui, ImVec2 winSize);
+		bool BasicMenuItem(GameUI* ui, ImVec2 winSize);
+		// fills m_commands (empty) and m_bounds from the current state
+		virtual void generate() = 0;
+		// the hover/click color of a button
+		void applyBlend(RenderOverlayCommand& command) const;
 	public:
 		float x;	// the x position of the sprite, in percentage [0, 1]
 		float y;	// the y position of the sprite, in percentage [0, 1]
@@ -38,16 +54,29 @@ namespace Lobster {
 		inline int GetZIndex() const { return z; }
 
 		void SetZIndex(uint z);		
+		inline void MarkDirty() { b_dirty = true; }
+		inline const glm::vec4& GetBounds() const { return m_bounds; }
+		// the properties of scripts, which mark the sprite dirty
+		inline float GetX() const { return x; }
+		inline float GetY() const { return y; }
+		inline float GetAlpha() const { return alpha; }
+		void SetX(float x);
+		void SetY(float y);
+		void SetAlpha(float alpha);
 		virtual void Clip() {}
-		virtual void ImGuiMenu(GameUI* ui, ImVec2 winSize) = 0;
+		// the context menu of the sprite in the UI editor, returns whether it changed the sprite or the GameUI
+		virtual bool ImGuiMenu(GameUI* ui, ImVec2 winSize) = 0;
 		virtual void OnBegin();
 		virtual void OnUpdate(double dt);
 		virtual void OnLateUpdate(double dt);
 		virtual void OnImGuiRender() = 0;
-		virtual bool IsMouseOver() { return false; }
+		bool IsMouseOver();
 		virtual std::string GetLabel() { return m_label; }
-		// compare if s1 is in front of s2chec
+		// compare if s1 is behind s2
 		static bool Compare(Sprite2D* s1, Sprite2D* s2);
+		static inline bool Contains(const glm::vec4& bounds, float px, float py) {
+			return px >= bounds.x && px <= bounds.x + bounds.z && py >= bounds.y && py <= bounds.y + bounds.w;
+		}
 	};
 
 	class ImageSprite2D : public Sprite2D {	
@@ -68,10 +97,10 @@ namespace Lobster {
 		inline std::string GetPath() const { return path; }
 
 		virtual void Clip() override;	// adjust x, y into reasonable range
-		virtual void ImGuiMenu(GameUI* ui, ImVec2 winSize) override;
-		virtual void OnUpdate(double dt) override;
+		virtual bool ImGuiMenu(GameUI* ui, ImVec2 winSize) override;
 		virtual void OnImGuiRender() override;
-		virtual bool IsMouseOver() override;
+	protected:
+		virtual void generate() override;
 	};
 
 	class TextSprite2D : public Sprite2D {
@@ -80,9 +109,9 @@ namespace Lobster {
 		enum HorizontalAlignType { Left, Center, Right, Count };
 	protected:
 		static const int MAX_TEXT_LENGTH = 128;
-		static FT_Library s_library; // note that FT_Library is a pointer type
 		HorizontalAlignType alignType = Left;
-		FT_Face m_face = nullptr;
+		GlyphAtlas* m_atlas = nullptr;	// of the font at fontSize, shared with the other texts
+		std::string m_fontPath;
 		float fontSize = 12.f;
 		float color[4] = { 1.f, 1.f, 1.f, 1.f }; // font color, in range [0, 1]
 		std::string text;
@@ -93,18 +122,22 @@ namespace Lobster {
 			"textures/ui/align-left.png", "textures/ui/align-center.png", "textures/ui/align-right.png"
 		};
 		static Texture2D* m_iconTex[3];
+		// the quads of the text, laid out again only when the text, font, size or alignment changes
+		std::vector<GlyphQuad> m_quads;
+		std::string m_layoutText;
+		GlyphAtlas* m_layoutAtlas = nullptr;
+		HorizontalAlignType m_layoutAlign = Left;
+		int m_layoutHeight = 0;	// of the atlas when the commands were generated, the texture coordinates depend on it
 	protected:
-		// find texture base on the id, if no texture found, create one with the id
-		// AG: For FYP, this part works fine. If we gonna further develop, it is highly 
-		// prioritized for refactor.
-		Texture2D* getTexture(bool reload = false);
+		// lays the text out with the glyph atlas, if anything changed since the last call
+		const std::vector<GlyphQuad>& layout();
 		// helper function to load typeface
 		void loadFace(std::string fullpath);
 	public:
 		TextSprite2D(const char* text, const char* typeface, float fontSize, float winW, float winH, float mouseX, float mouseY);
 
 		// setter
-		inline void SetText(const char* text) { this->text = text; }
+		inline void SetText(const char* text) { this->text = text; MarkDirty(); }
 		void SetFontSize(float size);
 		void SetColor(float r, float g, float b, float a);
 		// getter
@@ -114,11 +147,12 @@ namespace Lobster {
 		inline glm::vec4 GetColor() { return glm::vec4(color[0], color[1], color[2], color[3]); }
 		
 		virtual void Clip() override;		
-		virtual void ImGuiMenuHelper(); // let its descendent call helper directly on text formatting
-		virtual void ImGuiMenu(GameUI* ui, ImVec2 winSize) override;		
+		virtual bool ImGuiMenuHelper(); // let its descendent call helper directly on text formatting
+		virtual bool ImGuiMenu(GameUI* ui, ImVec2 winSize) override;		
 		virtual void OnUpdate(double dt) override;
 		virtual void OnImGuiRender() override;
-		virtual bool IsMouseOver() override;
+	protected:
+		virtual void generate() override;
 	};
 
 	class DynamicTextSprite2D final : public TextSprite2D {
@@ -130,6 +164,7 @@ namespace Lobster {
 		std::string scriptName;
 		std::string var;
 		SupportedVarType type;
+		std::string prevErrmsg;
 	public:
 		DynamicTextSprite2D(const char* sname, const char* vname, SupportedVarType vtype, const char* typeface, float fontSize,
 			float winW, float winH, float mouseX, float mouseY);
@@ -138,9 +173,11 @@ namespace Lobster {
 		inline std::string GetVarName() { return var; }
 		inline SupportedVarType GetVarType() { return type; }
 
+		~DynamicTextSprite2D();
+
 		virtual void OnBegin() override;
 		virtual void OnUpdate(double dt) override;
-		virtual void ImGuiMenu(GameUI* ui, ImVec2 winSize) override;
+		virtual bool ImGuiMenu(GameUI* ui, ImVec2 winSize) override;
 	};
 
 }
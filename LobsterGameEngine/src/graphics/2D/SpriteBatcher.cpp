@@ -0,0 +1,70 @@
+#include "pch.h"
+#include "SpriteBatcher.h"
+
+namespace Lobster
+{
+
+	void SpriteBatcher::Build(const FrameVector<RenderOverlayCommand>& commands)
+	{
+		m_vertices.clear();
+		m_indices.clear();
+		m_order.clear();
+		m_batchCount = 0;
+		// the last submitted is the front one among equal z
+		for (auto it = commands.rbegin(); it != commands.rend(); ++it) {
+			if (it->UseTexture) m_order.push_back(&*it);
+		}
+		std::stable_sort(m_order.begin(), m_order.end(), [](const RenderOverlayCommand* a, const RenderOverlayCommand* b) {
+			if (a->z != b->z) return a->z > b->z;
+			return std::less<Texture2D*>()(a->UseTexture, b->UseTexture);
+		});
+		m_vertices.reserve(m_order.size() * 4);
+		m_indices.reserve(m_order.size() * 6);
+
+		SpriteBatch* batch = nullptr;
+		for (const RenderOverlayCommand* command : m_order) {
+			int slot = -1;
+			if (batch) {
+				auto it = std::find(batch->textures.begin(), batch->textures.end(), command->UseTexture);
+				if (it != batch->textures.end()) slot = (int)(it - batch->textures.begin());
+				else if (batch->textures.size() == MaxTextures) batch = nullptr;
+			}
+			if (!batch) {
+				// reuse the batches of the previous frames, with their textures storage
+				if (m_batchCount == m_batches.size()) m_batches.emplace_back();
+				batch = &m_batches[m_batchCount++];
+				batch->firstIndex = (uint)m_indices.size();
+				batch->indexCount = 0;
+				batch->textures.clear();
+			}
+			if (slot < 0) {
+				slot = (int)batch->textures.size();
+				batch->textures.push_back(command->UseTexture);
+			}
+			// corners of the unit quad of MeshFactory::Sprite, which are also its texture coordinates
+			static const float corners[4][2] = { { 0.f, 1.f }, { 1.f, 0.f }, { 0.f, 0.f }, { 1.f, 1.f } };
+			uint first = (uint)m_vertices.size();
+			for (const auto& corner : corners) {
+				SpriteVertex vertex;
+				vertex.x = command->x + corner[0] * command->w;
+				vertex.y = command->y + corner[1] * command->h;
+				vertex.u = command->u0 + corner[0] * (command->u1 - command->u0);
+				vertex.v = command->v0 + corner[1] * (command->v1 - command->v0);
+				vertex.tintR = command->tintR;
+				vertex.tintG = command->tintG;
+				vertex.tintB = command->tintB;
+				vertex.alpha = command->alpha;
+				vertex.blendR = command->blendR;
+				vertex.blendG = command->blendG;
+				vertex.blendB = command->blendB;
+				vertex.blendA = command->blendA;
+				vertex.texture = slot;
+				m_vertices.push_back(vertex);
+			}
+			const uint quad[6] = { 0, 1, 2, 0, 3, 1 };
+			for (uint index : quad) m_indices.push_back(first + index);
+			batch->indexCount += 6;
+		}
+	}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "graphics/Renderer.h"
+
+namespace Lobster
+{
+
+	class Texture2D;
+
+	//	A corner of an overlay quad, with everything the sprite shader used to get as uniforms.
+	struct SpriteVertex
+	{
+		float x, y;
+		float u, v;
+		float tintR, tintG, tintB, alpha;
+		float blendR, blendG, blendB, blendA;
+		int texture;	// slot in the textures of the batch
+	};
+
+	//	A range of quads drawn with one draw call.
+	struct SpriteBatch
+	{
+		uint firstIndex;
+		uint indexCount;
+		std::vector<Texture2D*> textures;	// bound to the texture units 1.. in this order
+	};
+
+	//	Turns the overlay commands of a frame into one vertex buffer, on the CPU. The commands are
+	//	sorted front to back (larger z first), then by texture, and a batch only ends when the next
+	//	quad needs one more texture than a draw can sample (MaxTextures), so a HUD takes a handful of
+	//	draws instead of one per sprite. The quads of a batch keep their order, the depth test keeps
+	//	the front ones.
+	class SpriteBatcher
+	{
+	public:
+		static constexpr int MaxTextures = 8;	// samplers of the sprite shader, unit 0 is the background
+	private:
+		std::vector<SpriteVertex> m_vertices;
+		std::vector<uint> m_indices;
+		std::vector<SpriteBatch> m_batches;
+		std::vector<const RenderOverlayCommand*> m_order;
+		size_t m_batchCount = 0;		// m_batches keeps the textures vectors of older frames
+	public:
+		//	Builds the vertices, indices and batches of commands, given in submission order (back to front).
+		void Build(const FrameVector<RenderOverlayCommand>& commands);
+		inline const std::vector<SpriteVertex>& GetVertices() const { return m_vertices; }
+		inline const std::vector<uint>& GetIndices() const { return m_indices; }
+		inline const SpriteBatch* GetBatches() const { return m_batches.data(); }
+		inline size_t GetBatchCount() const { return m_batchCount; }
+		inline size_t GetSpriteCount() const { return m_order.size(); }
+	};
+
+}
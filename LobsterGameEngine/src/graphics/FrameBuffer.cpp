@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "FrameBuffer.h"
 #include "graphics/Texture.h"
+#include "Application.h"
 
 namespace Lobster
 {
@@ -8,19 +9,23 @@ namespace Lobster
 	FrameBuffer::FrameBuffer(int width, int height, const std::vector<RenderTargetDesc>& renderTargetsDesc) :
 		m_width(width),
 		m_height(height),
+		m_FBO(0),
+		m_RBO(0),
 		m_renderTargets(nullptr),
 		m_renderTargetsDesc(renderTargetsDesc)
 	{
-		// create frame and render buffers
-		glGenFramebuffers(1, &m_FBO);
-		glGenRenderbuffers(1, &m_RBO);
 		// create a single render target by default
 		if (m_renderTargetsDesc.empty()) {
 			RenderTargetDesc desc;
 			m_renderTargetsDesc.push_back(desc);
 		}
+		m_renderTargets = new uint[m_renderTargetsDesc.size()]();
+		// headless runs have no OpenGL, the frame buffer then only keeps its size
+		if (Application::IsHeadless()) return;
+		// create frame and render buffers
+		glGenFramebuffers(1, &m_FBO);
+		glGenRenderbuffers(1, &m_RBO);
 		// create render targets according to RenderTargetDesc
-		m_renderTargets = new uint[m_renderTargetsDesc.size()];
 		for (int i = 0; i < m_renderTargetsDesc.size(); ++i) {
 			uint targetId;
 			RenderTargetDesc& desc = m_renderTargetsDesc[i];
@@ -32,9 +37,11 @@ namespace Lobster
 
 	FrameBuffer::~FrameBuffer()
 	{
-		glDeleteFramebuffers(1, &m_FBO);
-		glDeleteRenderbuffers(1, &m_RBO);
-		glDeleteTextures(m_renderTargetsDesc.size(), m_renderTargets);
+		if (m_FBO) {
+			glDeleteFramebuffers(1, &m_FBO);
+			glDeleteRenderbuffers(1, &m_RBO);
+			glDeleteTextures(m_renderTargetsDesc.size(), m_renderTargets);
+		}
 		if (m_renderTargets) delete[] m_renderTargets;
 		m_renderTargets = nullptr;
 	}
@@ -76,6 +83,7 @@ namespace Lobster
 	{
 		m_width = width;
 		m_height = height;
+		if (!m_FBO) return;
 		glViewport(0, 0, width, height);
 		for (int i = 0; i < m_renderTargetsDesc.size(); ++i) {
 			RenderTargetDesc& desc = m_renderTargetsDesc[i];
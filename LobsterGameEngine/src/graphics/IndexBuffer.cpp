@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "IndexBuffer.h"
+#include "Application.h"
 
 namespace Lobster
 {
@@ -8,12 +9,14 @@ namespace Lobster
         m_id(0),
         m_count(0)
     {
+        // headless runs have no OpenGL, the buffer then stays at id 0 and only keeps its count
+        if (Application::IsHeadless()) return;
         glGenBuffers(1, &m_id);
     }
     
     IndexBuffer::~IndexBuffer()
     {
-        glDeleteBuffers(1, &m_id);
+        if (m_id) glDeleteBuffers(1, &m_id);
     }
     
     void IndexBuffer::Bind() const
@@ -29,8 +32,16 @@ namespace Lobster
     void IndexBuffer::SetData(uint *data, uint count)
     {
         m_count = count;
+		if (!m_id) return;
 		Bind();
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_count * sizeof(uint), data, GL_STATIC_DRAW);
     }
+
+    void IndexBuffer::SetSubData(const uint* data, uint count, uint offset)
+    {
+		if (!m_id) return;
+		Bind();
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset * sizeof(uint), count * sizeof(uint), data);
+    }
     
 }
@@ -17,6 +17,10 @@ namespace Lobster
         void Bind() const;
         void Unbind() const;
         void SetData(uint* data, uint count);
+        //  Overwrites count indices from offset, without reallocating. SetData must have allocated enough.
+        void SetSubData(const uint* data, uint count, uint offset = 0);
+        //  Draws only the first count indices, which must not exceed the count given to SetData.
+        inline void SetCount(uint count) { m_count = count; }
         inline uint GetCount() const { return m_count; }
         inline uint GetID() const { return m_id; }
     };
@@ -4,6 +4,8 @@
 #include "Texture.h"
 #include "layer/EditorLayer.h"
 #include "objects/GameObject.h"
+#include "system/FrameAllocator.h"
+#include "system/MemoryTracker.h"
 #include "system/UndoSystem.h"
 
 namespace Lobster
@@ -114,6 +116,7 @@ namespace Lobster
 	void Material::ResizeUniformBuffer(size_t newSize)
 	{
 		if (newSize == m_uniformDataSize) return;
+		MemoryScope scope(MEMORY_MATERIAL);
 		// create new buffer with new size
 		byte* newBuffer = new byte[newSize];
 		// copy the content from the old buffer
@@ -150,11 +153,12 @@ namespace Lobster
 		ImGui::PopItemWidth();
 
 		// Uniforms
-		auto declaration = m_shader->GetUniformDeclarations();
+		const auto& declaration = m_shader->GetUniformDeclarations();
 		size_t offset = 0;
-		for (auto decl : declaration) {
+		for (const auto& decl : declaration) {
 			void* data = m_uniformData + offset;
-			std::string str_id = decl.Name + "##" + m_name;
+			FrameString str_id(decl.Name.begin(), decl.Name.end());
+			str_id.append("##").append(m_name.begin(), m_name.end());
 			ImGui::PushID(str_id.c_str());
 			switch (decl.Type) 
 			{
@@ -252,8 +256,8 @@ namespace Lobster
 	void Material::SetRawUniform(const char * name, void * data)
 	{
 		size_t offset = 0;
-		auto declaration = m_shader->GetUniformDeclarations();
-		for (auto decl : declaration) {
+		const auto& declaration = m_shader->GetUniformDeclarations();
+		for (const auto& decl : declaration) {
 			if (decl.Name == name) {
 				memcpy(m_uniformData + offset, data, decl.Size());
 			}
@@ -272,10 +276,9 @@ namespace Lobster
 	{
 		if (targetShader == nullptr) return;
 		if (m_uniformData == nullptr) return;
-		auto declaration = m_shader->GetUniformDeclarations();
+		const auto& declaration = m_shader->GetUniformDeclarations();
 		size_t offset = 0;
-		for (auto decl : declaration) {
-			std::string label = decl.Name;
+		for (const auto& decl : declaration) {
 			byte* data = m_uniformData + offset;
 			if (decl.Type == UniformDeclaration::SAMPLER2D) {
 				uint slot = *(uint*)data;
@@ -342,6 +345,14 @@ namespace Lobster
 		s_instance = new MaterialLibrary();
 	}
 
+	void MaterialLibrary::SaveDirty()
+	{
+		for (Material* material : s_instance->m_materials)
+		{
+			if (material->IsDirty()) material->SaveConfiguration();
+		}
+	}
+
 	void MaterialLibrary::Clear()
 	{
 		for (Material* material : s_instance->m_materials)
@@ -357,6 +368,7 @@ namespace Lobster
 
 	Material * MaterialLibrary::Use(const char * path)
 	{
+		MemoryScope scope(MEMORY_MATERIAL);
 		for (Material* material : s_instance->m_materials)
 		{
 			if (material->GetName() == path)
@@ -371,6 +383,7 @@ namespace Lobster
 
 	Material * MaterialLibrary::UseShader(const char * shaderPath)
 	{
+		MemoryScope scope(MEMORY_MATERIAL);
 		return new Material(ShaderLibrary::Use(shaderPath));
 	}
 
@@ -47,6 +47,7 @@ namespace Lobster
 		inline Texture2D* GetTexture(int index) const { return m_textures[index]; }
 		inline RenderingMode GetRenderingMode() const { return m_mode; }
 		inline void SetRenderingMode(RenderingMode mode) { m_mode = mode; }
+		inline bool IsDirty() const { return b_dirty; }
 	private:
 		void ChangeShaderType();
 		inline void SetDirty() { b_dirty = true; }
@@ -105,6 +106,8 @@ namespace Lobster
 		static Material* UseShader(const char* shaderPath);
 		static Material* UseDefault();
 		static void ResizeUniformBuffer(Shader* shader);
+		//	Writes the configuration of every material changed in the editor, e.g. when the scene is saved.
+		static void SaveDirty();
 	};
     
 }
@@ -0,0 +1,224 @@
+#include "pch.h"
+#include "ParticlePool.h"
+
+//	The widest instruction set the compiler is allowed to use. x64 always has SSE2,
+//	AVX is used when the project is built with it enabled (/arch:AVX, -mavx).
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define PARTICLE_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	#include <emmintrin.h>
+	#define PARTICLE_SIMD_WIDTH 4
+#else
+	#define PARTICLE_SIMD_WIDTH 1
+#endif
+
+namespace Lobster
+{
+
+#if PARTICLE_SIMD_WIDTH == 8
+	typedef __m256 simd_float;
+	inline simd_float simd_load(const float* p) { return _mm256_loadu_ps(p); }
+	inline void simd_store(float* p, simd_float v) { _mm256_storeu_ps(p, v); }
+	inline simd_float simd_set(float f) { return _mm256_set1_ps(f); }
+	inline simd_float simd_add(simd_float a, simd_float b) { return _mm256_add_ps(a, b); }
+	inline simd_float simd_sub(simd_float a, simd_float b) { return _mm256_sub_ps(a, b); }
+	inline simd_float simd_mul(simd_float a, simd_float b) { return _mm256_mul_ps(a, b); }
+	inline bool simd_any_ge(simd_float a, simd_float b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ)) != 0; }
+#elif PARTICLE_SIMD_WIDTH == 4
+	typedef __m128 simd_float;
+	inline simd_float simd_load(const float* p) { return _mm_loadu_ps(p); }
+	inline void simd_store(float* p, simd_float v) { _mm_storeu_ps(p, v); }
+	inline simd_float simd_set(float f) { return _mm_set1_ps(f); }
+	inline simd_float simd_add(simd_float a, simd_float b) { return _mm_add_ps(a, b); }
+	inline simd_float simd_sub(simd_float a, simd_float b) { return _mm_sub_ps(a, b); }
+	inline simd_float simd_mul(simd_float a, simd_float b) { return _mm_mul_ps(a, b); }
+	inline bool simd_any_ge(simd_float a, simd_float b) { return _mm_movemask_ps(_mm_cmpge_ps(a, b)) != 0; }
+#endif
+
+	ParticlePool::ParticlePool(size_t capacity) :
+		m_positionX(nullptr),
+		m_positionY(nullptr),
+		m_positionZ(nullptr),
+		m_velocityX(nullptr),
+		m_velocityY(nullptr),
+		m_velocityZ(nullptr),
+		m_age(nullptr),
+		m_lifetime(nullptr),
+		m_size(nullptr),
+		m_color(nullptr),
+		m_memory(nullptr),
+		m_count(0),
+		m_capacity(0)
+	{
+		Reserve(capacity);
+	}
+
+	ParticlePool::~ParticlePool()
+	{
+		if (m_memory) delete[] m_memory;
+		m_memory = nullptr;
+	}
+
+	void ParticlePool::Reserve(size_t capacity)
+	{
+		if (capacity <= m_capacity) return;
+		// round every array up to whole AVX registers, so each one starts aligned
+		const size_t lanes = Alignment / sizeof(float);
+		capacity = (capacity + lanes - 1) / lanes * lanes;
+		const size_t arrayBytes = capacity * sizeof(float);
+		unsigned char* memory = new unsigned char[arrayBytes * 10 + Alignment];
+		unsigned char* base = reinterpret_cast<unsigned char*>((reinterpret_cast<uintptr_t>(memory) + Alignment - 1) & ~(uintptr_t)(Alignment - 1));
+		float* arrays[9];
+		for (int i = 0; i < 9; i++) {
+			arrays[i] = reinterpret_cast<float*>(base + arrayBytes * i);
+		}
+		uint* color = reinterpret_cast<uint*>(base + arrayBytes * 9);
+		// keep the live particles
+		if (m_count > 0) {
+			const float* old[9] = { m_positionX, m_positionY, m_positionZ, m_velocityX, m_velocityY, m_velocityZ, m_age, m_lifetime, m_size };
+			for (int i = 0; i < 9; i++) {
+				memcpy(arrays[i], old[i], m_count * sizeof(float));
+			}
+			memcpy(color, m_color, m_count * sizeof(uint));
+		}
+		if (m_memory) delete[] m_memory;
+		m_memory = memory;
+		m_positionX = arrays[0];
+		m_positionY = arrays[1];
+		m_positionZ = arrays[2];
+		m_velocityX = arrays[3];
+		m_velocityY = arrays[4];
+		m_velocityZ = arrays[5];
+		m_age = arrays[6];
+		m_lifetime = arrays[7];
+		m_size = arrays[8];
+		m_color = color;
+		m_capacity = capacity;
+	}
+
+	bool ParticlePool::Emit(const glm::vec3& position, const glm::vec3& velocity, float lifetime, float size, uint color, float age)
+	{
+		if (m_count >= m_capacity) return false;
+		size_t i = m_count++;
+		m_positionX[i] = position.x;
+		m_positionY[i] = position.y;
+		m_positionZ[i] = position.z;
+		m_velocityX[i] = velocity.x;
+		m_velocityY[i] = velocity.y;
+		m_velocityZ[i] = velocity.z;
+		m_age[i] = age;
+		m_lifetime[i] = lifetime;
+		m_size[i] = size;
+		m_color[i] = color;
+		return true;
+	}
+
+	void ParticlePool::move(size_t from, size_t to)
+	{
+		m_positionX[to] = m_positionX[from];
+		m_positionY[to] = m_positionY[from];
+		m_positionZ[to] = m_positionZ[from];
+		m_velocityX[to] = m_velocityX[from];
+		m_velocityY[to] = m_velocityY[from];
+		m_velocityZ[to] = m_velocityZ[from];
+		m_age[to] = m_age[from];
+		m_lifetime[to] = m_lifetime[from];
+		m_size[to] = m_size[from];
+		m_color[to] = m_color[from];
+	}
+
+	void ParticlePool::Integrate(float deltaTime, const ParticleForces& forces, size_t begin, size_t end)
+	{
+		// v' = v * damping + g * dt, then p' = p + v' * dt (semi-implicit Euler)
+		const float damping = std::max(0.0f, 1.0f - forces.drag * deltaTime);
+		const glm::vec3 gravity = forces.gravity * deltaTime;
+		size_t i = begin;
+		end = std::min(end, m_count);
+#if PARTICLE_SIMD_WIDTH > 1
+		const simd_float dt = simd_set(deltaTime);
+		const simd_float d = simd_set(damping);
+		const simd_float gx = simd_set(gravity.x);
+		const simd_float gy = simd_set(gravity.y);
+		const simd_float gz = simd_set(gravity.z);
+		for (; i + PARTICLE_SIMD_WIDTH <= end; i += PARTICLE_SIMD_WIDTH) {
+			simd_float vx = simd_add(simd_mul(simd_load(m_velocityX + i), d), gx);
+			simd_float vy = simd_add(simd_mul(simd_load(m_velocityY + i), d), gy);
+			simd_float vz = simd_add(simd_mul(simd_load(m_velocityZ + i), d), gz);
+			simd_store(m_velocityX + i, vx);
+			simd_store(m_velocityY + i, vy);
+			simd_store(m_velocityZ + i, vz);
+			simd_store(m_positionX + i, simd_add(simd_load(m_positionX + i), simd_mul(vx, dt)));
+			simd_store(m_positionY + i, simd_add(simd_load(m_positionY + i), simd_mul(vy, dt)));
+			simd_store(m_positionZ + i, simd_add(simd_load(m_positionZ + i), simd_mul(vz, dt)));
+			simd_store(m_age + i, simd_add(simd_load(m_age + i), dt));
+		}
+#endif
+		// remainder, or everything without SIMD
+		for (; i < end; i++) {
+			m_velocityX[i] = m_velocityX[i] * damping + gravity.x;
+			m_velocityY[i] = m_velocityY[i] * damping + gravity.y;
+			m_velocityZ[i] = m_velocityZ[i] * damping + gravity.z;
+			m_positionX[i] += m_velocityX[i] * deltaTime;
+			m_positionY[i] += m_velocityY[i] * deltaTime;
+			m_positionZ[i] += m_velocityZ[i] * deltaTime;
+			m_age[i] += deltaTime;
+		}
+	}
+
+	size_t ParticlePool::Kill()
+	{
+		size_t killed = 0;
+		size_t i = 0;
+		while (i < m_count) {
+#if PARTICLE_SIMD_WIDTH > 1
+			// most blocks have no expired particle, skip them whole
+			if (i + PARTICLE_SIMD_WIDTH <= m_count && !simd_any_ge(simd_load(m_age + i), simd_load(m_lifetime + i))) {
+				i += PARTICLE_SIMD_WIDTH;
+				continue;
+			}
+#endif
+			if (m_age[i] >= m_lifetime[i]) {
+				// the moved-in particle is tested again in the next iteration
+				move(--m_count, i);
+				killed++;
+			}
+			else i++;
+		}
+		return killed;
+	}
+
+	void ParticlePool::WriteDistances(const glm::vec3& point, float* out) const
+	{
+		size_t i = 0;
+#if PARTICLE_SIMD_WIDTH > 1
+		const simd_float px = simd_set(point.x);
+		const simd_float py = simd_set(point.y);
+		const simd_float pz = simd_set(point.z);
+		for (; i + PARTICLE_SIMD_WIDTH <= m_count; i += PARTICLE_SIMD_WIDTH) {
+			simd_float dx = simd_sub(simd_load(m_positionX + i), px);
+			simd_float dy = simd_sub(simd_load(m_positionY + i), py);
+			simd_float dz = simd_sub(simd_load(m_positionZ + i), pz);
+			simd_store(out + i, simd_add(simd_add(simd_mul(dx, dx), simd_mul(dy, dy)), simd_mul(dz, dz)));
+		}
+#endif
+		for (; i < m_count; i++) {
+			float dx = m_positionX[i] - point.x;
+			float dy = m_positionY[i] - point.y;
+			float dz = m_positionZ[i] - point.z;
+			out[i] = dx * dx + dy * dy + dz * dz;
+		}
+	}
+
+	void ParticlePool::WriteVertices(ParticleVertex* out) const
+	{
+		for (size_t i = 0; i < m_count; i++) {
+			ParticleVertex& vertex = out[i];
+			vertex.position = glm::vec3(m_positionX[i], m_positionY[i], m_positionZ[i]);
+			vertex.size = m_size[i];
+			vertex.age = m_age[i] / m_lifetime[i];
+			vertex.color = m_color[i];
+		}
+	}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+namespace Lobster
+{
+
+	//	Constant forces applied to every particle of a pool.
+	struct ParticleForces
+	{
+		glm::vec3 gravity = glm::vec3(0.0f);	// acceleration, units / s^2
+		float drag = 0.0f;						// fraction of the velocity lost per second
+	};
+
+	//	One particle as uploaded to the GPU, see GPUParticle.glsl.
+	struct ParticleVertex
+	{
+		glm::vec3 position;
+		float size;
+		float age;		// normalized, 0 when spawned and 1 when expired
+		uint color;		// RGBA8
+	};
+
+	//	Structure-of-arrays particle storage with a capacity of any size.
+	//	Every attribute is a separate contiguous array, so the kernels below stream through memory
+	//	and process 4 (SSE) or 8 (AVX) particles per instruction. Live particles are always packed
+	//	in [0, count), expired ones are removed by moving the last particle into their place.
+	class ParticlePool
+	{
+	public:
+		static constexpr size_t Alignment = 32;	// bytes, one AVX register
+	private:
+		float* m_positionX;
+		float* m_positionY;
+		float* m_positionZ;
+		float* m_velocityX;
+		float* m_velocityY;
+		float* m_velocityZ;
+		float* m_age;			// seconds
+		float* m_lifetime;		// seconds
+		float* m_size;
+		uint* m_color;
+		unsigned char* m_memory;	// all the arrays above, in one block
+		size_t m_count;
+		size_t m_capacity;
+		void move(size_t from, size_t to);
+	public:
+		ParticlePool(size_t capacity = 0);
+		~ParticlePool();
+		ParticlePool(const ParticlePool&) = delete;
+		ParticlePool& operator=(const ParticlePool&) = delete;
+		//	Grows the arrays, live particles are kept. Never shrinks.
+		void Reserve(size_t capacity);
+		inline void Clear() { m_count = 0; }
+		//	Returns false if the pool is full.
+		bool Emit(const glm::vec3& position, const glm::vec3& velocity, float lifetime, float size = 1.0f, uint color = 0xFFFFFFFF, float age = 0.0f);
+		//	Applies the forces, then moves and ages every particle by deltaTime (seconds).
+		inline void Integrate(float deltaTime, const ParticleForces& forces) { Integrate(deltaTime, forces, 0, m_count); }
+		//	Same for the particles in [begin, end) only. Disjoint ranges may be integrated on different threads.
+		void Integrate(float deltaTime, const ParticleForces& forces, size_t begin, size_t end);
+		//	Removes the particles that outlived their lifetime and returns how many were removed.
+		size_t Kill();
+		//	Writes the squared distance from point of every live particle to out, which must hold count floats.
+		void WriteDistances(const glm::vec3& point, float* out) const;
+		//	Writes the live range [0, count) to out, which must hold count vertices.
+		void WriteVertices(ParticleVertex* out) const;
+		inline size_t GetCount() const { return m_count; }
+		inline size_t GetCapacity() const { return m_capacity; }
+		inline glm::vec3 GetPosition(size_t i) const { return glm::vec3(m_positionX[i], m_positionY[i], m_positionZ[i]); }
+	};
+
+}
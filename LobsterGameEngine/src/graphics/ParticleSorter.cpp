@@ -0,0 +1,120 @@
+#include "pch.h"
+#include "ParticleSorter.h"
+#include "graphics/ParticlePool.h"
+
+namespace Lobster
+{
+
+	//	Runs work(c) for every chunk c, all but the last on the ThreadPool.
+	template<typename Work>
+	static void runChunks(size_t chunks, Work work)
+	{
+		std::vector<std::future<void>> jobs;
+		for (size_t c = 0; c + 1 < chunks; c++) {
+			jobs.push_back(ThreadPool::Enqueue([&work, c]() { work(c); }));
+		}
+		if (chunks > 0) work(chunks - 1);
+		for (auto& job : jobs) job.get();
+	}
+
+	void ParticleSorter::computeKeys(const ParticlePool& pool, const glm::vec3& eye)
+	{
+		size_t count = pool.GetCount();
+		m_distances.resize(count);
+		pool.WriteDistances(eye, m_distances.data());
+		float nearest = FLT_MAX;
+		float farthest = 0.0f;
+		for (float distance : m_distances) {
+			nearest = std::min(nearest, distance);
+			farthest = std::max(farthest, distance);
+		}
+		// farthest gets key 0, so ascending keys draw back to front
+		float scale = farthest > nearest ? 65535.0f / (farthest - nearest) : 0.0f;
+		auto item = [&](uint i) { return (unsigned long long)((farthest - m_distances[i]) * scale) << 32 | i; };
+
+		// last frame's order, rekeyed. Its indices were [0, previous): the ones past the live
+		// range went with the killed particles and [previous, count) are new
+		size_t previous = m_items.size();
+		size_t kept = 0;
+		for (size_t i = 0; i < previous; i++) {
+			uint index = (uint)m_items[i];
+			if (index < count) m_items[kept++] = item(index);
+		}
+		m_items.resize(kept);
+		for (size_t i = previous; i < count; i++) {
+			m_items.push_back(item((uint)i));
+		}
+	}
+
+	bool ParticleSorter::refine()
+	{
+		size_t shifts = 0;
+		for (size_t i = 1; i < m_items.size(); i++) {
+			unsigned long long item = m_items[i];
+			unsigned long long key = item >> 32;
+			size_t j = i;
+			while (j > 0 && (m_items[j - 1] >> 32) > key) {
+				m_items[j] = m_items[j - 1];
+				j--;
+			}
+			m_items[j] = item;
+			shifts += i - j;
+			// too far from sorted, the radix sort is cheaper from here. Checked against the
+			// items so far, so a hopeless refinement gives up early
+			if (shifts > i * MaxShiftsPerItem + 256) return false;
+		}
+		return true;
+	}
+
+	void ParticleSorter::radixSort()
+	{
+		const size_t count = m_items.size();
+		if (count == 0) return;
+		m_temp.resize(count);
+		const size_t chunks = count >= ParallelThreshold ? (count + ChunkSize - 1) / ChunkSize : 1;
+		const size_t chunkSize = (count + chunks - 1) / chunks;
+		std::vector<size_t> histograms(chunks * 256);
+		// keys are 16 bit, in bits 32 to 47
+		for (int shift = 32; shift < 48; shift += 8) {
+			std::fill(histograms.begin(), histograms.end(), 0);
+			runChunks(chunks, [&](size_t c) {
+				size_t* histogram = &histograms[c * 256];
+				size_t end = std::min(count, (c + 1) * chunkSize);
+				for (size_t i = c * chunkSize; i < end; i++) {
+					histogram[(m_items[i] >> shift) & 255]++;
+				}
+			});
+			// each chunk writes each digit after the same digit of the chunks before it, which keeps the sort stable
+			size_t offset = 0;
+			for (size_t digit = 0; digit < 256; digit++) {
+				for (size_t c = 0; c < chunks; c++) {
+					size_t n = histograms[c * 256 + digit];
+					histograms[c * 256 + digit] = offset;
+					offset += n;
+				}
+			}
+			runChunks(chunks, [&](size_t c) {
+				size_t* histogram = &histograms[c * 256];
+				size_t end = std::min(count, (c + 1) * chunkSize);
+				for (size_t i = c * chunkSize; i < end; i++) {
+					unsigned long long item = m_items[i];
+					m_temp[histogram[(item >> shift) & 255]++] = item;
+				}
+			});
+			m_items.swap(m_temp);
+		}
+	}
+
+	void ParticleSorter::Sort(const ParticlePool& pool, const glm::vec3& eye)
+	{
+		bool coherent = !m_items.empty();
+		computeKeys(pool, eye);
+		b_refined = coherent && refine();
+		if (!b_refined) radixSort();
+		m_order.resize(m_items.size());
+		for (size_t i = 0; i < m_items.size(); i++) {
+			m_order[i] = (uint)m_items[i];
+		}
+	}
+
+}
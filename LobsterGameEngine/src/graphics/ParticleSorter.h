@@ -0,0 +1,40 @@
+#pragma once
+
+namespace Lobster
+{
+
+	class ParticlePool;
+
+	//	Orders the particles of a pool back to front for alpha blending, as an index buffer.
+	//	Each particle gets a 16 bit key from its distance to the camera, quantized over the distance
+	//	range of the frame, and keys are sorted with an LSD radix sort: two 8 bit passes, each split
+	//	into chunks on the ThreadPool for large pools. Particles move little between frames, so last
+	//	frame's order is usually almost sorted: it is refined with an insertion sort first, and the
+	//	radix sort only runs when the refinement needs too many moves.
+	class ParticleSorter
+	{
+	public:
+		static constexpr size_t ChunkSize = 16384;			// items per radix sort job
+		static constexpr size_t ParallelThreshold = 32768;	// smaller pools are sorted on the calling thread
+		static constexpr size_t MaxShiftsPerItem = 1;		// refinement budget before falling back to the radix sort
+	private:
+		std::vector<unsigned long long> m_items;	// key << 32 | particle index
+		std::vector<unsigned long long> m_temp;
+		std::vector<float> m_distances;
+		std::vector<uint> m_order;
+		bool b_refined = false;
+		void computeKeys(const ParticlePool& pool, const glm::vec3& eye);
+		bool refine();
+		void radixSort();
+	public:
+		//	Sorts the live particles of pool, farthest from eye first. eye is in the space of the particles.
+		void Sort(const ParticlePool& pool, const glm::vec3& eye);
+		//	Forgets last frame's order, e.g. when the pool was refilled.
+		inline void Reset() { m_items.clear(); }
+		//	Particle indices, farthest first.
+		inline const std::vector<uint>& GetOrder() const { return m_order; }
+		//	Whether the last Sort only refined the previous order.
+		inline bool WasRefined() const { return b_refined; }
+	};
+
+}
@@ -0,0 +1,167 @@
+#include "pch.h"
+#include "ParticleSystemManager.h"
+#include "components/CameraComponent.h"
+#include "components/ParticleComponent.h"
+
+namespace Lobster
+{
+
+	ParticleSystemManager* ParticleSystemManager::s_instance = nullptr;
+
+	ParticleSystemManager::ParticleSystemManager(size_t budget) :
+		m_budget(budget)
+	{
+	}
+
+	void ParticleSystemManager::Initialize(size_t budget)
+	{
+		if (s_instance != nullptr)
+		{
+			throw std::runtime_error("ParticleSystemManager already existed!");
+		}
+		s_instance = new ParticleSystemManager(budget);
+	}
+
+	void ParticleSystemManager::Submit(ParticleComponent* system, double deltaTime)
+	{
+		Entry entry;
+		entry.system = system;
+		entry.deltaTime = deltaTime;
+		entry.weight = 1.0f;
+		entry.quota = system->m_particleCutoff;
+		s_instance->m_systems.push_back(entry);
+	}
+
+	void ParticleSystemManager::Remove(ParticleComponent* system)
+	{
+		if (!s_instance) return;
+		std::vector<Entry>& systems = s_instance->m_systems;
+		systems.erase(std::remove_if(systems.begin(), systems.end(), [system](const Entry& entry) { return entry.system == system; }), systems.end());
+	}
+
+	void ParticleSystemManager::distribute()
+	{
+		size_t requested = 0;
+		for (const Entry& entry : m_systems) requested += entry.quota;
+		m_stats.throttled = 0;
+		if (m_budget == 0 || requested <= m_budget) return;
+
+		CameraComponent* camera = CameraComponent::GetActiveCamera();
+		for (Entry& entry : m_systems) {
+			float distance = camera ? glm::length(camera->GetPosition() - entry.system->transform->WorldPosition) : 0.0f;
+			entry.weight = (1.0f + entry.system->m_priority) / (1.0f + distance);
+		}
+		// water-filling: share the budget by weight, systems asking for less than their share
+		// keep what they asked for and the rest is shared again among the others
+		std::vector<Entry*> open;
+		for (Entry& entry : m_systems) open.push_back(&entry);
+		double remaining = (double)m_budget;
+		while (!open.empty()) {
+			double totalWeight = 0.0;
+			for (Entry* entry : open) totalWeight += entry->weight;
+			double share = remaining / totalWeight;
+			size_t before = open.size();
+			for (auto it = open.begin(); it != open.end();) {
+				Entry* entry = *it;
+				if (entry->quota <= entry->weight * share) {
+					remaining -= entry->quota;
+					it = open.erase(it);
+				}
+				else it++;
+			}
+			if (open.size() == before) {
+				for (Entry* entry : open) entry->quota = (int)(entry->weight * share);
+				m_stats.throttled = open.size();
+				break;
+			}
+		}
+	}
+
+	//	Runs work(i) for i in [0, count) in jobs of about ChunkSize cost, the last job on the calling thread.
+	template<typename Cost, typename Work>
+	void ParticleSystemManager::parallel(size_t count, Cost cost, Work work)
+	{
+		std::vector<std::future<void>> jobs;
+		size_t begin = 0;
+		size_t load = 0;
+		for (size_t i = 0; i < count; i++) {
+			load += cost(i);
+			if (load >= ChunkSize && i + 1 < count) {
+				size_t end = i + 1;
+				jobs.push_back(ThreadPool::Enqueue([&work, begin, end]() {
+					for (size_t j = begin; j < end; j++) work(j);
+				}));
+				begin = end;
+				load = 0;
+			}
+		}
+		for (size_t j = begin; j < count; j++) work(j);
+		// get() rethrows what a job threw
+		for (auto& job : jobs) job.get();
+	}
+
+	void ParticleSystemManager::Update()
+	{
+		ParticleSystemManager* s = s_instance;
+		auto start = HighResolutionClock::now();
+		s->distribute();
+
+		// main thread: emitter state changes and buffer growth
+		for (Entry& entry : s->m_systems) {
+			entry.system->beginSimulation(entry.quota);
+		}
+
+		// integrate in chunks, a chunk never spans two systems
+		s->m_ranges.clear();
+		for (Entry& entry : s->m_systems) {
+			size_t count = entry.system->m_pool.GetCount();
+			for (size_t begin = 0; begin < count; begin += ChunkSize) {
+				s->m_ranges.push_back({ entry.system, begin, std::min(begin + ChunkSize, count) });
+			}
+		}
+		s->parallel(s->m_ranges.size(),
+			[s](size_t i) { return s->m_ranges[i].end - s->m_ranges[i].begin; },
+			[s](size_t i) {
+				const Range& range = s->m_ranges[i];
+				ParticleComponent* system = range.system;
+				system->m_pool.Integrate(system->m_simulationDeltaTime, system->m_forces, range.begin, range.end);
+			});
+
+		// kill, emit and write the vertices of whole systems, each system only touches its own pool and random stream
+		std::vector<size_t> spawned(s->m_systems.size());
+		s->parallel(s->m_systems.size(),
+			[s](size_t i) { return s->m_systems[i].system->m_pool.GetCount() + 1; },
+			[s, &spawned](size_t i) { spawned[i] = s->m_systems[i].system->endSimulation(); });
+
+		// depth sorting, parallel inside each sort
+		auto sortStart = HighResolutionClock::now();
+		size_t sorted = 0;
+		for (Entry& entry : s->m_systems) {
+			if (!entry.system->b_depthSort) continue;
+			entry.system->sort();
+			sorted += entry.system->m_pool.GetCount();
+		}
+		s->m_stats.sortTime = milliseconds_type(HighResolutionClock::now() - sortStart).count();
+		s->m_stats.sortedParticles = sorted;
+
+		// main thread: GL upload
+		size_t live = 0;
+		size_t spawns = 0;
+		double deltaTime = 0.0;
+		for (size_t i = 0; i < s->m_systems.size(); i++) {
+			ParticleComponent* system = s->m_systems[i].system;
+			system->Upload();
+			live += system->m_pool.GetCount();
+			spawns += spawned[i];
+			deltaTime = std::max(deltaTime, s->m_systems[i].deltaTime);
+		}
+
+		s->m_stats.systems = s->m_systems.size();
+		s->m_stats.liveParticles = live;
+		s->m_stats.budget = s->m_budget;
+		s->m_stats.spawnsPerSecond = deltaTime > 0.0 ? spawns * 1000.0 / deltaTime : 0.0;
+		s->m_stats.simulationTime = milliseconds_type(HighResolutionClock::now() - start).count();
+		s->m_systems.clear();
+	}
+
+}
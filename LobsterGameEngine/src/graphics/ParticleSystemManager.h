@@ -0,0 +1,67 @@
+#pragma once
+
+namespace Lobster
+{
+
+	class ParticleComponent;
+
+	struct ParticleStats
+	{
+		size_t systems = 0;			// simulated this frame
+		size_t throttled = 0;		// systems given fewer particles than their cutoff
+		size_t liveParticles = 0;
+		size_t budget = 0;
+		double spawnsPerSecond = 0.0;
+		double simulationTime = 0.0;	// ms, sorting included
+		size_t sortedParticles = 0;
+		double sortTime = 0.0;			// ms
+	};
+
+	//	Simulates every animated particle system of the frame together.
+	//	ParticleComponent::OnUpdate only submits itself; Update, called once the scene is updated,
+	//	shares the global particle budget among the submitted systems and runs the simulation on the
+	//	ThreadPool in jobs of about ChunkSize particles: large systems are split, small ones batched.
+	//	When the systems ask for more than the budget, each gets a share weighted by its priority and
+	//	divided by its distance to the active camera, so low priority and distant systems shrink first.
+	//	Systems with depth sorting are then sorted one after another, each sort split on the ThreadPool.
+	//	Only use it from the main thread.
+	class ParticleSystemManager
+	{
+	public:
+		static constexpr size_t ChunkSize = 16384;	// particles per job
+	private:
+		struct Entry
+		{
+			ParticleComponent* system;
+			double deltaTime;	// ms
+			float weight;
+			int quota;			// particles the system may keep alive this frame
+		};
+		struct Range
+		{
+			ParticleComponent* system;
+			size_t begin;
+			size_t end;
+		};
+		static ParticleSystemManager* s_instance;
+		std::vector<Entry> m_systems;	// submitted this frame
+		std::vector<Range> m_ranges;
+		size_t m_budget;
+		ParticleStats m_stats;
+		ParticleSystemManager(size_t budget);
+		void distribute();
+		template<typename Cost, typename Work>
+		void parallel(size_t count, Cost cost, Work work);
+	public:
+		//	budget is the most particles alive over all systems, 0 for no budget.
+		static void Initialize(size_t budget);
+		static void Submit(ParticleComponent* system, double deltaTime);
+		//	Drops a system submitted this frame, e.g. when it is destroyed before Update.
+		static void Remove(ParticleComponent* system);
+		//	Simulates and uploads the submitted systems, then forgets them. Call after the scene update.
+		static void Update();
+		inline static const ParticleStats& GetStats() { return s_instance->m_stats; }
+		inline static void SetBudget(size_t budget) { s_instance->m_budget = budget; }
+	};
+
+}
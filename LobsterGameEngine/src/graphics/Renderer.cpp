@@ -4,7 +4,12 @@
 #include "Material.h"
 #include "Renderer.h"
 #include "Scene.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexLayout.h"
 #include "components/ComponentCollection.h"
+#include "graphics/2D/SpriteBatcher.h"
 #include "graphics/meshes/MeshFactory.h"
 #include "objects/GameObject.h"
 
@@ -25,7 +30,7 @@ namespace Lobster
 			return;
 		}
 		// Create frame buffer for second pass
-        glm::ivec2 size = Application::GetInstance()->GetWindow()->GetSize();
+        glm::ivec2 size = Application::GetInstance()->GetWindowSize();
 		std::vector<RenderTargetDesc> desc(3);
 		desc[0].internalFormat = Formats::RGBA16FFormat;
 		desc[0].format = Formats::RGBAFormat;
@@ -44,7 +49,16 @@ namespace Lobster
 		m_skyboxMesh = MeshFactory::Cube();
 
 		m_spriteShader = ShaderLibrary::Use("shaders/Sprite.glsl");
-		m_spriteMesh = MeshFactory::Sprite();
+		m_spriteBatcher = new SpriteBatcher();
+		m_spriteVertices = new VertexBuffer(DrawMode::DYNAMIC_DRAW);
+		m_spriteIndices = new IndexBuffer();
+		VertexLayout* layout = new VertexLayout();
+		layout->Add<float>("in_position", 2);
+		layout->Add<float>("in_texcoord", 2);
+		layout->Add<float>("in_color", 4);
+		layout->Add<float>("in_blend", 4);
+		layout->Add<int>("in_texture", 1);
+		m_spriteMesh = new VertexArray(layout, { m_spriteVertices }, { m_spriteIndices }, PrimitiveType::TRIANGLES);
 
 		s_instance = this;
     }
@@ -54,9 +68,11 @@ namespace Lobster
 		if (m_postProcessMesh) delete m_postProcessMesh;
 		if (m_skyboxMesh) delete m_skyboxMesh;
 		if (m_spriteMesh) delete m_spriteMesh;
+		if (m_spriteBatcher) delete m_spriteBatcher;
 		m_postProcessMesh = nullptr;
 		m_skyboxMesh = nullptr;
 		m_spriteMesh = nullptr;
+		m_spriteBatcher = nullptr;
     }
 
 	void Renderer::SetDepthTest(bool enabled, DepthFunc func)
@@ -92,10 +108,10 @@ namespace Lobster
 		}
 	}
     
-	void Renderer::DrawQueue(CameraComponent* camera, std::list<RenderCommand>& queue)
+	void Renderer::DrawQueue(CameraComponent* camera, RenderQueue& queue)
 	{
 		Material* boundedMaterial = nullptr;
-		for (std::list<RenderCommand>::iterator it = queue.begin(); it != queue.end(); ++it)
+		for (RenderQueue::iterator it = queue.begin(); it != queue.end(); ++it)
 		{
 			RenderCommand& command = *it;
 			Material* useMaterial = command.UseMaterial;
@@ -120,7 +136,9 @@ namespace Lobster
 			useShader->SetTexture2D(10, m_activeSceneEnvironment.Skybox->GetBRDF());
 			for (int i = 0; i < MAX_DIRECTIONAL_SHADOW; ++i) {
 				useShader->SetTexture2D(11 + i, LightLibrary::GetDirectionalShadowMap(i));
-				useShader->SetUniform(("sys_shadowMap["+std::to_string(i)+"]").c_str(), 11 + i);
+				char shadowMapName[32];
+				snprintf(shadowMapName, sizeof(shadowMapName), "sys_shadowMap[%d]", i);
+				useShader->SetUniform(shadowMapName, 11 + i);
 			}
 			useShader->SetUniform("sys_irradianceMap", 8);
 			useShader->SetUniform("sys_prefilterMap", 9);
@@ -136,7 +154,7 @@ namespace Lobster
 		}
 	}
 
-	void Renderer::DrawDeferredQueue(CameraComponent * camera, std::list<RenderCommand>& queue)
+	void Renderer::DrawDeferredQueue(CameraComponent * camera, RenderQueue& queue)
 	{
 		// Geometry pass
 		m_gBuffer->BindAndClear(ClearFlag::COLOR | ClearFlag::DEPTH);
@@ -146,7 +164,7 @@ namespace Lobster
 		useShader->SetUniform("sys_view", camera->GetViewMatrix());
 		useShader->SetUniform("sys_projection", camera->GetProjectionMatrix());
 		useShader->SetUniform("sys_cameraPosition", camera->GetPosition());
-		for (std::list<RenderCommand>::iterator it = queue.begin(); it != queue.end(); ++it) {
+		for (RenderQueue::iterator it = queue.begin(); it != queue.end(); ++it) {
 			RenderCommand& command = *it;
 			Material* useMaterial = command.UseMaterial;
 			// Vertex shader uniforms
@@ -286,25 +304,8 @@ namespace Lobster
 		m_postProcessMesh->Draw();
 		Renderer::SetDepthTest(true);
 
-		// from front to back order
 		// Overlay
-		m_spriteShader->Bind();
-		for (auto it = m_overlayQueue.rbegin(); it != m_overlayQueue.rend(); ++it)
-		{
-			RenderOverlayCommand& command = *it;
-			glm::mat4 world = glm::mat4(1.0);
-			world = glm::translate(world, glm::vec3(command.x, command.y, command.z));
-			world = glm::scale(world, glm::vec3(command.w, command.h, 1.0f));
-			m_spriteShader->SetTexture2D(0, renderTarget->Get(0));
-			m_spriteShader->SetTexture2D(1, command.UseTexture->Get());
-			m_spriteShader->SetUniform("sys_world", world);
-			m_spriteShader->SetUniform("sys_projection", camera->GetOrthoMatrix());
-			m_spriteShader->SetUniform("alpha", command.alpha);
-			m_spriteShader->SetUniform("sys_background", 0);
-			m_spriteShader->SetUniform("sys_spriteTexture", 1);
-			m_spriteShader->SetUniform("blend", glm::vec4(command.blendR, command.blendG, command.blendB, command.blendA));
-			m_spriteMesh->Draw();
-		}
+		DrawOverlay(camera, renderTarget);
 
 		glm::ivec2 buf_size = renderTarget->GetSize();
 		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
@@ -313,31 +314,74 @@ namespace Lobster
 		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
     }
 
+	void Renderer::DrawOverlay(CameraComponent* camera, FrameBuffer* renderTarget)
+	{
+		m_spriteBatcher->Build(m_overlayQueue);
+		size_t sprites = m_spriteBatcher->GetSpriteCount();
+		if (sprites == 0) return;
+		// the buffers only grow, the quads of the frame are uploaded every frame
+		if (sprites > m_spriteCapacity) {
+			m_spriteCapacity = std::max<size_t>(m_spriteCapacity * 2, std::max<size_t>(sprites, 64));
+			m_spriteVertices->SetData(nullptr, (uint)(m_spriteCapacity * 4 * sizeof(SpriteVertex)));
+			m_spriteIndices->SetData(nullptr, (uint)(m_spriteCapacity * 6));
+		}
+		const std::vector<SpriteVertex>& vertices = m_spriteBatcher->GetVertices();
+		const std::vector<uint>& indices = m_spriteBatcher->GetIndices();
+		m_spriteVertices->SetSubData(vertices.data(), (uint)(vertices.size() * sizeof(SpriteVertex)));
+		m_spriteIndices->SetSubData(indices.data(), (uint)indices.size());
+
+		m_spriteShader->Bind();
+		m_spriteShader->SetTexture2D(0, renderTarget->Get(0));
+		m_spriteShader->SetUniform("sys_projection", camera->GetOrthoMatrix());
+		m_spriteShader->SetUniform("sys_background", 0);
+		// set every frame, a live reload of the shader resets them
+		char textureName[32];
+		for (int i = 0; i < SpriteBatcher::MaxTextures; i++) {
+			snprintf(textureName, sizeof(textureName), "sys_spriteTextures[%d]", i);
+			m_spriteShader->SetUniform(textureName, 1 + i);
+		}
+		const SpriteBatch* batches = m_spriteBatcher->GetBatches();
+		for (size_t i = 0; i < m_spriteBatcher->GetBatchCount(); i++) {
+			const SpriteBatch& batch = batches[i];
+			for (size_t slot = 0; slot < batch.textures.size(); slot++) {
+				m_spriteShader->SetTexture2D(1 + (uint)slot, batch.textures[slot]->Get());
+			}
+			m_spriteMesh->Draw(batch.firstIndex, batch.indexCount);
+		}
+	}
+
 	void Renderer::BeginScene(TextureCube * skybox)
 	{
+		// headless runs have no renderer, the scene is never drawn
+		if (!s_instance) return;
 		// set global environment
 		s_instance->m_activeSceneEnvironment.Skybox = skybox;
 	}
 
 	void Renderer::SetApplySobel(bool apply, float threshold) {
+		if (!s_instance) return;
 		s_instance->b_ppSobel = apply;
 		s_instance->m_ppSobelThreshold = threshold;
 	}
 
 	void Renderer::SetApplyKernel(bool apply, glm::mat3 kernel) {
+		if (!s_instance) return;
 		s_instance->b_ppUseKernel = apply;
 		s_instance->m_ppKernel = kernel;
 	}
 
 	void Renderer::SetBlur(bool blur) {
+		if (!s_instance) return;
 		s_instance->b_ppBlur = blur;
 	}
 
 	void Renderer::SetSSR(bool ssr) {
+		if (!s_instance) return;
 		s_instance->b_ppSSR = ssr;
 	}
 
 	void Renderer::SetBlend(bool blend, glm::vec3 color, float alpha) {
+		if (!s_instance) return;
 		s_instance->b_ppBlend = blend;
 		if (blend)
 			s_instance->m_ppBlendColor = glm::vec4(color, alpha);
@@ -345,6 +389,7 @@ namespace Lobster
 
 	void Renderer::Submit(RenderCommand command)
 	{
+		if (!s_instance) return;
 		Material* material = command.UseMaterial;
 		if (material == nullptr) {
 			throw std::runtime_error("What happened? Why there's a command without material?");
@@ -360,11 +405,19 @@ namespace Lobster
 
 	void Renderer::Submit(RenderOverlayCommand ocommand)
 	{
+		if (!s_instance) return;
 		s_instance->m_overlayQueue.push_back(ocommand);
 	}
 
+	void Renderer::Submit(const RenderOverlayCommand* ocommands, size_t count)
+	{
+		if (!s_instance) return;
+		s_instance->m_overlayQueue.insert(s_instance->m_overlayQueue.end(), ocommands, ocommands + count);
+	}
+
 	void Renderer::SubmitDebug(RenderCommand dcommand)
 	{
+		if (!s_instance) return;
 		s_instance->m_debugQueue.push_back(dcommand);
 	}
 
@@ -374,16 +427,19 @@ namespace Lobster
 	}
 
 	void Renderer::ClearOverlayQueue() {
-		s_instance->m_overlayQueue.clear();
+		if (!s_instance) return;
+		FrameVector<RenderOverlayCommand>().swap(s_instance->m_overlayQueue);
 	}
 
 	void Renderer::ClearAllQueues()
 	{
+		if (!s_instance) return;
 		// remove all previous render commands
-		s_instance->m_opaqueQueue.clear();
-		s_instance->m_transparentQueue.clear();
-		s_instance->m_overlayQueue.clear();
-		s_instance->m_debugQueue.clear();
+		// queues are swapped with fresh ones instead of cleared, so no storage from the frame arena survives into later frames
+		RenderQueue().swap(s_instance->m_opaqueQueue);
+		RenderQueue().swap(s_instance->m_transparentQueue);
+		FrameVector<RenderOverlayCommand>().swap(s_instance->m_overlayQueue);
+		RenderQueue().swap(s_instance->m_debugQueue);
 	}
 
 	void Renderer::OnImGuiRender()
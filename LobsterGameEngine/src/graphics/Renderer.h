@@ -1,13 +1,17 @@
 #pragma once
 #include "graphics/Material.h"
+#include "system/FrameAllocator.h"
 
 namespace Lobster
 {
 
 	class CameraComponent;
     class FrameBuffer;
+	class IndexBuffer;
 	class Scene;
+	class SpriteBatcher;
 	class VertexArray;
+	class VertexBuffer;
 
 	struct RenderCommand
 	{
@@ -17,6 +21,9 @@ namespace Lobster
 		glm::mat4* UseBoneTransforms = nullptr;
 	};
 
+	//	Render commands only live for one frame, so queues allocate from the frame arena.
+	typedef FrameVector<RenderCommand> RenderQueue;
+
 	struct RenderOverlayCommand
 	{
 		enum OverlayType { Image, Text };
@@ -25,8 +32,14 @@ namespace Lobster
 		float x, y, w, h;
 		float alpha;
 		float blendR, blendG, blendB, blendA = 0.f;
-		int z;
-		RenderOverlayCommand() { memset(this, 0, sizeof(RenderOverlayCommand)); }
+		float u0, v0, u1, v1;		// part of the texture to draw, all of it by default
+		float tintR, tintG, tintB;	// multiplies the texture color, e.g. the color of a text drawn from a white glyph atlas
+		int z;						// z-index of the sprite, larger in front (see GameUI::GoFront)
+		RenderOverlayCommand() {
+			memset(this, 0, sizeof(RenderOverlayCommand));
+			u1 = v1 = 1.f;
+			tintR = tintG = tintB = 1.f;
+		}
 	};
 
 	struct SceneEnvironment
@@ -87,9 +100,13 @@ namespace Lobster
 		// skybox resources
 		VertexArray* m_skyboxMesh;
 		Shader* m_skyboxShader;
-		// sprite resources
+		// sprite resources, all the overlay commands of a frame are drawn from one buffer
+		SpriteBatcher* m_spriteBatcher;
+		VertexBuffer* m_spriteVertices;
+		IndexBuffer* m_spriteIndices;
 		VertexArray* m_spriteMesh;
 		Shader* m_spriteShader;
+		size_t m_spriteCapacity = 0;	// quads
 		
 		// pipeline settings
 		bool b_deferredRendering;
@@ -105,10 +122,10 @@ namespace Lobster
 		static Renderer* s_instance;
 		FrameBuffer* m_gBuffer;
 		SceneEnvironment m_activeSceneEnvironment;
-		std::list<RenderCommand> m_opaqueQueue;
-		std::list<RenderCommand> m_transparentQueue;
-		std::list<RenderCommand> m_debugQueue;
-		std::list<RenderOverlayCommand> m_overlayQueue;
+		RenderQueue m_opaqueQueue;
+		RenderQueue m_transparentQueue;
+		RenderQueue m_debugQueue;
+		FrameVector<RenderOverlayCommand> m_overlayQueue;
     public:
         Renderer();
         ~Renderer();
@@ -125,15 +142,19 @@ namespace Lobster
 		static void SetBlend(bool blend, glm::vec3 color, float alpha);
 		static void Submit(RenderCommand command);
 		static void Submit(RenderOverlayCommand ocommand);
+		static void Submit(const RenderOverlayCommand* ocommands, size_t count);
 		static void SubmitDebug(RenderCommand dcommand);
 		static void EndScene();
 		static void ClearOverlayQueue();
 		static void ClearAllQueues();
 		static void OnImGuiRender();		
 		inline static void SetDeferredPipeline(bool status) { s_instance->b_deferredRendering = status; }
+		//	The batches of the last overlay drawn.
+		inline static const SpriteBatcher* GetSpriteBatcher() { return s_instance->m_spriteBatcher; }
 	private:
-		void DrawQueue(CameraComponent* camera, std::list<RenderCommand>& queue);
-		void DrawDeferredQueue(CameraComponent* camera, std::list<RenderCommand>& queue);
+		void DrawOverlay(CameraComponent* camera, FrameBuffer* renderTarget);
+		void DrawQueue(CameraComponent* camera, RenderQueue& queue);
+		void DrawDeferredQueue(CameraComponent* camera, RenderQueue& queue);
         void Render(CameraComponent* camera, bool debug = false);
     };
     
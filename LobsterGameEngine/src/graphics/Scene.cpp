@@ -1,16 +1,21 @@
 #include "pch.h"
 #include "Scene.h"
+#include "graphics/Material.h"
 #include "graphics/meshes/MeshFactory.h"
 #include "graphics/Renderer.h"
 #include "graphics/Skybox.h"
+#include "layer/EditorLayer.h"
 #include "objects/GameObject.h"
+#include "system/MemoryTracker.h"
 
 namespace Lobster
 {
     
     Scene::Scene(const char * scenePath) :
-		m_skybox(nullptr)
+		m_skybox(nullptr),
+		m_file(scenePath ? scenePath : "")
     {
+		MemoryScope scope(MEMORY_SCENE);
 		// hard-coded skybox
 		std::string faces[6] = { 
 			FileSystem::Path("textures/skybox/px.png"),
@@ -31,6 +36,7 @@ namespace Lobster
 
 	Scene::~Scene()
     {
+		FlushPending();
 		for (GameObject* gameObject : m_gameObjects) {
 			if (gameObject)	delete gameObject;
 			gameObject = nullptr;
@@ -74,10 +80,89 @@ namespace Lobster
 			cereal::JSONOutputArchive oarchive(ss);
 			oarchive(*this);
 		}
-		INFO("Scene saved!");
 		return ss;
 	}
 
+	void Scene::Save(const std::string& path) {
+		Timer saveTimer;
+		// another file has none of the records yet
+		if (m_file.GetPath() != path) m_file = SceneFile(path);
+		try {
+			int written = m_file.Write(Snapshot());
+			Profiler::SubmitCounter("Scene Save Records Written", written);
+		}
+		catch (std::exception e) {
+			WARN("Saving Scene to {} failed. Reason: {}", path, e.what());
+			return;
+		}
+		Profiler::SubmitData("Scene Save Time", saveTimer.GetElapsedTime());
+		INFO("Scene saved!");
+	}
+
+	SceneSnapshot Scene::Snapshot() {
+		// materials are files of their own, shared by objects that may not be dirty
+		MaterialLibrary::SaveDirty();
+		SceneSnapshot snapshot;
+		for (GameObject* gameObject : m_gameObjects) {
+			snapshot.Names.push_back(gameObject->GetName());
+			snapshot.Ids.push_back(gameObject->GetId());
+		}
+		snapshot.Records = updateRecords();
+		std::stringstream ss;
+		{
+			cereal::JSONOutputArchive oarchive(ss);
+			m_skybox->Serialize(oarchive);
+		}
+		snapshot.Skybox = std::make_shared<const std::string>(ss.str());
+		return snapshot;
+	}
+
+	std::vector<std::shared_ptr<const std::string>> Scene::updateRecords() {
+		std::vector<std::shared_ptr<const std::string>> records;
+		std::unordered_map<Handle, std::shared_ptr<const std::string>> cache;
+		int serialized = 0;
+		for (GameObject* gameObject : m_gameObjects) {
+			auto it = m_records.find(gameObject->GetId());
+			std::shared_ptr<const std::string> record;
+			if (!gameObject->b_isDirty && it != m_records.end()) {
+				record = it->second;
+			}
+			else {
+				std::stringstream ss;
+				{
+					cereal::JSONOutputArchive oarchive(ss);
+					gameObject->Serialize(oarchive);
+				}
+				record = std::make_shared<const std::string>(ss.str());
+				gameObject->b_isDirty = false;
+				serialized++;
+			}
+			cache[gameObject->GetId()] = record;
+			records.push_back(record);
+		}
+		// drop records of objects that are no longer in the scene
+		m_records.swap(cache);
+		Profiler::SubmitCounter("Scene Records Serialized", serialized);
+		return records;
+	}
+
+	void Scene::loadRecord(GameObject* gameObject, const std::string& name) {
+		std::shared_ptr<const std::string> record = name.empty() ? nullptr : m_file.Read(name);
+		if (!record) {
+			// an empty object, saved again as such
+			gameObject->ensureRegistered();
+			gameObject->MarkDirty();
+			return;
+		}
+		std::stringstream ss(*record);
+		{
+			cereal::JSONInputArchive iarchive(ss);
+			gameObject->Deserialize(iarchive);
+		}
+		// what is on disk is exactly this record, keep it until the object changes
+		if (!gameObject->b_isDirty) m_records[gameObject->GetId()] = record;
+	}
+
 	void Scene::Deserialize(std::stringstream& ss) {
 		//LOG("Deserializing Scene");
 		cereal::JSONInputArchive iarchive(ss);
@@ -92,6 +177,7 @@ namespace Lobster
     Scene* Scene::AddGameObject(GameObject* gameObject)
     {
         m_gameObjects.push_back(gameObject);
+		gameObject->m_scene = this;
         return this;
     }
 
@@ -100,14 +186,62 @@ namespace Lobster
 		auto index = std::find(m_gameObjects.begin(), m_gameObjects.end(), gameObject);
 		if (index != m_gameObjects.end()) {
 			m_gameObjects.erase(index);
+			gameObject->m_scene = nullptr;
+		}
+		return this;
+	}
+
+	Scene* Scene::SpawnGameObject(GameObject* gameObject) {
+		if (gameObject) {
+			gameObject->m_scene = this;
+			m_spawnQueue.push_back(gameObject);
 		}
 		return this;
 	}
 
+	Scene* Scene::DestroyGameObject(GameObject* gameObject) {
+		if (!gameObject || gameObject->b_isPendingDestroy) return this;
+		gameObject->b_isPendingDestroy = true;
+		m_destroyQueue.push_back(gameObject);
+		return this;
+	}
+
+	void Scene::FlushPending() {
+		for (GameObject* gameObject : m_spawnQueue) AddGameObject(gameObject);
+		m_spawnQueue.clear();
+		if (m_destroyQueue.empty()) return;
+		Timer destroyTimer;
+		//	Detach root objects in one pass, keeping the order of the rest
+		m_gameObjects.erase(std::remove_if(m_gameObjects.begin(), m_gameObjects.end(), [](GameObject* obj) {
+			return obj->b_isPendingDestroy;
+		}), m_gameObjects.end());
+		//	Objects whose ancestor is also queued are deleted together with that ancestor
+		std::vector<GameObject*> toDelete;
+		for (GameObject* gameObject : m_destroyQueue) {
+			bool ancestorQueued = false;
+			for (GameObject* p = gameObject->m_parent; p && !ancestorQueued; p = p->m_parent) {
+				ancestorQueued = p->b_isPendingDestroy;
+			}
+			if (ancestorQueued) continue;
+			if (gameObject->m_parent) gameObject->m_parent->RemoveChild(gameObject);
+			toDelete.push_back(gameObject);
+		}
+		m_destroyQueue.clear();
+		for (GameObject* p = EditorLayer::s_selectedGameObject; p; p = p->m_parent) {
+			if (p->b_isPendingDestroy) {
+				EditorLayer::s_selectedGameObject = nullptr;
+				break;
+			}
+		}
+		for (GameObject* gameObject : toDelete) delete gameObject;
+		Profiler::SubmitData("GameObject Destroy Time", destroyTimer.GetElapsedTime());
+	}
+
 	// Only remove the FIRST object with name
 	Scene* Scene::RemoveGameObjectByName(std::string name) {
 		for (int i = 0; i < m_gameObjects.size(); i++) {
 			if (m_gameObjects[i]->GetName() == name) {
+				m_gameObjects[i]->m_scene = nullptr;
 				m_gameObjects.erase(m_gameObjects.begin() + i);
 				break;
 			}
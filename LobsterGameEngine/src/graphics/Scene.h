@@ -1,5 +1,6 @@
 #pragma once
 #include "objects/GameObject.h"
+#include "graphics/SceneFile.h"
 
 namespace Lobster
 {
@@ -20,6 +21,13 @@ namespace Lobster
     private:
 		Skybox* m_skybox;
         std::vector<GameObject*> m_gameObjects;
+		//	Objects queued by SpawnGameObject / DestroyGameObject, added or deleted in FlushPending at the end of the frame.
+		std::vector<GameObject*> m_spawnQueue;
+		std::vector<GameObject*> m_destroyQueue;
+		//	Last saved record of each root object, keyed by id. Reused on save until the object is marked dirty.
+		std::unordered_map<Handle, std::shared_ptr<const std::string>> m_records;
+		//	The scene file this scene was loaded from or last saved to.
+		SceneFile m_file;
 		CameraComponent* m_gameCamera = nullptr; // a reference to game camera for easy access in script
 		std::string m_name;
     public:
@@ -29,15 +37,33 @@ namespace Lobster
         void OnUpdate(double deltaTime);
 		void OnPhysicsUpdate(double deltaTime);
 		void SetGameCamera(CameraComponent* camera);
+		//	Serializes the whole scene into a single stream, e.g. for a replay.
 		std::stringstream Serialize();
+		//	Saves the scene as a scene file at path. Only the root objects marked dirty are serialized again, and only
+		//	the records that changed since the scene was loaded from or saved to path are written.
+		void Save(const std::string& path);
+		//	Captures an immutable copy of the scene data on the main thread, which can then be written from any thread.
+		SceneSnapshot Snapshot();
 		void Deserialize(std::stringstream& ss);
         Scene* AddGameObject(GameObject* gameObject);		
 		Scene* RemoveGameObject(GameObject* gameObject);
 		Scene* RemoveGameObjectByName(std::string name);
+		//	Queues a root game object to be added at the end of the frame, so it is safe to call during updates.
+		Scene* SpawnGameObject(GameObject* gameObject);
+		//	Queues a game object (at any depth) for deletion at the end of the frame, so it is safe to call during updates.
+		//	The object stops resolving by id right away.
+		Scene* DestroyGameObject(GameObject* gameObject);
+		//	Adds queued spawns, then detaches and deletes all queued game objects.
+		//	Removal from the root list is a single pass regardless of count.
+		void FlushPending();
 		bool IsObjectNameDuplicated(std::string name, std::string except = "");
 		inline CameraComponent* GetGameCamera() const { return m_gameCamera; }
 		inline Skybox* GetSkybox() const { return m_skybox; }
 	private:
+		//	Returns the record of every root object, re-serializing only the dirty ones.
+		std::vector<std::shared_ptr<const std::string>> updateRecords();
+		//	Loads a root object from its record in the scene file, and keeps the record until the object changes.
+		void loadRecord(GameObject* gameObject, const std::string& name);
 		friend class cereal::access;
 		template <class Archive>
 		void save(Archive & ar) const
@@ -58,12 +84,27 @@ namespace Lobster
 			// Scene Objects
 			std::vector<std::string> childrenNames;
 			ar(childrenNames);
-			for (auto name : childrenNames) AddGameObject(new GameObject(name.c_str()));
-			for (auto gameObject : m_gameObjects) {
-				gameObject->Deserialize(ar);
+			for (auto name : childrenNames) AddGameObject(new GameObject(name.c_str(), GameObject::Unregistered()));
+			// Scene files list a record per root object, single streams and older scenes store them inline
+			std::vector<std::string> records;
+			if (!Serialization::LoadOptional(ar, "records", records)) {
+				for (auto gameObject : m_gameObjects) {
+					gameObject->Deserialize(ar);
+				}
+				// Skybox
+				m_skybox->Deserialize(ar);
+				return;
 			}
-			// Skybox
-			m_skybox->Deserialize(ar);
+			std::string skybox;
+			ar(cereal::make_nvp("skybox", skybox));
+			for (size_t i = 0; i < m_gameObjects.size(); ++i) {
+				loadRecord(m_gameObjects[i], i < records.size() ? records[i] : "");
+			}
+			std::shared_ptr<const std::string> record = m_file.Read(skybox);
+			if (!record) return;
+			std::stringstream ss(*record);
+			cereal::JSONInputArchive iarchive(ss);
+			m_skybox->Deserialize(iarchive);
 		}
     };
     
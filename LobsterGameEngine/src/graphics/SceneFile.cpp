@@ -0,0 +1,76 @@
+#include "pch.h"
+#include "SceneFile.h"
+
+namespace Lobster
+{
+
+	SceneFile::SceneFile(const std::string& path) :
+		m_path(path)
+	{
+	}
+
+	std::string SceneFile::RecordDirectory(const std::string& path)
+	{
+		return path + ".records";
+	}
+
+	std::string SceneFile::RecordName(Handle id)
+	{
+		return std::to_string(id) + ".json";
+	}
+
+	std::shared_ptr<const std::string> SceneFile::Read(const std::string& name)
+	{
+		std::string path = FileSystem::Join(RecordDirectory(m_path), name);
+		if (!FileSystem::Exist(path)) {
+			WARN("Scene record {} is missing.", path);
+			return nullptr;
+		}
+		auto record = std::make_shared<const std::string>(FileSystem::ReadStringStream(path.c_str()).str());
+		// what is on disk is exactly this record
+		m_written[name] = record;
+		return record;
+	}
+
+	int SceneFile::Write(const SceneSnapshot& snapshot)
+	{
+		std::string directory = RecordDirectory(m_path);
+		fs::create_directories(directory);
+		std::unordered_map<std::string, std::shared_ptr<const std::string>> written;
+		int count = 0;
+		auto write = [&](const std::string& name, const std::shared_ptr<const std::string>& record) {
+			auto it = m_written.find(name);
+			// an object marked dirty may still serialize to the same record
+			if (it == m_written.end() || (it->second != record && *it->second != *record)) {
+				std::stringstream ss(*record);
+				FileSystem::WriteStringStream(FileSystem::Join(directory, name).c_str(), ss);
+				count++;
+			}
+			written[name] = record;
+		};
+		std::vector<std::string> records;
+		for (size_t i = 0; i < snapshot.Records.size(); ++i) {
+			records.push_back(RecordName(snapshot.Ids[i]));
+			write(records.back(), snapshot.Records[i]);
+		}
+		write(SkyboxRecord, snapshot.Skybox);
+
+		// the index goes after the records, so it never lists one that is not written yet
+		std::stringstream ss;
+		{
+			cereal::JSONOutputArchive oarchive(ss);
+			oarchive(snapshot.Names);
+			oarchive(cereal::make_nvp("records", records));
+			oarchive(cereal::make_nvp("skybox", std::string(SkyboxRecord)));
+		}
+		FileSystem::WriteStringStream(m_path.c_str(), ss);
+
+		// and the records of objects that left the scene go after the index
+		for (auto& pair : m_written) {
+			if (written.find(pair.first) == written.end()) fs::remove(FileSystem::Join(directory, pair.first));
+		}
+		m_written.swap(written);
+		return count;
+	}
+
+}
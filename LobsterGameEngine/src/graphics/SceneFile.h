@@ -0,0 +1,39 @@
+#pragma once
+#include "system/HandleTable.h"
+
+namespace Lobster
+{
+
+	//	Immutable copy of everything a scene file contains, so that it can be written out off the main thread.
+	//	Records are shared with the scene's record cache, so taking a snapshot does not copy them.
+	struct SceneSnapshot {
+		std::vector<std::string> Names;
+		std::vector<Handle> Ids;
+		std::vector<std::shared_ptr<const std::string>> Records;
+		std::shared_ptr<const std::string> Skybox;
+	};
+
+	//	A scene on disk: an index file listing the root objects, and the JSON record of each root object and of the
+	//	skybox as a file of its own in the record directory next to it. It remembers the records it read or wrote,
+	//	so writing the next snapshot only writes the records that changed and removes the ones that left the scene.
+	class SceneFile {
+	public:
+		static constexpr const char* SkyboxRecord = "skybox.json";
+	private:
+		std::string m_path;
+		std::unordered_map<std::string, std::shared_ptr<const std::string>> m_written;	// by record name
+	public:
+		SceneFile(const std::string& path = "");
+		inline const std::string& GetPath() const { return m_path; }
+		//	The directory holding the records of the scene file at path.
+		static std::string RecordDirectory(const std::string& path);
+		//	The name of the record of a root object.
+		static std::string RecordName(Handle id);
+		//	Reads a record listed in the index, nullptr if it is missing.
+		std::shared_ptr<const std::string> Read(const std::string& name);
+		//	Writes the records that differ from the ones on disk, then the index. Does not touch the scene, so it can
+		//	run off the main thread, but not on two threads at once. Returns the number of records written.
+		int Write(const SceneSnapshot& snapshot);
+	};
+
+}
@@ -4,24 +4,33 @@
 #include "components/LightComponent.h"
 #include "system/FileSystem.h"
 #include "graphics/Texture.h"
+#include "Application.h"
 
 namespace Lobster
 {
     
 	Shader::Shader(const char* path) :
-		m_id(glCreateProgram()),
-		m_vsId(glCreateShader(GL_VERTEX_SHADER)),
-		m_gsId(glCreateShader(GL_GEOMETRY_SHADER)),
-		m_fsId(glCreateShader(GL_FRAGMENT_SHADER)),
+		m_id(0),
+		m_vsId(0),
+		m_gsId(0),
+		m_fsId(0),
 		m_name(path),
         m_path(FileSystem::Path(path)),
 		b_compileSuccess(false)
     {
+		// headless runs have no OpenGL, the shader then only parses its uniform declarations (for the materials)
+		if (!Application::IsHeadless()) {
+			m_id = glCreateProgram();
+			m_vsId = glCreateShader(GL_VERTEX_SHADER);
+			m_gsId = glCreateShader(GL_GEOMETRY_SHADER);
+			m_fsId = glCreateShader(GL_FRAGMENT_SHADER);
+		}
 		Reload();
     }
     
     Shader::~Shader()
     {
+		if (!m_id) return;
 		glDeleteShader(m_vsId);
 		glDeleteShader(m_gsId);
 		glDeleteShader(m_fsId);
@@ -30,16 +39,21 @@ namespace Lobster
     
     void Shader::Bind() const
     {
-        glUseProgram(m_id);
+        if (m_id) glUseProgram(m_id);
     }
     
     void Shader::Unbind() const
     {
-		glUseProgram(0);
+		if (m_id) glUseProgram(0);
     }
     
     void Shader::Reload()
     {
+		if (!m_id) {
+			b_compileSuccess = true;
+			ParseUniform();
+			return;
+		}
 		b_compileSuccess = Compile();
 		if (!b_compileSuccess) {
 			LOG("Couldn't compile shader {}", m_path);
@@ -233,13 +247,19 @@ uniform sampler2D sys_shadowMap[MAX_DIRECTIONAL_SHADOW];)");
 				}
 			}
 
-			m_uniformLocationMap[uniformName] = glGetUniformLocation(m_id, uniformName.c_str());
+			m_uniformLocationMap[uniformName] = getLocation(uniformName.c_str());
 			m_uniformDeclarations.push_back(UniformDeclaration(uniformName, defaultValStr, uniformType, min, max));
 		}
 	}
 
+	int Shader::getLocation(const char* name) const
+	{
+		return m_id ? glGetUniformLocation(m_id, name) : -1;
+	}
+
 	void Shader::SetBlockBinding(const char * name, int bindingPoint)
 	{
+		if (!m_id) return;
 		uint blockIndex = glGetUniformBlockIndex(m_id, name);
 		if (blockIndex == -1) return;
 		glUniformBlockBinding(m_id, blockIndex, bindingPoint);
@@ -253,6 +273,7 @@ uniform sampler2D sys_shadowMap[MAX_DIRECTIONAL_SHADOW];)");
 	{
 		if (m_uniformLocationMap.find(name) == m_uniformLocationMap.end()) return;
 		int location = m_uniformLocationMap[name];
+		if (location == -1) return;
 		switch (type)
 		{
 		case UniformDeclaration::INT:
@@ -279,56 +300,56 @@ uniform sampler2D sys_shadowMap[MAX_DIRECTIONAL_SHADOW];)");
 
 	void Shader::SetUniform(const char * name, int data)
 	{
-		int location = glGetUniformLocation(m_id, name);
+		int location = getLocation(name);
 		if (location == -1) return;
 		glUniform1i(location, data);
 	}
 
 	void Shader::SetUniform(const char * name, float data)
 	{
-		int location = glGetUniformLocation(m_id, name);
+		int location = getLocation(name);
 		if (location == -1) return;
 		glUniform1f(location, data);
 	}
 
 	void Shader::SetUniform(const char * name, bool data)
 	{
-		int location = glGetUniformLocation(m_id, name);
+		int location = getLocation(name);
 		if (location == -1) return;
 		glUniform1i(location, data);
 	}
 
 	void Shader::SetUniform(const char * name, const glm::ivec2 & data)
 	{
-		int location = glGetUniformLocation(m_id, name);
+		int location = getLocation(name);
 		if (location == -1) return;
 		glUniform2iv(location, 1, glm::value_ptr(data));
 	}
 
 	void Shader::SetUniform(const char * name, const glm::vec2 & data)
 	{
-		int location = glGetUniformLocation(m_id, name);
+		int location = getLocation(name);
 		if (location == -1) return;
 		glUniform2fv(location, 1, glm::value_ptr(data));
 	}
 
 	void Shader::SetUniform(const char* name, const glm::vec3& data)
     {
-        int location = glGetUniformLocation(m_id, name);
+        int location = getLocation(name);
 		if (location == -1) return;
         glUniform3fv(location, 1, glm::value_ptr(data));
     }
 
 	void Shader::SetUniform(const char* name, const glm::vec4& data)
 	{
-		int location = glGetUniformLocation(m_id, name);
+		int location = getLocation(name);
 		if (location == -1) return;
 		glUniform4fv(location, 1, glm::value_ptr(data));
 	}
  
 	void Shader::SetUniform(const char* name, const glm::mat3 &data)
 	{
-		int location = glGetUniformLocation(m_id, name);
+		int location = getLocation(name);
 		if (location == -1) {
 			return;
 		}
@@ -337,20 +358,21 @@ uniform sampler2D sys_shadowMap[MAX_DIRECTIONAL_SHADOW];)");
 
     void Shader::SetUniform(const char* name, const glm::mat4 &data)
     {
-        int location = glGetUniformLocation(m_id, name);
+        int location = getLocation(name);
 		if (location == -1) return;
         glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(data));
     }
 
 	void Shader::SetUniform(const char * name, size_t count, const glm::mat4 * data)
 	{
-		int location = glGetUniformLocation(m_id, name);
+		int location = getLocation(name);
 		if (location == -1) return;
 		glUniformMatrix4fv(location, count, GL_FALSE, glm::value_ptr(*data));
 	}
 
 	void Shader::SetTexture2D(uint slot, void * texture2D)
 	{
+		if (!m_id) return;
 		glUseProgram(m_id);
 		glActiveTexture(GL_TEXTURE0 + slot);
 		glBindTexture(GL_TEXTURE_2D, (intptr_t)texture2D);
@@ -358,6 +380,7 @@ uniform sampler2D sys_shadowMap[MAX_DIRECTIONAL_SHADOW];)");
     
 	void Shader::SetTextureCube(uint slot, void * textureCube)
 	{
+		if (!m_id) return;
 		glUseProgram(m_id);
 		glActiveTexture(GL_TEXTURE0 + slot);
 		glBindTexture(GL_TEXTURE_CUBE_MAP, (intptr_t)textureCube);
@@ -384,11 +407,11 @@ uniform sampler2D sys_shadowMap[MAX_DIRECTIONAL_SHADOW];)");
 			throw std::runtime_error("ShaderLibrary already existed!");
 		}
 		s_instance = new ShaderLibrary();
-		EventDispatcher::AddCallback(EVENT_WINDOW_FOCUSED, new EventCallback<WindowFocusedEvent>([](WindowFocusedEvent* e) {
+		EventChannel<WindowFocusedEvent>::Subscribe([](WindowFocusedEvent* e) {
 			if (e->Focused == true) {
 				ShaderLibrary::LiveReload();
 			}
-		}));
+		});
 	}
 
 	void ShaderLibrary::LiveReload()
@@ -58,6 +58,7 @@ namespace Lobster
         bool Compile();
 		void ParseUniform();
 		void SetBlockBinding(const char* name, int bindingPoint);
+		int getLocation(const char* name) const;	// -1 without OpenGL (headless)
     };
 
 	class ShaderLibrary
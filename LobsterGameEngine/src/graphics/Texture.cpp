@@ -3,6 +3,8 @@
 #include "graphics/Shader.h"
 #include "graphics/VertexArray.h"
 #include "graphics/meshes/MeshFactory.h"
+#include "system/MemoryTracker.h"
+#include "Application.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_RESIZE_IMPLEMENTATION
@@ -18,15 +20,20 @@ namespace Lobster
 	Texture2D::Texture2D(const char* path) :
 		m_id(0), m_name(path)
 	{
-		//	Generate texture
-		glGenTextures(1, &m_id);
-		glBindTexture(GL_TEXTURE_2D, m_id);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		b_loadSuccess = Load();
+		//	Headless runs have no OpenGL, the texture then only reads the size of its image
+		if (Application::IsHeadless()) {
+			b_loadSuccess = stbi_info(FileSystem::Path(m_name).c_str(), &m_width, &m_height, &m_channelCount);
+		}
+		else {
+			//	Generate texture
+			glGenTextures(1, &m_id);
+			glBindTexture(GL_TEXTURE_2D, m_id);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			b_loadSuccess = Load();
+		}
 		if (!b_loadSuccess)
 		{
 			WARN("Couldn't load texture {}", m_name);
@@ -35,6 +42,9 @@ namespace Lobster
 
 	Texture2D::Texture2D(byte* buffer, const char* id, int w, int h) : m_id(0), m_name(id)
 	{
+		m_width = w;
+		m_height = h;
+		if (Application::IsHeadless()) return;
 		//	Generate texture
 		glGenTextures(1, &m_id);
 		glBindTexture(GL_TEXTURE_2D, m_id);
@@ -43,17 +53,42 @@ namespace Lobster
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+		trackGpuMemory(w, h);
 	}
 
 	Texture2D::~Texture2D()
 	{
-		glDeleteTextures(1, &m_id);
+		if (m_id) glDeleteTextures(1, &m_id);
+		MemoryTracker::TrackExternal(MEMORY_TEXTURE, -m_gpuBytes);
 	}
 
 	void Texture2D::SetRaw(byte * data, uint size)
 	{
+		if (!m_id) return;
 		glBindTexture(GL_TEXTURE_2D, m_id);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		trackGpuMemory(m_width, m_height);
+	}
+
+	void Texture2D::SetRaw(byte * data, int w, int h)
+	{
+		m_width = w;
+		m_height = h;
+		SetRaw(data, (uint)(w * h * 4));
+	}
+
+	void Texture2D::SetRows(byte * data, int y, int count)
+	{
+		if (!m_id) return;
+		glBindTexture(GL_TEXTURE_2D, m_id);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, m_width, count, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	}
+
+	void Texture2D::trackGpuMemory(int w, int h)
+	{
+		long long bytes = (long long)w * h * 4;
+		MemoryTracker::TrackExternal(MEMORY_TEXTURE, bytes - m_gpuBytes);
+		m_gpuBytes = bytes;
 	}
 
 	bool Texture2D::Load()
@@ -86,8 +121,11 @@ namespace Lobster
 		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f))
 	};
 
-	TextureCube::TextureCube()
+	TextureCube::TextureCube() :
+		m_id(0), m_irradianceId(0), m_prefilterId(0), m_brdfId(0), m_captureFrameBuffer(0), m_captureRenderBuffer(0)
 	{
+		// headless runs have no OpenGL, the cube map then never loads its faces
+		if (Application::IsHeadless()) return;
 		// Generate and bind texture
 		glGenTextures(1, &m_id);
 		glBindTexture(GL_TEXTURE_CUBE_MAP, m_id);
@@ -104,6 +142,7 @@ namespace Lobster
 
 	TextureCube::~TextureCube()
 	{
+		if (!m_id) return;
 		glDeleteFramebuffers(1, &m_captureFrameBuffer);
 		glDeleteRenderbuffers(1, &m_captureRenderBuffer);
 		glDeleteTextures(1, &m_id);
@@ -118,6 +157,7 @@ namespace Lobster
 			WARN("One of the faces is missing, abort setting cubemap...");
 			return;
 		}
+		if (!m_id) return;
 		std::vector<std::string> faces = { right, left, up, down, back, front };
 		b_loadSuccess = Load(faces);
 		if (!b_loadSuccess) {
@@ -327,6 +367,7 @@ namespace Lobster
 
 	Texture2D* TextureLibrary::Use(const char* path)
 	{
+		MemoryScope scope(MEMORY_TEXTURE);
 		if (s_instance->m_textures.find(path) == s_instance->m_textures.end()) {
 			Texture2D* newTexture = new Texture2D(path);
 			s_instance->m_textures[path] = newTexture;
@@ -336,6 +377,7 @@ namespace Lobster
 	}
 
 	Texture2D* TextureLibrary::Use(const char* id, byte* buffer, int w, int h) {
+		MemoryScope scope(MEMORY_TEXTURE);
 		char name[32];
 		sprintf(name, "textsprite-%s", id);
 		// search for texture with given id
@@ -65,20 +65,28 @@ namespace Lobster
 	class Texture2D : public Texture
 	{
 		friend class TextureLibrary;
+		friend class GlyphAtlas;
 	private:
 		uint m_id;
 		std::string m_name;
+		//	Size of the pixel data uploaded to the GPU, reported to the MemoryTracker.
+		long long m_gpuBytes = 0;
 	public:
 		virtual ~Texture2D() override;
 		void SetRaw(byte* data, uint size);
+		//	Uploads RGBA data of a new size.
+		void SetRaw(byte* data, int w, int h);
+		//	Uploads count rows of RGBA data from row y on, keeping the size. data is the first of these rows.
+		void SetRows(byte* data, int y, int count);
 		inline virtual void* Get() const override { return (void*)(intptr_t)m_id; }
 		inline std::string GetPath() const { return FileSystem::Path(m_name); }
 		inline std::string GetName() const { return FileSystem::PathUnderRes(m_name); }
 	private:
 		explicit Texture2D(const char* path);
-		// This constructor should only be used to create text sprite
+		// This constructor should only be used to create text sprite and glyph atlas
 		explicit Texture2D(byte* buffer, const char* id, int w, int h);
 		bool Load();
+		void trackGpuMemory(int w, int h);
 	};
 
 	class TextureCube : public Texture
@@ -51,7 +51,7 @@ namespace Lobster
 			this->Min = min;
 			this->Max = max;
 		}
-		constexpr size_t Size() {
+		constexpr size_t Size() const {
 			switch (Type)
 			{
 			case BOOL: return 1;
@@ -3,6 +3,7 @@
 #include "VertexBuffer.h"
 #include "VertexLayout.h"
 #include "IndexBuffer.h"
+#include "Application.h"
 
 namespace Lobster
 {
@@ -20,6 +21,9 @@ namespace Lobster
 		m_ids = new uint[m_bufferCount];
 		memset(m_ids, 0, sizeof(uint) * m_bufferCount);
 
+		//  Headless runs have no OpenGL, the arrays then stay at id 0 and only own the buffers
+		if (Application::IsHeadless()) return;
+
 		//  Initialize arrays in GPU
 		glGenVertexArrays(m_bufferCount, m_ids);
 
@@ -39,7 +43,7 @@ namespace Lobster
 	VertexArray::~VertexArray()
 	{
 		//  Release memory in GPU
-		glDeleteVertexArrays(m_bufferCount, m_ids);
+		if (m_bufferCount > 0 && m_ids[0]) glDeleteVertexArrays(m_bufferCount, m_ids);
 
 		//  Release memory in CPU
 		for (auto vb : m_vertexBuffers) if (vb) delete vb;
@@ -61,4 +65,11 @@ namespace Lobster
 		glBindVertexArray(0);
 	}
 
+	void VertexArray::Draw(uint firstIndex, uint count)
+	{
+		glBindVertexArray(m_ids[0]);
+		glDrawElements((GLenum)m_primitive, count, GL_UNSIGNED_INT, (void*)(firstIndex * sizeof(uint)));
+		glBindVertexArray(0);
+	}
+
 }
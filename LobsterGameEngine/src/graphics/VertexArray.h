@@ -28,6 +28,8 @@ namespace Lobster
 		VertexArray(VertexLayout* layout, std::vector<VertexBuffer*> vertexBuffers, std::vector<IndexBuffer*> indexBuffers, PrimitiveType primitive);
 		~VertexArray();
 		void Draw();
+		//	Draws count indices of the first pair from firstIndex, e.g. one batch of a buffer holding several.
+		void Draw(uint firstIndex, uint count);
 	};
 
 }
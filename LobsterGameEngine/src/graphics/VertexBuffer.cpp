@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "VertexBuffer.h"
+#include "Application.h"
 
 namespace Lobster {
     
@@ -7,12 +8,14 @@ namespace Lobster {
         m_id(0),
         m_mode(mode)
     {
+        // headless runs have no OpenGL, the buffer then stays at id 0 and ignores its data
+        if (Application::IsHeadless()) return;
         glGenBuffers(1, &m_id);
     }
     
     VertexBuffer::~VertexBuffer()
     {
-        glDeleteBuffers(1, &m_id);
+        if (m_id) glDeleteBuffers(1, &m_id);
     }
     
     void VertexBuffer::Bind() const
@@ -32,8 +35,16 @@ namespace Lobster {
         //  GL_STATIC_DRAW: the data will most likely not change at all or very rarely.
         //  GL_DYNAMIC_DRAW: the data is likely to change a lot.
         //  GL_STREAM_DRAW: the data will change every time it is drawn.
+		if (!m_id) return;
 		Bind();
         glBufferData(GL_ARRAY_BUFFER, size, data, (GLenum)m_mode);
     }
+
+    void VertexBuffer::SetSubData(const void* data, uint size, uint offset)
+    {
+		if (!m_id) return;
+		Bind();
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
     
 }
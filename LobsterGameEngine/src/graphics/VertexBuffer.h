@@ -22,6 +22,8 @@ namespace Lobster {
         void Bind() const;
         void Unbind() const;
         void SetData(const void* data, uint size);
+        //  Overwrites size bytes from offset, without reallocating. SetData must have allocated enough.
+        void SetSubData(const void* data, uint size, uint offset = 0);
         inline uint GetID() const { return m_id; }
     };
     
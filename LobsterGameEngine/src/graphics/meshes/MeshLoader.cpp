@@ -7,6 +7,7 @@
 #include "graphics/VertexLayout.h"
 #include "graphics/IndexBuffer.h"
 #include "graphics/Texture.h"
+#include "system/MemoryTracker.h"
 
 //  Assimp include
 #include <assimp/Importer.hpp>
@@ -30,6 +31,7 @@ namespace Lobster
 
     MeshInfo MeshLoader::Load(const char* path)
     {
+		MemoryScope scope(MEMORY_MESH);
         Assimp::Importer import;
         const aiScene *scene = import.ReadFile(path,
             aiProcess_Triangulate |
@@ -114,8 +116,25 @@ namespace Lobster
         return meshInfo;
     }
 
+	std::shared_ptr<const MeshInfo> MeshLoader::LoadShared(const char* path)
+	{
+		static std::unordered_map<std::string, std::weak_ptr<const MeshInfo>> cache;
+		std::shared_ptr<const MeshInfo> meshInfo = cache[path].lock();
+		if (!meshInfo) {
+			meshInfo = std::shared_ptr<const MeshInfo>(new MeshInfo(Load(path)), [](const MeshInfo* info) {
+				for (VertexArray* va : info->Meshes) {
+					if (va) delete va;
+				}
+				delete info;
+			});
+			cache[path] = meshInfo;
+		}
+		return meshInfo;
+	}
+
 	std::vector<AnimationInfo> MeshLoader::LoadAnimation(const char * path)
 	{
+		MemoryScope scope(MEMORY_MESH);
 		Assimp::Importer import;
 		const aiScene *scene = import.ReadFile(path,
 			aiProcess_Triangulate |
@@ -14,6 +14,9 @@ namespace Lobster
     {
     public:
         static MeshInfo Load(const char* path);
+		//	Same as Load, but every caller with the same path shares one copy while any of them holds it.
+		//	The vertex arrays are released together with the last reference.
+		static std::shared_ptr<const MeshInfo> LoadShared(const char* path);
         static std::vector<AnimationInfo> LoadAnimation(const char* path);
     };
     
@@ -95,6 +95,7 @@ namespace Lobster
 				if (ImGui::Button("Play")) {
 					// load and add the audio clip
 					AudioClip* ac = AudioSystem::AddAudioClip(FileSystem::Path(pathSelected).c_str());
+					if (!ac) return;
 					audioPlaying = ac;
 					// play and pass callback to clearup
 					ac->Play([&] { 
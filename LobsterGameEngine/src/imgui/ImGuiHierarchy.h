@@ -4,6 +4,7 @@
 #include "layer/EditorLayer.h"
 #include "graphics/Scene.h"
 #include "objects/GameObject.h"
+#include "objects/Prefab.h"
 #include "system/UndoSystem.h"
 #include "physics/Rigidbody.h"
 
@@ -25,6 +26,10 @@ namespace Lobster
 					gameObject->AddChild(child->AddComponent(phys));
 					UndoSystem::GetInstance()->Push(new CreateChildCommand(child, gameObject));
 				}
+				if (ImGui::MenuItem("Save as Prefab...", "", false)) {
+					std::string path = FileSystem::SaveFileDialog(".");
+					if (!path.empty()) Prefab::Create(gameObject, path.c_str());
+				}
 				// TODO: Clone GameObject
 				if (ImGui::MenuItem("Clone", "", false)) {
 					ImGui::CloseCurrentPopup();
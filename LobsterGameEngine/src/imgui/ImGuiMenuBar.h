@@ -9,6 +9,7 @@
 #include "imgui/ImGuiNodeGraphEditor.h"
 #include "graphics/meshes/MeshFactory.h"
 #include "graphics/Skybox.h"
+#include "objects/Prefab.h"
 #include "system/UndoSystem.h"
 
 namespace Lobster
@@ -29,7 +30,7 @@ namespace Lobster
 			m_export(new ImGuiExport()),
 			m_nodeGraphEditor(new ImGuiNodeGraphEditor())
 		{
-			EventDispatcher::AddCallback(EVENT_KEY_PRESSED, new EventCallback<KeyPressedEvent>([this](KeyPressedEvent* e) {
+			EventChannel<KeyPressedEvent>::Subscribe([this](KeyPressedEvent* e) {
 				if (e->Mod & GLFW_MOD_CONTROL) {
 					if (e->Mod & GLFW_MOD_SHIFT) {
 						if (e->Key == GLFW_KEY_S) SaveAs();
@@ -43,7 +44,7 @@ namespace Lobster
 						if (e->Key == GLFW_KEY_Z) UndoSystem::GetInstance()->Undo();
 					}
 				}
-			}));
+			});
 		}
 		~ImGuiMenuBar() { 
 			if (m_about) delete m_about; 
@@ -185,6 +186,14 @@ namespace Lobster
 						}
 						ImGui::EndMenu();
 					}
+					if (ImGui::MenuItem("Instantiate Prefab...", "", false)) {
+						std::string path = FileSystem::OpenFileDialog();
+						if (!path.empty()) {
+							GameObject* instance = PrefabLibrary::Use(path.c_str())->Instantiate();
+							scene->AddGameObject(instance);
+							UndoSystem::GetInstance()->Push(new CreateObjectCommand(instance, scene));
+						}
+					}
 					ImGui::EndMenu();
 				}
 				// ==========================================
@@ -242,12 +251,9 @@ namespace Lobster
 		}
 
 		void New() {
-			// Clear current resource cache
-			MaterialLibrary::Clear();
-			TextureLibrary::Clear();
 			// TODO new a scene in a more proper way
 			Application* app = Application::GetInstance();
-			app->OpenScene("");
+			app->OpenScene("", true);	// also clears the resource caches
 			GameObject* camera = new GameObject("Main Camera");
 			CameraComponent* comp = new CameraComponent();
 			camera->AddComponent(comp);
@@ -261,14 +267,11 @@ namespace Lobster
 		}
 
 		void Open() {
-			// Clear current resource cache
-			MaterialLibrary::Clear();
-			TextureLibrary::Clear();
-			// Open scene
+			// Open scene, the resource caches are only cleared once the current scene is gone
 			Application* app = Application::GetInstance();
 			std::string fullpath = FileSystem::OpenFileDialog();
 			if (!fullpath.empty()) {
-				app->OpenScene(fullpath.c_str());
+				app->OpenScene(fullpath.c_str(), true);
 			}
 		}
 
@@ -279,9 +282,8 @@ namespace Lobster
 				SaveAs(); // save as
 			}
 			else {
-				// save by overwrite
-				std::stringstream ss = GetScene()->Serialize();
-				FileSystem::WriteStringStream(scenePath.c_str(), ss);
+				// save by overwrite, only the records that changed are written
+				GetScene()->Save(scenePath);
 				Application::GetInstance()->SetSaved(true);
 			}
 		}
@@ -290,8 +292,7 @@ namespace Lobster
 			Application* app = Application::GetInstance();
 			std::string fullpath = FileSystem::SaveFileDialog(".");
 			if (!fullpath.empty()) {
-				std::stringstream ss = GetScene()->Serialize();
-				FileSystem::WriteStringStream(fullpath.c_str(), ss);
+				GetScene()->Save(fullpath);
 				app->SetScenePath(fullpath.c_str());
 				app->SetSaved(true);
 			}
@@ -6,7 +6,9 @@
 #include "graphics/Renderer.h"
 #include "graphics/FrameBuffer.h"
 #include "graphics/meshes/MeshFactory.h"
+#include "scripts/ScriptProfiler.h"
 #include "system/Input.h"
+#include "system/MemoryTracker.h"
 #include "system/Profiler.h"
 #include "system/UndoSystem.h"
 #include <ImGuizmo.h>
@@ -79,12 +81,12 @@ namespace Lobster
 			m_gridVertexArray = MeshFactory::Grid(20, 20);
 
 			// listen events
-			EventDispatcher::AddCallback(EVENT_KEY_PRESSED, new EventCallback<KeyPressedEvent>([this](KeyPressedEvent* e) {
+			EventChannel<KeyPressedEvent>::Subscribe([this](KeyPressedEvent* e) {
 				if (e->Key == GLFW_KEY_P)
 				{
 					b_showProfiler = !b_showProfiler;
 				}
-			}));			
+			});			
 		}
 		
 		inline CameraComponent* GetCamera() { return m_editorCamera->GetComponent<CameraComponent>(); }
@@ -286,20 +288,36 @@ namespace Lobster
 			{
 				float margin = 10.f;
 				ImGui::SetNextWindowPos(ImVec2(window_pos.x + margin, window_pos.y + window_size.y - margin), 0, ImVec2(0, 1));
-				ImGui::SetNextWindowSize(ImVec2(280, 120));
+				ImGui::SetNextWindowSizeConstraints(ImVec2(280, 120), ImVec2(FLT_MAX, FLT_MAX));
 				ImGui::SetNextWindowBgAlpha(0.35f); // Transparent background
 				ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0, 0));
 				if (ImGui::Begin("Performance Profiler", p_open,
-					ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoSavedSettings |
+					ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoSavedSettings |
 					ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoDocking))
 				{
 					ImGui::Text("Performance Profiler ([P] Show/Hide)");
 					ImGui::Separator();
 					for (auto it = Profiler::s_instance->m_profilerData.begin(); it != Profiler::s_instance->m_profilerData.end(); ++it)
 					{
-						std::string label = it->first + ": %.1f ms";
-						ImGui::Text(label.c_str(), it->second);
+						ImGui::Text("%s: %.1f ms", it->first.c_str(), it->second);
 					}
+					if (!Profiler::s_instance->m_profilerCounters.empty()) ImGui::Separator();
+					for (auto it = Profiler::s_instance->m_profilerCounters.begin(); it != Profiler::s_instance->m_profilerCounters.end(); ++it)
+					{
+						ImGui::Text("%s: %.0f", it->first.c_str(), it->second);
+					}
+					// Memory per subsystem: live / peak and number of allocations, in red when over budget
+					ImGui::Separator();
+					for (uint i = 0; i < MEMORY_TAG_COUNT; ++i)
+					{
+						MemoryTag tag = (MemoryTag)i;
+						if (MemoryTracker::GetAllocCount(tag) == 0) continue;
+						long long budget = MemoryTracker::GetBudget(tag);
+						bool overBudget = budget > 0 && MemoryTracker::GetLiveBytes(tag) > budget;
+						ImGui::TextColored(overBudget ? ImVec4(1.0, 0.3, 0.3, 1.0) : ImGui::GetStyleColorVec4(ImGuiCol_Text), "%s Memory: %.1f / %.1f MB (%zu allocs)",
+							MemoryTracker::GetTagName(tag), MemoryTracker::GetLiveBytes(tag) / 1048576.0, MemoryTracker::GetPeakBytes(tag) / 1048576.0, MemoryTracker::GetAllocCount(tag));
+					}
+					ShowScriptProfile();
 				}
 				ImGui::End();
 				ImGui::PopStyleVar();
@@ -308,6 +326,33 @@ namespace Lobster
 			m_gizmosQueue.clear(); 
 		}
 
+		//	Most expensive scripts of the last frame and, when sampling, the hottest Lua lines
+		static void ShowScriptProfile() {
+			const size_t maxRows = 8;
+			std::vector<std::pair<double, const std::string*>> scripts;
+			for (const auto& [filename, stats] : ScriptProfiler::s_instance->m_stats) {
+				if (stats.last.TotalTime() > 0.0) scripts.push_back({ stats.last.TotalTime(), &filename });
+			}
+			ImGui::Separator();
+			bool sampling = ScriptProfiler::IsSampling();
+			if (ImGui::Checkbox("Sample Lua", &sampling)) ScriptProfiler::SetSampling(sampling);
+			std::sort(scripts.begin(), scripts.end(), std::greater<>());
+			for (size_t i = 0; i < scripts.size() && i < maxRows; ++i) {
+				const ScriptFrameStats& last = ScriptProfiler::s_instance->m_stats.find(*scripts[i].second)->second.last;
+				bool deferred = last.deferred > 0;
+				ImGui::TextColored(deferred ? ImVec4(1.0, 0.6, 0.2, 1.0) : ImGui::GetStyleColorVec4(ImGuiCol_Text), "%s: %.3f ms (%zu updates, %.1f KB allocated%s)",
+					scripts[i].second->c_str(), scripts[i].first, last.calls[SCRIPT_CALL_UPDATE], last.allocated / 1024.0, deferred ? ", deferred" : "");
+			}
+			if (!sampling) return;
+			std::vector<std::pair<size_t, const std::string*>> samples;
+			for (const auto& [location, count] : ScriptProfiler::s_instance->m_samples) samples.push_back({ count, &location });
+			size_t rows = std::min(samples.size(), maxRows);
+			std::partial_sort(samples.begin(), samples.begin() + rows, samples.end(), std::greater<>());
+			for (size_t i = 0; i < rows; ++i) {
+				ImGui::Text("%zu samples: %s", samples[i].first, samples[i].second->c_str());
+			}
+		}
+
 		static void ShowGridSettings() {
 			// grid settings
 			ImGui::Checkbox("Show Reference Grid", &s_instance->b_showGrid);
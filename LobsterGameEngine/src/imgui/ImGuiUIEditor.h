@@ -2,6 +2,7 @@
 #include "imgui/ImGuiComponent.h"
 #include "imgui/ImGuiAssets.h"
 #include "graphics/2D/GameUI.h"
+#include "objects/GameObject.h"
 
 namespace Lobster {
 
@@ -9,6 +10,7 @@ namespace Lobster {
 	class ImGuiUIEditor : public ImGuiComponent {
 	private:
 		GameUI* ui = nullptr;	// pointer to an attached GameUI, never delete it here	
+		GameObject* owner = nullptr;	// the object the attached GameUI is saved with
 		ImGuiIO& io = ImGui::GetIO();
 		Sprite2D* selectedSprite = nullptr;
 		float pmx, pmy;			// to save the intial position of mouse on the sprite
@@ -18,9 +20,14 @@ namespace Lobster {
 		ImGuiUIEditor() {
 		}
 
-		void SetUI(GameUI* ui) {
-			// TODO save/load??
+		void SetUI(GameUI* ui, GameObject* owner) {
 			this->ui = ui;
+			this->owner = owner;
+		}
+
+		// flags the owner to be saved again
+		void MarkEdited() {
+			if (owner) owner->MarkEdited();
 		}
 
 		void DrawBackgroundGrid() {
@@ -60,6 +67,7 @@ namespace Lobster {
 					for (std::string& name : ImGuiAssets::ListResources(PATH_SPRITES)) {
 						if (ImGui::MenuItem(name.c_str())) {							
 							ui->AddSprite(new ImageSprite2D(name.c_str(), windowSize.x, windowSize.y, x, y));
+							MarkEdited();
 							ImGui::CloseCurrentPopup();
 						}
 					}
@@ -81,6 +89,7 @@ namespace Lobster {
 					}
 					if (ImGui::Button("Confirm")) {
 						ui->AddSprite(new TextSprite2D(textContent.c_str(), fontType.c_str(), 24.0f, windowSize.x, windowSize.y, x, y));
+						MarkEdited();
 						ImGui::CloseCurrentPopup();
 					}
 					ImGui::SameLine();
@@ -125,6 +134,7 @@ namespace Lobster {
 					if (ImGui::Button("Confirm")) {
 						ui->AddSprite(new DynamicTextSprite2D(scriptName.c_str(), varname.c_str(), vtype, fontType.c_str(), 24.0f,
 							windowSize.x, windowSize.y, x, y));
+						MarkEdited();
 						ImGui::CloseCurrentPopup();
 					}
 					ImGui::EndMenu();
@@ -161,7 +171,7 @@ namespace Lobster {
 						char c[64]; 
 						sprintf(c, "sprite-%2d", i); // name each popup with distinct name
 						if (ImGui::BeginPopupContextItem(c)) {
-							sprite->ImGuiMenu(ui, ImVec2(config.defaultWidth, config.defaultHeight));
+							if (sprite->ImGuiMenu(ui, ImVec2(config.defaultWidth, config.defaultHeight))) MarkEdited();
 							ImGui::EndPopup();
 						}
 						i++;
@@ -171,9 +181,14 @@ namespace Lobster {
 						// move sprite to a new position
 						float startPosX = io.MousePos.x - pmx;
 						float startPosY = io.MousePos.y - pmy;
+						float px = selectedSprite->x, py = selectedSprite->y;
 						selectedSprite->x = startPosX / config.defaultWidth;
 						selectedSprite->y = startPosY / config.defaultHeight;
 						selectedSprite->Clip();
+						if (selectedSprite->x != px || selectedSprite->y != py) {
+							selectedSprite->MarkDirty();
+							MarkEdited();
+						}
 					}
 					else if (!ImGui::IsMouseDown(0) && !ImGui::IsMouseDown(1)) {
 						selectedSprite = nullptr;
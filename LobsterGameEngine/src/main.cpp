@@ -1,11 +1,55 @@
 #include "pch.h"
 #include "Application.h"
+#include "system/Replay.h"
 
 //	Entry point of the program.
 //	Please move to Application.cpp to see the main game loop.
-int main()
+//	Options:
+//	  --headless              run without window, rendering and editor (see Config::headless)
+//	  --scene <path>          scene to open in headless mode
+//	  --frames <count>        frames to simulate in headless mode
+//	  --dt <ms>               fixed time step in headless mode
+//	  --record <path>         record the input of every frame
+//	  --replay <path>         replay recorded input
+//	  --memory-report <path>  write memory stats on shutdown
+//	  --seed <number>         seed of the random streams
+//	  --capture <path>        capture game sessions for re-simulation
+//	  --resim <path>          re-simulate a capture (implies --headless)
+//	  --profile <path>        write the profiler data of every frame as CSV
+//	  --audio-null <dir>      stream all audio to WAV files in dir instead of a sound device
+//	  --diff <baseline> <candidate> [threshold]
+//	                          compare two --profile recordings, exits with 1 on regressions
+//	The benchmarks are in the LobsterBenchmarks project (tools/main.cpp).
+int main(int argc, char** argv)
 {
+	if (argc >= 4 && std::string(argv[1]) == "--diff")
+	{
+		double threshold = argc >= 5 ? std::atof(argv[4]) : 0.1;
+		return Lobster::Replay::DiffRecordings(argv[2], argv[3], threshold) == 0 ? 0 : 1;
+	}
     Lobster::Application app;
+	Lobster::Config& config = app.GetConfig();
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--headless") config.headless = true;
+		else if (arg == "--scene" && hasValue) config.headlessScene = argv[++i];
+		else if (arg == "--frames" && hasValue) config.headlessFrames = std::atoi(argv[++i]);
+		else if (arg == "--dt" && hasValue) config.headlessDeltaTime = std::atof(argv[++i]);
+		else if (arg == "--record" && hasValue) config.inputRecordPath = argv[++i];
+		else if (arg == "--replay" && hasValue) config.inputReplayPath = argv[++i];
+		else if (arg == "--memory-report" && hasValue) config.memoryReportPath = argv[++i];
+		else if (arg == "--seed" && hasValue) config.randomSeed = std::strtoull(argv[++i], nullptr, 10);
+		else if (arg == "--capture" && hasValue) config.replayCapturePath = argv[++i];
+		else if (arg == "--resim" && hasValue) {
+			config.replayPath = argv[++i];
+			config.headless = true;
+		}
+		else if (arg == "--profile" && hasValue) config.profileRecordPath = argv[++i];
+		else if (arg == "--audio-null" && hasValue) config.audioNullDevice = argv[++i];
+		else std::cerr << "Unknown option " << arg << std::endl;
+	}
     app.Initialize();
     app.Run();
     app.Shutdown();
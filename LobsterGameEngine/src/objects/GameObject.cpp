@@ -1,19 +1,28 @@
 #include "pch.h"
 #include "GameObject.h"
+#include "Application.h"
 #include "imgui/ImGuiProperties.h"
 #include "system/UndoSystem.h"
 
 namespace Lobster
 {
 
-	std::hash<uintptr_t> GameObject::hashFunc;
+	HandleTable<GameObject> GameObject::s_handles;
+	int GameObject::s_templateDepth = 0;
     
     GameObject::GameObject(const char* name) :
         m_name(name),
 		m_parent(nullptr)
     {
-		m_id = hashFunc((unsigned long long) this);
+		m_id = s_handles.Insert(this);
     }
+
+	GameObject::GameObject(const char* name, Unregistered) :
+		m_id(INVALID_HANDLE),
+		m_name(name),
+		m_parent(nullptr)
+	{
+	}
     
     GameObject::~GameObject()
     {
@@ -27,8 +36,59 @@ namespace Lobster
 			delete child;
 			child = nullptr;
 		}
+		s_handles.Remove(m_id);
     }
 
+	Scene* GameObject::GetScene() const
+	{
+		const GameObject* root = this;
+		while (root->m_parent) root = root->m_parent;
+		return root->m_scene;
+	}
+
+	GameObject* GameObject::Find(Handle id, Scene* scene)
+	{
+		GameObject* gameObject = s_handles.Get(id);
+		if (!gameObject) return nullptr;
+		// children are destroyed together with their ancestor
+		for (GameObject* p = gameObject; p; p = p->m_parent) {
+			if (p->b_isPendingDestroy) return nullptr;
+		}
+		if (scene && gameObject->GetScene() != scene) return nullptr;
+		return gameObject;
+	}
+
+	void GameObject::MarkDirty()
+	{
+		GameObject* root = this;
+		while (root->m_parent) root = root->m_parent;
+		root->b_isDirty = true;
+	}
+
+	void GameObject::MarkEdited()
+	{
+		MarkDirty();
+		Application::GetInstance()->SetSaved(false);
+	}
+
+	void GameObject::registerHandle(Handle requested)
+	{
+		if (m_id != INVALID_HANDLE) return;
+		if (requested != INVALID_HANDLE) {
+			m_id = s_handles.InsertAt(this, requested);
+			if (m_id != INVALID_HANDLE) return;
+			LOG("GameObject {} could not keep its id {}, it is already taken", m_name, requested);
+			MarkDirty();
+		}
+		m_id = s_handles.Insert(this);
+	}
+
+	void GameObject::ensureRegistered()
+	{
+		registerHandle(INVALID_HANDLE);
+		for (GameObject* child : m_children) child->ensureRegistered();
+	}
+
 	void GameObject::ToggleVirtualDelete() {
 		b_isVirtuallyDeleted = !b_isVirtuallyDeleted;
 		
@@ -104,7 +164,8 @@ namespace Lobster
 			ImGui::OpenPopup("Rename Game Object");
 		}
 		ImGui::Separator();
-		ImGui::Text("ID: %X (%ld)", GetId(), GetId());
+		ImGui::Text("ID: %llX (%llu)", GetId(), GetId());
+		if (m_prefab) ImGui::Text("Prefab: %s", m_prefab->GetPath().c_str());
 		//ImGui::Button("Clone"); // TODO implement this
 		//ImGui::SameLine();
 
@@ -130,6 +191,7 @@ namespace Lobster
 				else {
 					m_name = rename;
 					rename[0] = '\0';
+					MarkEdited();
 					nothing = false;
 					ImGui::CloseCurrentPopup();
 				}
@@ -154,7 +216,7 @@ namespace Lobster
 		if (!physics || !physics->IsEnabled()) {
 			if (ImGui::Button("Add Rigidbody")) {
 				physics->SetEnabled(true);
-
+				physics->SetEnabledCallback();
 			}
 		} else {
 			if (ImGui::Button("Add Collider")) {
@@ -162,6 +224,7 @@ namespace Lobster
 				box->SetOwner(this);
 				box->SetOwnerTransform(&transform);
 				physics->AddCollider(box);
+				UndoSystem::GetInstance()->Push(new CreateColliderCommand(box, physics));
 			}
 		}
 
@@ -200,6 +263,7 @@ namespace Lobster
 		catch (std::exception e) {
 			LOG("Deserializing GameObject {} failed. Reason: {}", m_name, e.what());
 		}
+		ensureRegistered();
 	}
 
 	void GameObject::OnEnd() {
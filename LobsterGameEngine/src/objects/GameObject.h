@@ -2,26 +2,37 @@
 
 #include <typeinfo>
 #include "Transform.h"
+#include "Prefab.h"
 #include "components/ComponentCollection.h"
 #include "system/filesystem.h"
+#include "system/HandleTable.h"
+#include "system/SlabAllocator.h"
+#include "utils/Serialization.h"
 
 //#include "graphics/Scene.h"
 #include "physics/PhysicsComponentCollection.h"
 
 namespace Lobster
 {
+	class Scene;
+
 	//	This class is the building block of a scene.
 	//	This acts as a node with a list of components attached, and have a spatial relationship with the world origin.
-    class GameObject
+	//	Game objects are allocated from the slab allocator, and identified by a generational handle that survives save / load.
+    class GameObject : public SlabAllocated
     {
 		friend class Scene;
+		friend class Prefab;
     public:
 		//	The world / model matrix of the game object
         Transform transform;
 
     private:
-		static std::hash<uintptr_t> hashFunc;
-		unsigned long long m_id;
+		//	Maps the id of every live game object to the object itself.
+		static HandleTable<GameObject> s_handles;
+		//	While positive, game objects are (de)serialized as templates (e.g. prefab content): ids are written as 0 and ignored on load.
+		static int s_templateDepth;
+		Handle m_id;
         std::string m_name;
 		GameObject* m_parent;
 		std::vector<GameObject*> m_children;
@@ -43,7 +54,25 @@ namespace Lobster
 
 		//	Indicate whether the object is virtually deleted.
 		bool b_isVirtuallyDeleted = false;
-		
+		//	The prefab this object was instantiated from, if any.
+		Prefab* m_prefab = nullptr;
+		//	The scene this object was added or spawned into. Only set on root objects, see GetScene().
+		Scene* m_scene = nullptr;
+
+		//	Indicate whether the saved record of this object is out of date. Only meaningful on root objects, see MarkDirty().
+		bool b_isDirty = false;
+
+		//	Indicate whether the object is queued for deletion at the end of this frame.
+		bool b_isPendingDestroy = false;
+
+		//	Tag for objects created while loading a scene; they only get an id once their saved one has been read.
+		struct Unregistered {};
+		GameObject(const char* name, Unregistered);
+		//	Takes the requested id if it is free, otherwise a fresh one.
+		void registerHandle(Handle requested);
+		//	Gives an id to this object and all its descendants that have not got one yet (e.g. after a failed load).
+		void ensureRegistered();
+
 		template<typename T, typename ...Args> Component* CreateComponent(Args&&... args);
 
     public:
@@ -66,7 +95,19 @@ namespace Lobster
 		void RemoveChildByName(std::string& name);
 		template<typename T> T* GetComponent();
 		std::pair<glm::vec3, glm::vec3> GetBound();
-		inline unsigned long long GetId() { return m_id; }
+		inline Handle GetId() const { return m_id; }
+		inline bool IsPendingDestroy() const { return b_isPendingDestroy; }
+		inline Prefab* GetPrefab() const { return m_prefab; }
+		//	Flags the record containing this object (i.e. its root object) for re-serialization on the next save.
+		void MarkDirty();
+		//	MarkDirty for editor changes that are not pushed to the UndoSystem, which also flags the scene as unsaved.
+		void MarkEdited();
+		//	The scene of the root object, nullptr if it is in none.
+		Scene* GetScene() const;
+		//	Returns the live game object with the given id, or nullptr if it or one of its ancestors is being destroyed,
+		//	or it is not in scene (when given).
+		static GameObject* Find(Handle id, Scene* scene = nullptr);
+		inline static size_t GetLiveCount() { return s_handles.Size(); }
         inline std::string GetName() const { return m_name; }
 		inline GameObject* GetParent() const { return m_parent; }
 		inline std::vector<GameObject*> GetChildren() const { return m_children; }
@@ -101,6 +142,17 @@ namespace Lobster
 		template <class Archive>
 		void save(Archive & ar) const
 		{
+			ar(cereal::make_nvp("id", s_templateDepth > 0 ? INVALID_HANDLE : m_id));
+			// prefab instances only record their transform and the components that differ from the prefab
+			std::vector<uint> overrideIndices;
+			std::vector<std::string> overrideData;
+			if (m_prefab && m_prefab->GetOverrides(this, overrideIndices, overrideData)) {
+				ar(cereal::make_nvp("prefab", m_prefab->GetPath()));
+				ar(transform);
+				ar(overrideIndices);
+				ar(overrideData);
+				return;
+			}
 			// =============================================
 			// record all children name
 			std::vector<std::string> childrenNames;
@@ -128,10 +180,30 @@ namespace Lobster
 		template <class Archive>
 		void load(Archive & ar)
 		{
+			// restore the saved id, scenes saved before ids were persisted simply get a new one
+			Handle id = INVALID_HANDLE;
+			Serialization::LoadOptional(ar, "id", id);
+			registerHandle(s_templateDepth > 0 ? INVALID_HANDLE : id);
+
+			// prefab instance
+			std::string prefabPath;
+			Serialization::LoadOptional(ar, "prefab", prefabPath);
+			if (!prefabPath.empty()) {
+				Transform instanceTransform;
+				std::vector<uint> overrideIndices;
+				std::vector<std::string> overrideData;
+				ar(instanceTransform);
+				ar(overrideIndices);
+				ar(overrideData);
+				PrefabLibrary::Use(prefabPath.c_str())->Build(this, overrideIndices, overrideData);
+				transform = instanceTransform;
+				return;
+			}
+
 			// recreate all children
 			std::vector<std::string> childrenNames;
 			ar(childrenNames);
-			for (auto name : childrenNames) AddChild(new GameObject(name.c_str()));
+			for (auto name : childrenNames) AddChild(new GameObject(name.c_str(), Unregistered()));
 
 			// recursively deserialize all children
 			for (auto child : m_children) {
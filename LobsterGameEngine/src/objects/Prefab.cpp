@@ -0,0 +1,183 @@
+#include "pch.h"
+#include "Prefab.h"
+#include "objects/GameObject.h"
+
+namespace Lobster
+{
+
+	Prefab::Prefab(const char* path) :
+		m_path(FileSystem::PathUnderRes(path))
+	{
+		std::string fullPath = FileSystem::Path(m_path);
+		if (!FileSystem::Exist(fullPath)) {
+			WARN("Prefab {} does not exist.", m_path);
+			return;
+		}
+		std::stringstream ss = FileSystem::ReadStringStream(fullPath.c_str());
+		try {
+			cereal::JSONInputArchive iarchive(ss);
+			iarchive(*this);
+		}
+		catch (std::exception e) {
+			WARN("Loading prefab {} failed. Reason: {}", m_path, e.what());
+		}
+	}
+
+	GameObject* Prefab::Instantiate(const char* name)
+	{
+		GameObject* gameObject = new GameObject(name ? name : m_name.c_str());
+		Build(gameObject);
+		return gameObject;
+	}
+
+	void Prefab::Build(GameObject* target, const std::vector<uint>& overrideIndices, const std::vector<std::string>& overrideData)
+	{
+		target->m_prefab = this;
+		target->transform = m_transform;
+
+		// children are loaded as templates, so they get fresh ids
+		if (!m_childrenData.empty()) {
+			GameObject::s_templateDepth++;
+			std::stringstream ss(m_childrenData);
+			try {
+				cereal::JSONInputArchive iarchive(ss);
+				std::vector<std::string> childrenNames;
+				iarchive(childrenNames);
+				for (auto& name : childrenNames) target->AddChild(new GameObject(name.c_str(), GameObject::Unregistered()));
+				for (GameObject* child : target->m_children) child->Deserialize(iarchive);
+			}
+			catch (std::exception e) {
+				WARN("Instantiating children of prefab {} failed. Reason: {}", m_path, e.what());
+			}
+			GameObject::s_templateDepth--;
+			target->ensureRegistered();
+		}
+
+		// components, taking the instance record instead of the prefab one where overridden
+		for (size_t i = 0; i < m_componentTypes.size() && i < m_componentData.size(); ++i) {
+			Component* component = CreateComponentFromType(m_componentTypes[i]);
+			if (!component) continue;
+			const std::string* data = &m_componentData[i];
+			for (size_t j = 0; j < overrideIndices.size() && j < overrideData.size(); ++j) {
+				if (overrideIndices[j] == i) data = &overrideData[j];
+			}
+			component->SetOwner(target);
+			component->SetOwnerTransform(&target->transform);
+			std::stringstream ss(*data);
+			try {
+				cereal::JSONInputArchive iarchive(ss);
+				component->Deserialize(iarchive);
+			}
+			catch (std::exception e) {
+				WARN("Instantiating component {} of prefab {} failed. Reason: {}", i, m_path, e.what());
+			}
+			target->AddComponent(component);
+		}
+	}
+
+	bool Prefab::GetOverrides(const GameObject* instance, std::vector<uint>& overrideIndices, std::vector<std::string>& overrideData) const
+	{
+		if (instance->m_components.size() != m_componentTypes.size()) return false;
+		for (size_t i = 0; i < m_componentTypes.size(); ++i) {
+			if (instance->m_components[i]->GetType() != m_componentTypes[i]) return false;
+		}
+		if (serializeChildren(instance) != m_childrenData) return false;
+
+		for (size_t i = 0; i < m_componentTypes.size(); ++i) {
+			std::string data = serializeComponent(instance->m_components[i]);
+			if (i >= m_componentData.size() || data != m_componentData[i]) {
+				overrideIndices.push_back((uint)i);
+				overrideData.push_back(data);
+			}
+		}
+		return true;
+	}
+
+	Prefab* Prefab::Create(GameObject* source, const char* path)
+	{
+		std::stringstream ss;
+		{
+			std::vector<ComponentType> componentTypes;
+			std::vector<std::string> componentData;
+			for (Component* component : source->m_components) {
+				componentTypes.push_back(component->GetType());
+				componentData.push_back(serializeComponent(component));
+			}
+			cereal::JSONOutputArchive oarchive(ss);
+			oarchive(source->GetName(), source->transform, componentTypes, componentData, serializeChildren(source));
+		}
+		FileSystem::WriteStringStream(path, ss);
+
+		// refresh the cached copy in case this prefab was loaded before
+		Prefab* prefab = PrefabLibrary::Use(path);
+		*prefab = Prefab(path);
+		source->m_prefab = prefab;
+		INFO("Prefab {} saved!", prefab->m_path);
+		return prefab;
+	}
+
+	std::string Prefab::serializeComponent(Component* component)
+	{
+		std::stringstream ss;
+		{
+			cereal::JSONOutputArchive oarchive(ss);
+			component->Serialize(oarchive);
+		}
+		return ss.str();
+	}
+
+	std::string Prefab::serializeChildren(const GameObject* gameObject)
+	{
+		if (gameObject->m_children.empty()) return "";
+		std::stringstream ss;
+		GameObject::s_templateDepth++;
+		{
+			cereal::JSONOutputArchive oarchive(ss);
+			std::vector<std::string> childrenNames;
+			for (GameObject* child : gameObject->m_children) childrenNames.push_back(child->GetName());
+			oarchive(childrenNames);
+			for (GameObject* child : gameObject->m_children) child->Serialize(oarchive);
+		}
+		GameObject::s_templateDepth--;
+		return ss.str();
+	}
+
+	// =======================================================
+	// PrefabLibrary
+	// =======================================================
+	PrefabLibrary* PrefabLibrary::s_instance = nullptr;
+
+	void PrefabLibrary::Initialize()
+	{
+		if (s_instance != nullptr)
+		{
+			throw std::runtime_error("PrefabLibrary already existed!");
+		}
+		s_instance = new PrefabLibrary();
+	}
+
+	void PrefabLibrary::Clear()
+	{
+		for (Prefab* prefab : s_instance->m_prefabs)
+		{
+			if (prefab) delete prefab;
+		}
+		s_instance->m_prefabs.clear();
+	}
+
+	Prefab* PrefabLibrary::Use(const char* path)
+	{
+		std::string name = FileSystem::PathUnderRes(path);
+		for (Prefab* prefab : s_instance->m_prefabs)
+		{
+			if (prefab->GetPath() == name)
+			{
+				return prefab;
+			}
+		}
+		Prefab* newPrefab = new Prefab(path);
+		s_instance->m_prefabs.push_back(newPrefab);
+		return newPrefab;
+	}
+
+}
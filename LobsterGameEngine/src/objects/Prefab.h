@@ -0,0 +1,74 @@
+#pragma once
+#include "components/Component.h"
+#include "objects/Transform.h"
+
+namespace Lobster
+{
+
+	class GameObject;
+
+	//	A prefab is a game object (with its components and children) that is serialized once and instantiated many times.
+	//	Heavy resources like meshes, materials and textures are shared by every instance through the resource caches.
+	//	An instance only saves its transform and the components that differ from the prefab (sparse overrides).
+	class Prefab
+	{
+		friend class PrefabLibrary;
+	private:
+		std::string m_path;
+		std::string m_name;
+		Transform m_transform;
+		std::vector<ComponentType> m_componentTypes;
+		//	Serialized record of each component, used both to build instances and to detect overrides.
+		std::vector<std::string> m_componentData;
+		//	Serialized names and records of all children.
+		std::string m_childrenData;
+		Prefab(const char* path);
+	public:
+		//	Creates a new game object from this prefab. The caller is responsible for adding it to a scene.
+		GameObject* Instantiate(const char* name = nullptr);
+		//	Fills an empty game object with the prefab content, using the override records for the given component indices.
+		void Build(GameObject* target, const std::vector<uint>& overrideIndices = {}, const std::vector<std::string>& overrideData = {});
+		//	Collects the components of an instance that differ from the prefab.
+		//	Returns false if the instance no longer matches the prefab layout (components or children changed), in which case it has to be saved in full.
+		bool GetOverrides(const GameObject* instance, std::vector<uint>& overrideIndices, std::vector<std::string>& overrideData) const;
+		inline std::string GetPath() const { return m_path; }
+		inline std::string GetName() const { return m_name; }
+		//	Writes source as a prefab file at path, and returns the loaded prefab.
+		static Prefab* Create(GameObject* source, const char* path);
+	private:
+		static std::string serializeComponent(Component* component);
+		static std::string serializeChildren(const GameObject* gameObject);
+		friend class cereal::access;
+		template <class Archive>
+		void save(Archive & ar) const
+		{
+			ar(m_name);
+			ar(m_transform);
+			ar(m_componentTypes);
+			ar(m_componentData);
+			ar(m_childrenData);
+		}
+		template <class Archive>
+		void load(Archive & ar)
+		{
+			ar(m_name);
+			ar(m_transform);
+			ar(m_componentTypes);
+			ar(m_componentData);
+			ar(m_childrenData);
+		}
+	};
+
+	//	Cache of loaded prefabs, keyed by path under the resource directory.
+	class PrefabLibrary
+	{
+	private:
+		std::vector<Prefab*> m_prefabs;
+		static PrefabLibrary* s_instance;
+	public:
+		static void Initialize();
+		static void Clear();
+		static Prefab* Use(const char* path);
+	};
+
+}
@@ -5,6 +5,9 @@ typedef unsigned int uint;
 typedef unsigned char byte;
 
 //  Standard includes
+#include <algorithm>
+#include <atomic>
+#include <bitset>
 #include <condition_variable>
 #include <fstream>
 #include <functional>
@@ -38,6 +41,7 @@ typedef unsigned char byte;
 #include <cereal/cereal.hpp>
 #include <cereal/archives/binary.hpp>
 #include <cereal/archives/json.hpp>
+#include <cereal/types/bitset.hpp>
 #include <cereal/types/map.hpp>
 #include <cereal/types/unordered_map.hpp>
 #include <cereal/types/vector.hpp>
@@ -70,6 +74,7 @@ extern "C" {
 #include "events/EventCollection.h"
 #include "events/EventDispatcher.h"
 #include "imgui/ImGuiConsole.h"
+#include "scripts/LuaMath.h"
 #include "system/FileSystem.h"
 #include "system/Timer.h"
 #include "system/ThreadPool.h"
@@ -86,7 +91,7 @@ extern "C" {
 #define MAX_POINT_LIGHTS 64
 #define MAX_DIRECTIONAL_SHADOW 2
 #define MAX_POINT_SHADOW 3
-#define MAX_PARTICLES 1024
+#define MAX_PARTICLES 65536
 #define MAX_FILE_BUFFER_SIZE 256
 
 #define PATH_AUDIO "audio"
@@ -140,8 +140,9 @@ namespace Lobster
 		}
 	}
 
-	std::vector<glm::vec3> AABB::GetVertices() const {
-		std::vector<glm::vec3> vertices;
+	FrameVector<glm::vec3> AABB::GetVertices() const {
+		FrameVector<glm::vec3> vertices;
+		vertices.reserve(8);
 
 		for (int i = 0; i < 24; i += 3) {
 			vertices.push_back(glm::vec3(m_vertexData[i], m_vertexData[i + 1], m_vertexData[i + 2]) + transform->WorldPosition);
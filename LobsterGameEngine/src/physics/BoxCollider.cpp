@@ -102,8 +102,9 @@ namespace Lobster {
 #endif
 	}
 
-	std::vector<glm::vec3> BoxCollider::GetVertices() const {
-		std::vector<glm::vec3> vertices;
+	FrameVector<glm::vec3> BoxCollider::GetVertices() const {
+		FrameVector<glm::vec3> vertices;
+		vertices.reserve(8);
 		float epsilon = 0.001f;
 
 		for (int i = 0; i < 24; i += 3) {
@@ -23,7 +23,7 @@ namespace Lobster {
 		virtual void Deserialize(cereal::JSONInputArchive& iarchive) override;
 
 	protected:
-		virtual std::vector<glm::vec3> GetVertices() const override;
+		virtual FrameVector<glm::vec3> GetVertices() const override;
 
 	private:
 		void UpdateRotation();
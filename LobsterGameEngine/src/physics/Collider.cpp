@@ -110,8 +110,8 @@ namespace Lobster {
 			return x && y && z;
 		} else if (c1_Box && c2_AABB || c1_AABB && c2_Box || c1_Box && c2_Box) {
 			//	We would need to compare 6 different axis. For each object, compare vec(B-A), vec(D-A), vec(E-A) with another object.
-			std::vector<glm::vec3> p1 = c1->GetVertices();
-			std::vector<glm::vec3> p2 = c2->GetVertices();
+			FrameVector<glm::vec3> p1 = c1->GetVertices();
+			FrameVector<glm::vec3> p2 = c2->GetVertices();
 
 			return IsEnclosed(p1[0], p1[1], p2) && IsEnclosed(p1[0], p1[3], p2) && IsEnclosed(p1[0], p1[4], p2)
 				&& IsEnclosed(p2[0], p2[1], p1) && IsEnclosed(p2[0], p2[3], p1) && IsEnclosed(p2[0], p2[4], p1);
@@ -119,7 +119,7 @@ namespace Lobster {
 		return false;
 	}
 
-	bool Collider::IsEnclosed(glm::vec3 o1_min, glm::vec3 o1_max, std::vector<glm::vec3> o2) {
+	bool Collider::IsEnclosed(glm::vec3 o1_min, glm::vec3 o1_max, const FrameVector<glm::vec3>& o2) {
 		//	First compute the vector direction.
 		glm::vec3 projection = glm::normalize(o1_max - o1_min);
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "components/Component.h"
 #include "objects/Transform.h"
+#include "system/FrameAllocator.h"
 
 namespace Lobster {
 	class PhysicsComponent;
@@ -9,7 +10,7 @@ namespace Lobster {
 	class VertexArray;
 	class VertexBuffer;
 
-	class Collider {
+	class Collider : public SlabAllocated {
 	public:
 		const static char* ColliderType[];
 
@@ -82,13 +83,13 @@ namespace Lobster {
 
 	protected:
 		inline void SetColliderType(int colliderType) { m_colliderType = colliderType; }
-		virtual std::vector<glm::vec3> GetVertices() const = 0;
+		virtual FrameVector<glm::vec3> GetVertices() const = 0;
 	private:
 		//	Update collider component after collider type update.
 		Collider* UpdateColliderType(int colliderType);
 
 		static bool Intersects(Collider* c1, Collider* c2);
 		//	pass 2 points from each object to check if they collided on the vector projection of o1_max - o1_min.
-		static bool IsEnclosed(glm::vec3 o1_min, glm::vec3 o1_max, std::vector<glm::vec3> o2);
+		static bool IsEnclosed(glm::vec3 o1_min, glm::vec3 o1_max, const FrameVector<glm::vec3>& o2);
 	};
 }
\ No newline at end of file
@@ -129,7 +129,8 @@ namespace Lobster {
 		//	Find the actual colliding position.
 		//	We do this by the method of trial and error -
 		//	We will make 5 guesses, each with a timestep of (1/2)^(i)
-		std::vector<PhysicsComponent*> collidingChecklist = PhysicsSystem::GetInstance()->compsList;
+		const std::vector<PhysicsComponent*>& compsList = PhysicsSystem::GetInstance()->compsList;
+		FrameVector<PhysicsComponent*> collidingChecklist(compsList.begin(), compsList.end());
 
 		//	We keep three extra variables out of the iteration loop -
 		//	timestep will store the total time our object travelled.
@@ -138,8 +139,8 @@ namespace Lobster {
 		double timestep = 0;
 		double dt = time;
 
-		std::vector<PhysicsComponent*> collidedObjects;
-		std::vector<PhysicsComponent*> overlapObjects;
+		FrameVector<PhysicsComponent*> collidedObjects;
+		FrameVector<PhysicsComponent*> overlapObjects;
 		if (!m_simulate) return;
 
 		for (int i = 0; i < 5; i++) {
@@ -358,7 +359,7 @@ namespace Lobster {
 		}
 
 		//	Finally, update list of previously colliding objects.
-		m_prevCollidingList = collidedObjects;
+		m_prevCollidingList.assign(collidedObjects.begin(), collidedObjects.end());
 
 		//	Fix angles. Angle range is (-180, 180).
 		for (int i = 0; i < 3; i++) {
@@ -0,0 +1,543 @@
+#include "pch.h"
+#include "LuaMath.h"
+#include "objects/GameObject.h"
+
+namespace Lobster
+{
+
+	static const char* VEC3 = "Lobster.Vec3";
+	static const char* QUAT = "Lobster.Quat";
+	static const char* MAT4 = "Lobster.Mat4";
+	static const char* VEC3_ARRAY = "Lobster.Vec3Array";
+
+	//	Userdata layout of the math types. ptr points at value, or into engine memory for views.
+	//	Views of a game object have no ptr, they keep its handle and resolve it on every access.
+	template <typename T>
+	struct LuaValue
+	{
+		T* ptr;
+		T value;
+		Handle owner;
+		size_t offset;	// of the viewed field in the game object
+	};
+
+	//	Userdata layout of Vec3Array, the positions follow the header.
+	struct LuaVec3Array
+	{
+		size_t count;
+		size_t padding;
+		glm::vec3* Data() { return reinterpret_cast<glm::vec3*>(this + 1); }
+	};
+
+	template <typename T>
+	static T* pushValue(lua_State* L, const char* type, const T& v)
+	{
+		LuaValue<T>* ud = new (lua_newuserdata(L, sizeof(LuaValue<T>))) LuaValue<T>{ nullptr, v };
+		ud->ptr = &ud->value;
+		luaL_setmetatable(L, type);
+		return ud->ptr;
+	}
+
+	template <typename T>
+	static T* checkValue(lua_State* L, int index, const char* type)
+	{
+		LuaValue<T>* ud = static_cast<LuaValue<T>*>(luaL_checkudata(L, index, type));
+		if (ud->owner == INVALID_HANDLE) return ud->ptr;
+		GameObject* gameObject = GameObject::Find(ud->owner);
+		if (!gameObject) luaL_error(L, "the game object of this view was destroyed");
+		return reinterpret_cast<T*>(reinterpret_cast<char*>(gameObject) + ud->offset);
+	}
+
+	static LuaVec3Array* checkArray(lua_State* L, int index)
+	{
+		return static_cast<LuaVec3Array*>(luaL_checkudata(L, index, VEC3_ARRAY));
+	}
+
+	static glm::vec3& checkElement(lua_State* L, LuaVec3Array* array, int index)
+	{
+		lua_Integer i = luaL_checkinteger(L, index);
+		luaL_argcheck(L, i >= 1 && (size_t)i <= array->count, index, "index out of range");
+		return array->Data()[i - 1];
+	}
+
+	static int returnSelf(lua_State* L)
+	{
+		lua_settop(L, 1);
+		return 1;
+	}
+
+	template <typename T>
+	static void pushView(lua_State* L, const char* type, T* v)
+	{
+		new (lua_newuserdata(L, sizeof(LuaValue<T>))) LuaValue<T>{ v, T() };
+		luaL_setmetatable(L, type);
+	}
+
+	template <typename T>
+	static void pushObjectView(lua_State* L, const char* type, GameObject* gameObject, T* v)
+	{
+		size_t offset = reinterpret_cast<char*>(v) - reinterpret_cast<char*>(gameObject);
+		new (lua_newuserdata(L, sizeof(LuaValue<T>))) LuaValue<T>{ nullptr, T(), gameObject->GetId(), offset };
+		luaL_setmetatable(L, type);
+	}
+
+	void LuaMath::PushVec3(lua_State* L, const glm::vec3& v) { pushValue(L, VEC3, v); }
+	void LuaMath::PushVec3View(lua_State* L, glm::vec3* v) { pushView(L, VEC3, v); }
+	glm::vec3* LuaMath::CheckVec3(lua_State* L, int index) { return checkValue<glm::vec3>(L, index, VEC3); }
+	void LuaMath::PushQuat(lua_State* L, const glm::quat& q) { pushValue(L, QUAT, q); }
+	void LuaMath::PushQuatView(lua_State* L, glm::quat* q) { pushView(L, QUAT, q); }
+	glm::quat* LuaMath::CheckQuat(lua_State* L, int index) { return checkValue<glm::quat>(L, index, QUAT); }
+	void LuaMath::PushMat4(lua_State* L, const glm::mat4& m) { pushValue(L, MAT4, m); }
+	void LuaMath::PushMat4View(lua_State* L, glm::mat4* m) { pushView(L, MAT4, m); }
+	glm::mat4* LuaMath::CheckMat4(lua_State* L, int index) { return checkValue<glm::mat4>(L, index, MAT4); }
+
+	// =======================================================
+	// Vec3
+	// =======================================================
+	static int vec3New(lua_State* L)
+	{
+		LuaMath::PushVec3(L, glm::vec3(luaL_optnumber(L, 1, 0.0), luaL_optnumber(L, 2, 0.0), luaL_optnumber(L, 3, 0.0)));
+		return 1;
+	}
+
+	static int vec3Index(lua_State* L)
+	{
+		glm::vec3* v = LuaMath::CheckVec3(L, 1);
+		size_t length;
+		const char* key = lua_tolstring(L, 2, &length);
+		if (key && length == 1 && key[0] >= 'x' && key[0] <= 'z') {
+			lua_pushnumber(L, (*v)[key[0] - 'x']);
+			return 1;
+		}
+		lua_pushvalue(L, 2);
+		lua_rawget(L, lua_upvalueindex(1));	// methods
+		return 1;
+	}
+
+	static int vec3NewIndex(lua_State* L)
+	{
+		glm::vec3* v = LuaMath::CheckVec3(L, 1);
+		size_t length;
+		const char* key = luaL_checklstring(L, 2, &length);
+		luaL_argcheck(L, length == 1 && key[0] >= 'x' && key[0] <= 'z', 2, "Vec3 only has x, y and z");
+		(*v)[key[0] - 'x'] = (float)luaL_checknumber(L, 3);
+		return 0;
+	}
+
+	static int vec3Add(lua_State* L) { LuaMath::PushVec3(L, *LuaMath::CheckVec3(L, 1) + *LuaMath::CheckVec3(L, 2)); return 1; }
+	static int vec3Sub(lua_State* L) { LuaMath::PushVec3(L, *LuaMath::CheckVec3(L, 1) - *LuaMath::CheckVec3(L, 2)); return 1; }
+	static int vec3Unm(lua_State* L) { LuaMath::PushVec3(L, -*LuaMath::CheckVec3(L, 1)); return 1; }
+	static int vec3Div(lua_State* L) { LuaMath::PushVec3(L, *LuaMath::CheckVec3(L, 1) / (float)luaL_checknumber(L, 2)); return 1; }
+
+	static int vec3Mul(lua_State* L)
+	{
+		if (lua_isnumber(L, 1)) LuaMath::PushVec3(L, (float)lua_tonumber(L, 1) * *LuaMath::CheckVec3(L, 2));
+		else if (lua_isnumber(L, 2)) LuaMath::PushVec3(L, *LuaMath::CheckVec3(L, 1) * (float)lua_tonumber(L, 2));
+		else LuaMath::PushVec3(L, *LuaMath::CheckVec3(L, 1) * *LuaMath::CheckVec3(L, 2));
+		return 1;
+	}
+
+	static int vec3Eq(lua_State* L) { lua_pushboolean(L, *LuaMath::CheckVec3(L, 1) == *LuaMath::CheckVec3(L, 2)); return 1; }
+	static int vec3ToString(lua_State* L) { lua_pushstring(L, glm::to_string(*LuaMath::CheckVec3(L, 1)).c_str()); return 1; }
+
+	static int vec3Set(lua_State* L)
+	{
+		*LuaMath::CheckVec3(L, 1) = glm::vec3(luaL_checknumber(L, 2), luaL_checknumber(L, 3), luaL_checknumber(L, 4));
+		return returnSelf(L);
+	}
+
+	static int vec3Copy(lua_State* L) { *LuaMath::CheckVec3(L, 1) = *LuaMath::CheckVec3(L, 2); return returnSelf(L); }
+	static int vec3AddInPlace(lua_State* L) { *LuaMath::CheckVec3(L, 1) += *LuaMath::CheckVec3(L, 2); return returnSelf(L); }
+	static int vec3SubInPlace(lua_State* L) { *LuaMath::CheckVec3(L, 1) -= *LuaMath::CheckVec3(L, 2); return returnSelf(L); }
+	static int vec3Scale(lua_State* L) { *LuaMath::CheckVec3(L, 1) *= (float)luaL_checknumber(L, 2); return returnSelf(L); }
+
+	static int vec3AddScaled(lua_State* L)
+	{
+		*LuaMath::CheckVec3(L, 1) += *LuaMath::CheckVec3(L, 2) * (float)luaL_checknumber(L, 3);
+		return returnSelf(L);
+	}
+
+	static int vec3Normalize(lua_State* L)
+	{
+		glm::vec3* v = LuaMath::CheckVec3(L, 1);
+		float length = glm::length(*v);
+		if (length > 0.0f) *v /= length;
+		return returnSelf(L);
+	}
+
+	static int vec3Cross(lua_State* L) { glm::vec3* v = LuaMath::CheckVec3(L, 1); *v = glm::cross(*v, *LuaMath::CheckVec3(L, 2)); return returnSelf(L); }
+
+	static int vec3Lerp(lua_State* L)
+	{
+		glm::vec3* v = LuaMath::CheckVec3(L, 1);
+		*v = glm::mix(*v, *LuaMath::CheckVec3(L, 2), (float)luaL_checknumber(L, 3));
+		return returnSelf(L);
+	}
+
+	static int vec3Rotate(lua_State* L) { glm::vec3* v = LuaMath::CheckVec3(L, 1); *v = *LuaMath::CheckQuat(L, 2) * *v; return returnSelf(L); }
+	static int vec3Transform(lua_State* L) { glm::vec3* v = LuaMath::CheckVec3(L, 1); *v = glm::vec3(*LuaMath::CheckMat4(L, 2) * glm::vec4(*v, 1.0f)); return returnSelf(L); }
+	static int vec3Dot(lua_State* L) { lua_pushnumber(L, glm::dot(*LuaMath::CheckVec3(L, 1), *LuaMath::CheckVec3(L, 2))); return 1; }
+	static int vec3Length(lua_State* L) { lua_pushnumber(L, glm::length(*LuaMath::CheckVec3(L, 1))); return 1; }
+	static int vec3Distance(lua_State* L) { lua_pushnumber(L, glm::distance(*LuaMath::CheckVec3(L, 1), *LuaMath::CheckVec3(L, 2))); return 1; }
+	static int vec3Clone(lua_State* L) { LuaMath::PushVec3(L, *LuaMath::CheckVec3(L, 1)); return 1; }
+
+	static int vec3Unpack(lua_State* L)
+	{
+		glm::vec3* v = LuaMath::CheckVec3(L, 1);
+		lua_pushnumber(L, v->x);
+		lua_pushnumber(L, v->y);
+		lua_pushnumber(L, v->z);
+		return 3;
+	}
+
+	static const luaL_Reg vec3Methods[] = {
+		{ "Set", vec3Set }, { "Copy", vec3Copy }, { "Add", vec3AddInPlace }, { "Sub", vec3SubInPlace }, { "Scale", vec3Scale },
+		{ "AddScaled", vec3AddScaled }, { "Normalize", vec3Normalize }, { "Cross", vec3Cross }, { "Lerp", vec3Lerp },
+		{ "Rotate", vec3Rotate }, { "Transform", vec3Transform }, { "Dot", vec3Dot }, { "Length", vec3Length },
+		{ "Distance", vec3Distance }, { "Clone", vec3Clone }, { "Unpack", vec3Unpack }, { nullptr, nullptr }
+	};
+
+	static const luaL_Reg vec3Meta[] = {
+		{ "__newindex", vec3NewIndex }, { "__add", vec3Add }, { "__sub", vec3Sub }, { "__mul", vec3Mul }, { "__div", vec3Div },
+		{ "__unm", vec3Unm }, { "__eq", vec3Eq }, { "__tostring", vec3ToString }, { nullptr, nullptr }
+	};
+
+	// =======================================================
+	// Quat
+	// =======================================================
+	static int quatNew(lua_State* L)
+	{
+		LuaMath::PushQuat(L, glm::quat(luaL_optnumber(L, 1, 1.0), luaL_optnumber(L, 2, 0.0), luaL_optnumber(L, 3, 0.0), luaL_optnumber(L, 4, 0.0)));
+		return 1;
+	}
+
+	static int quatFromEuler(lua_State* L)
+	{
+		LuaMath::PushQuat(L, glm::quat(glm::radians(glm::vec3(luaL_checknumber(L, 1), luaL_checknumber(L, 2), luaL_checknumber(L, 3)))));
+		return 1;
+	}
+
+	static float* quatComponent(glm::quat* q, const char* key, size_t length)
+	{
+		if (!key || length != 1) return nullptr;
+		switch (key[0]) {
+		case 'w': return &q->w;
+		case 'x': return &q->x;
+		case 'y': return &q->y;
+		case 'z': return &q->z;
+		default: return nullptr;
+		}
+	}
+
+	static int quatIndex(lua_State* L)
+	{
+		glm::quat* q = LuaMath::CheckQuat(L, 1);
+		size_t length;
+		const char* key = lua_tolstring(L, 2, &length);
+		if (float* component = quatComponent(q, key, length)) {
+			lua_pushnumber(L, *component);
+			return 1;
+		}
+		lua_pushvalue(L, 2);
+		lua_rawget(L, lua_upvalueindex(1));	// methods
+		return 1;
+	}
+
+	static int quatNewIndex(lua_State* L)
+	{
+		glm::quat* q = LuaMath::CheckQuat(L, 1);
+		size_t length;
+		const char* key = luaL_checklstring(L, 2, &length);
+		float* component = quatComponent(q, key, length);
+		luaL_argcheck(L, component, 2, "Quat only has w, x, y and z");
+		*component = (float)luaL_checknumber(L, 3);
+		return 0;
+	}
+
+	static int quatMul(lua_State* L)
+	{
+		glm::quat* q = LuaMath::CheckQuat(L, 1);
+		if (luaL_testudata(L, 2, VEC3)) LuaMath::PushVec3(L, *q * *LuaMath::CheckVec3(L, 2));
+		else LuaMath::PushQuat(L, *q * *LuaMath::CheckQuat(L, 2));
+		return 1;
+	}
+
+	static int quatEq(lua_State* L) { lua_pushboolean(L, *LuaMath::CheckQuat(L, 1) == *LuaMath::CheckQuat(L, 2)); return 1; }
+	static int quatToString(lua_State* L) { lua_pushstring(L, glm::to_string(*LuaMath::CheckQuat(L, 1)).c_str()); return 1; }
+
+	static int quatSet(lua_State* L)
+	{
+		*LuaMath::CheckQuat(L, 1) = glm::quat(luaL_checknumber(L, 2), luaL_checknumber(L, 3), luaL_checknumber(L, 4), luaL_checknumber(L, 5));
+		return returnSelf(L);
+	}
+
+	static int quatSetEuler(lua_State* L)
+	{
+		*LuaMath::CheckQuat(L, 1) = glm::quat(glm::radians(glm::vec3(luaL_checknumber(L, 2), luaL_checknumber(L, 3), luaL_checknumber(L, 4))));
+		return returnSelf(L);
+	}
+
+	static int quatSetAngleAxis(lua_State* L)
+	{
+		*LuaMath::CheckQuat(L, 1) = glm::angleAxis(glm::radians((float)luaL_checknumber(L, 2)), glm::normalize(*LuaMath::CheckVec3(L, 3)));
+		return returnSelf(L);
+	}
+
+	static int quatCopy(lua_State* L) { *LuaMath::CheckQuat(L, 1) = *LuaMath::CheckQuat(L, 2); return returnSelf(L); }
+	static int quatMulInPlace(lua_State* L) { *LuaMath::CheckQuat(L, 1) *= *LuaMath::CheckQuat(L, 2); return returnSelf(L); }
+	static int quatNormalize(lua_State* L) { glm::quat* q = LuaMath::CheckQuat(L, 1); *q = glm::normalize(*q); return returnSelf(L); }
+	static int quatInverse(lua_State* L) { glm::quat* q = LuaMath::CheckQuat(L, 1); *q = glm::inverse(*q); return returnSelf(L); }
+
+	static int quatSlerp(lua_State* L)
+	{
+		glm::quat* q = LuaMath::CheckQuat(L, 1);
+		*q = glm::slerp(*q, *LuaMath::CheckQuat(L, 2), (float)luaL_checknumber(L, 3));
+		return returnSelf(L);
+	}
+
+	//	q:Rotate(v) rotates v in place and returns v
+	static int quatRotate(lua_State* L)
+	{
+		glm::vec3* v = LuaMath::CheckVec3(L, 2);
+		*v = *LuaMath::CheckQuat(L, 1) * *v;
+		lua_settop(L, 2);
+		return 1;
+	}
+
+	static int quatClone(lua_State* L) { LuaMath::PushQuat(L, *LuaMath::CheckQuat(L, 1)); return 1; }
+
+	static const luaL_Reg quatMethods[] = {
+		{ "Set", quatSet }, { "SetEuler", quatSetEuler }, { "SetAngleAxis", quatSetAngleAxis }, { "Copy", quatCopy },
+		{ "Mul", quatMulInPlace }, { "Normalize", quatNormalize }, { "Inverse", quatInverse }, { "Slerp", quatSlerp },
+		{ "Rotate", quatRotate }, { "Clone", quatClone }, { nullptr, nullptr }
+	};
+
+	static const luaL_Reg quatMeta[] = {
+		{ "__newindex", quatNewIndex }, { "__mul", quatMul }, { "__eq", quatEq }, { "__tostring", quatToString }, { nullptr, nullptr }
+	};
+
+	// =======================================================
+	// Mat4
+	// =======================================================
+	static int mat4New(lua_State* L)
+	{
+		LuaMath::PushMat4(L, glm::mat4(1.0f));
+		return 1;
+	}
+
+	static int mat4Mul(lua_State* L)
+	{
+		glm::mat4* m = LuaMath::CheckMat4(L, 1);
+		if (luaL_testudata(L, 2, VEC3)) LuaMath::PushVec3(L, glm::vec3(*m * glm::vec4(*LuaMath::CheckVec3(L, 2), 1.0f)));
+		else LuaMath::PushMat4(L, *m * *LuaMath::CheckMat4(L, 2));
+		return 1;
+	}
+
+	static int mat4ToString(lua_State* L) { lua_pushstring(L, glm::to_string(*LuaMath::CheckMat4(L, 1)).c_str()); return 1; }
+	static int mat4Identity(lua_State* L) { *LuaMath::CheckMat4(L, 1) = glm::mat4(1.0f); return returnSelf(L); }
+	static int mat4Copy(lua_State* L) { *LuaMath::CheckMat4(L, 1) = *LuaMath::CheckMat4(L, 2); return returnSelf(L); }
+	static int mat4MulInPlace(lua_State* L) { *LuaMath::CheckMat4(L, 1) *= *LuaMath::CheckMat4(L, 2); return returnSelf(L); }
+	static int mat4Inverse(lua_State* L) { glm::mat4* m = LuaMath::CheckMat4(L, 1); *m = glm::inverse(*m); return returnSelf(L); }
+
+	static int mat4FromTransform(lua_State* L)
+	{
+		Transform* transform = luabridge::Stack<Transform*>::get(L, 2);
+		luaL_argcheck(L, transform, 2, "Transform expected");
+		*LuaMath::CheckMat4(L, 1) = transform->GetMatrix();
+		return returnSelf(L);
+	}
+
+	//	m:TransformPoint(v) and m:TransformDirection(v) transform v in place and return v
+	static int mat4TransformPoint(lua_State* L)
+	{
+		glm::vec3* v = LuaMath::CheckVec3(L, 2);
+		*v = glm::vec3(*LuaMath::CheckMat4(L, 1) * glm::vec4(*v, 1.0f));
+		lua_settop(L, 2);
+		return 1;
+	}
+
+	static int mat4TransformDirection(lua_State* L)
+	{
+		glm::vec3* v = LuaMath::CheckVec3(L, 2);
+		*v = glm::mat3(*LuaMath::CheckMat4(L, 1)) * *v;
+		lua_settop(L, 2);
+		return 1;
+	}
+
+	static int mat4Get(lua_State* L)
+	{
+		glm::mat4* m = LuaMath::CheckMat4(L, 1);
+		lua_Integer column = luaL_checkinteger(L, 2), row = luaL_checkinteger(L, 3);
+		luaL_argcheck(L, column >= 1 && column <= 4, 2, "column out of range");
+		luaL_argcheck(L, row >= 1 && row <= 4, 3, "row out of range");
+		lua_pushnumber(L, (*m)[column - 1][row - 1]);
+		return 1;
+	}
+
+	static int mat4Clone(lua_State* L) { LuaMath::PushMat4(L, *LuaMath::CheckMat4(L, 1)); return 1; }
+
+	static const luaL_Reg mat4Methods[] = {
+		{ "Identity", mat4Identity }, { "Copy", mat4Copy }, { "Mul", mat4MulInPlace }, { "Inverse", mat4Inverse },
+		{ "FromTransform", mat4FromTransform }, { "TransformPoint", mat4TransformPoint }, { "TransformDirection", mat4TransformDirection },
+		{ "Get", mat4Get }, { "Clone", mat4Clone }, { nullptr, nullptr }
+	};
+
+	static const luaL_Reg mat4Meta[] = {
+		{ "__mul", mat4Mul }, { "__tostring", mat4ToString }, { nullptr, nullptr }
+	};
+
+	// =======================================================
+	// Vec3Array
+	// =======================================================
+	static int arrayNew(lua_State* L)
+	{
+		lua_Integer count = luaL_checkinteger(L, 1);
+		luaL_argcheck(L, count >= 0, 1, "size must not be negative");
+		LuaVec3Array* array = static_cast<LuaVec3Array*>(lua_newuserdata(L, sizeof(LuaVec3Array) + count * sizeof(glm::vec3)));
+		array->count = (size_t)count;
+		std::fill(array->Data(), array->Data() + count, glm::vec3(0.0f));
+		luaL_setmetatable(L, VEC3_ARRAY);
+		return 1;
+	}
+
+	static int arrayLength(lua_State* L) { lua_pushinteger(L, (lua_Integer)checkArray(L, 1)->count); return 1; }
+
+	//	a:Get(i) returns a new Vec3, a:Get(i, out) writes into out instead
+	static int arrayGet(lua_State* L)
+	{
+		const glm::vec3& element = checkElement(L, checkArray(L, 1), 2);
+		if (lua_isnoneornil(L, 3)) {
+			LuaMath::PushVec3(L, element);
+			return 1;
+		}
+		*LuaMath::CheckVec3(L, 3) = element;
+		lua_settop(L, 3);
+		return 1;
+	}
+
+	//	a:Set(i, v) or a:Set(i, x, y, z)
+	static int arraySet(lua_State* L)
+	{
+		glm::vec3& element = checkElement(L, checkArray(L, 1), 2);
+		if (lua_isnumber(L, 3)) element = glm::vec3(luaL_checknumber(L, 3), luaL_checknumber(L, 4), luaL_checknumber(L, 5));
+		else element = *LuaMath::CheckVec3(L, 3);
+		return returnSelf(L);
+	}
+
+	static int arrayFill(lua_State* L)
+	{
+		LuaVec3Array* array = checkArray(L, 1);
+		std::fill(array->Data(), array->Data() + array->count, *LuaMath::CheckVec3(L, 2));
+		return returnSelf(L);
+	}
+
+	static int arrayCopy(lua_State* L)
+	{
+		LuaVec3Array* array = checkArray(L, 1);
+		LuaVec3Array* source = checkArray(L, 2);
+		std::copy(source->Data(), source->Data() + std::min(array->count, source->count), array->Data());
+		return returnSelf(L);
+	}
+
+	static int arrayTranslate(lua_State* L)
+	{
+		LuaVec3Array* array = checkArray(L, 1);
+		glm::vec3 offset = *LuaMath::CheckVec3(L, 2);
+		for (glm::vec3* p = array->Data(), *end = p + array->count; p != end; ++p) *p += offset;
+		return returnSelf(L);
+	}
+
+	static int arrayScale(lua_State* L)
+	{
+		LuaVec3Array* array = checkArray(L, 1);
+		float scale = (float)luaL_checknumber(L, 2);
+		for (glm::vec3* p = array->Data(), *end = p + array->count; p != end; ++p) *p *= scale;
+		return returnSelf(L);
+	}
+
+	static int arrayRotate(lua_State* L)
+	{
+		LuaVec3Array* array = checkArray(L, 1);
+		glm::mat3 rotation = glm::mat3_cast(*LuaMath::CheckQuat(L, 2));
+		for (glm::vec3* p = array->Data(), *end = p + array->count; p != end; ++p) *p = rotation * *p;
+		return returnSelf(L);
+	}
+
+	//	a:Transform(m) transforms every element as a point
+	static int arrayTransform(lua_State* L)
+	{
+		LuaVec3Array* array = checkArray(L, 1);
+		glm::mat4 m = *LuaMath::CheckMat4(L, 2);
+		glm::mat3 basis(m);
+		glm::vec3 translation(m[3]);
+		for (glm::vec3* p = array->Data(), *end = p + array->count; p != end; ++p) *p = basis * *p + translation;
+		return returnSelf(L);
+	}
+
+	static const luaL_Reg arrayMethods[] = {
+		{ "Size", arrayLength }, { "Get", arrayGet }, { "Set", arraySet }, { "Fill", arrayFill }, { "Copy", arrayCopy },
+		{ "Translate", arrayTranslate }, { "Scale", arrayScale }, { "Rotate", arrayRotate }, { "Transform", arrayTransform },
+		{ nullptr, nullptr }
+	};
+
+	static const luaL_Reg arrayMeta[] = {
+		{ "__len", arrayLength }, { nullptr, nullptr }
+	};
+
+	// =======================================================
+	// Views into the transform of a game object, Lobster.PositionView(this)
+	// transform.WorldPosition is a view too, but a new one on every access; these can be kept across frames,
+	// and raise an error once the object is destroyed
+	// =======================================================
+	static GameObject* checkViewed(lua_State* L)
+	{
+		GameObject* gameObject = luabridge::Stack<GameObject*>::get(L, 1);
+		luaL_argcheck(L, gameObject && gameObject->GetId() != INVALID_HANDLE, 1, "GameObject expected");
+		return gameObject;
+	}
+
+	static int positionView(lua_State* L)
+	{
+		GameObject* gameObject = checkViewed(L);
+		pushObjectView(L, VEC3, gameObject, &gameObject->transform.WorldPosition);
+		return 1;
+	}
+
+	static int scaleView(lua_State* L)
+	{
+		GameObject* gameObject = checkViewed(L);
+		pushObjectView(L, VEC3, gameObject, &gameObject->transform.LocalScale);
+		return 1;
+	}
+
+	//	Creates the metatable of a type. __index is the methods table, or a handler for field access with the methods as upvalue.
+	static void registerType(lua_State* L, const char* type, const luaL_Reg* methods, const luaL_Reg* meta, lua_CFunction index)
+	{
+		luaL_newmetatable(L, type);
+		luaL_setfuncs(L, meta, 0);
+		lua_newtable(L);
+		luaL_setfuncs(L, methods, 0);
+		if (index) lua_pushcclosure(L, index, 1);
+		lua_setfield(L, -2, "__index");
+		lua_pop(L, 1);
+	}
+
+	void LuaMath::Register(lua_State* L)
+	{
+		registerType(L, VEC3, vec3Methods, vec3Meta, vec3Index);
+		registerType(L, QUAT, quatMethods, quatMeta, quatIndex);
+		registerType(L, MAT4, mat4Methods, mat4Meta, nullptr);
+		registerType(L, VEC3_ARRAY, arrayMethods, arrayMeta, nullptr);
+		luabridge::getGlobalNamespace(L)
+			.beginNamespace("Lobster")
+			.addCFunction("Vec3", vec3New)
+			.addCFunction("Quat", quatNew)
+			.addCFunction("QuatFromEuler", quatFromEuler)
+			.addCFunction("Mat4", mat4New)
+			.addCFunction("Vec3Array", arrayNew)
+			.addCFunction("PositionView", positionView)
+			.addCFunction("ScaleView", scaleView)
+			.endNamespace();
+	}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+namespace Lobster
+{
+
+	//	Lua value types for glm math: Lobster.Vec3, Lobster.Quat, Lobster.Mat4 and Lobster.Vec3Array.
+	//	A value either owns its data or is a view into engine memory (see Lobster.PositionView), read and written in place.
+	//	In-place methods (Set, Add, Scale, Normalize, Rotate, ...) never allocate; only constructors, Clone and the
+	//	arithmetic operators create new userdata. Vec3Array transforms whole arrays of positions in one call.
+	//	The luabridge::Stack specializations below make every bound engine function take and return these types.
+	//	Like LuaBridge does for classes, values are copied and non-const references (e.g. properties) become views.
+	class LuaMath
+	{
+	public:
+		static void Register(lua_State* L);
+		static void PushVec3(lua_State* L, const glm::vec3& v);
+		static void PushVec3View(lua_State* L, glm::vec3* v);
+		static glm::vec3* CheckVec3(lua_State* L, int index);
+		static void PushQuat(lua_State* L, const glm::quat& q);
+		static void PushQuatView(lua_State* L, glm::quat* q);
+		static glm::quat* CheckQuat(lua_State* L, int index);
+		static void PushMat4(lua_State* L, const glm::mat4& m);
+		static void PushMat4View(lua_State* L, glm::mat4* m);
+		static glm::mat4* CheckMat4(lua_State* L, int index);
+	};
+
+}
+
+namespace luabridge
+{
+
+	template <>
+	struct Stack<glm::vec3>
+	{
+		static void push(lua_State* L, const glm::vec3& v) { Lobster::LuaMath::PushVec3(L, v); }
+		static glm::vec3 get(lua_State* L, int index) { return *Lobster::LuaMath::CheckVec3(L, index); }
+	};
+
+	template <>
+	struct Stack<glm::vec3&>
+	{
+		static void push(lua_State* L, glm::vec3& v) { Lobster::LuaMath::PushVec3View(L, &v); }
+		static glm::vec3& get(lua_State* L, int index) { return *Lobster::LuaMath::CheckVec3(L, index); }
+	};
+
+	template <>
+	struct Stack<glm::quat>
+	{
+		static void push(lua_State* L, const glm::quat& q) { Lobster::LuaMath::PushQuat(L, q); }
+		static glm::quat get(lua_State* L, int index) { return *Lobster::LuaMath::CheckQuat(L, index); }
+	};
+
+	template <>
+	struct Stack<glm::quat&>
+	{
+		static void push(lua_State* L, glm::quat& q) { Lobster::LuaMath::PushQuatView(L, &q); }
+		static glm::quat& get(lua_State* L, int index) { return *Lobster::LuaMath::CheckQuat(L, index); }
+	};
+
+	template <>
+	struct Stack<glm::mat4>
+	{
+		static void push(lua_State* L, const glm::mat4& m) { Lobster::LuaMath::PushMat4(L, m); }
+		static glm::mat4 get(lua_State* L, int index) { return *Lobster::LuaMath::CheckMat4(L, index); }
+	};
+
+	template <>
+	struct Stack<glm::mat4&>
+	{
+		static void push(lua_State* L, glm::mat4& m) { Lobster::LuaMath::PushMat4View(L, &m); }
+		static glm::mat4& get(lua_State* L, int index) { return *Lobster::LuaMath::CheckMat4(L, index); }
+	};
+
+}
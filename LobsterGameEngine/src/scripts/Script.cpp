@@ -2,38 +2,88 @@
 #include "Script.h"
 #include "graphics/Scene.h"
 #include "system/Input.h"
+#include "system/MemoryTracker.h"
+#include "system/UndoSystem.h"
+#include "scripts/LuaMath.h"
+#include "scripts/ScriptProfiler.h"
+#include "scripts/ScriptScheduler.h"
+#include "scripts/ScriptVM.h"
 #include <LuaBridge/Vector.h>
 
 using namespace luabridge;
 
 namespace Lobster {
 
+	size_t Script::s_updateCalls = 0;
+	uint Script::s_staggerIndex = 0;
+
 	Script::Script() : Component(SCRIPT_COMPONENT) {
-		L = luaL_newstate();
-		luaL_openlibs(L);		
+		m_env = ScriptVM::NewEnvironment();
 	}
 
 	Script::Script(const char* file) : Component(SCRIPT_COMPONENT) {
-		L = luaL_newstate();
-		luaL_openlibs(L);
+		m_env = ScriptVM::NewEnvironment();
 		loadScript(file);
 	}
 
 	Script::~Script() {
-		lua_close(L);
-		L = nullptr;
+		ScriptScheduler::Cancel(this);
+		releaseCallbacks();
+		ScriptVM::ReleaseEnvironment(m_env);
+		m_env = LUA_NOREF;
 	}
 
 	void Script::loadScript(const char* file) {
+		MemoryScope scope(MEMORY_SCRIPT);
+		Timer loadTimer;
+		size_t memoryBefore = ScriptVM::GetMemoryUsage();
 		filename = file;
 		errmsg.clear();
-		int r = luaL_dofile(L, FileSystem::Path(FileSystem::Join(PATH_SCRIPTS, filename)).c_str());
-		if (r != LUA_OK) {
-			WARN(lua_tostring(L, -1));
-			errmsg += lua_tostring(L, -1);
+		m_stats = ScriptProfiler::Use(filename);
+		// start over from a clean environment, so nothing is left from a previously loaded script
+		ScriptScheduler::Cancel(this);
+		releaseCallbacks();
+		ScriptVM::ReleaseEnvironment(m_env);
+		m_env = ScriptVM::NewEnvironment();
+		Bind();
+		std::string error = ScriptVM::Run(m_env, FileSystem::Path(FileSystem::Join(PATH_SCRIPTS, filename)).c_str());
+		if (!error.empty()) {
+			WARN(error);
+			errmsg += error;
 			errmsg += "\n";
 		}
-		Bind();
+		resolveCallbacks();
+		m_loadTime = loadTimer.GetElapsedTime();
+		size_t memoryAfter = ScriptVM::GetMemoryUsage();
+		m_memoryFootprint = memoryAfter > memoryBefore ? memoryAfter - memoryBefore : 0;
+	}
+
+	void Script::resolveCallbacks() {
+		releaseCallbacks();
+		m_onBegin = ScriptVM::ResolveFunction(m_env, "OnBegin");
+		m_onUpdate = ScriptVM::ResolveFunction(m_env, "OnUpdate");
+	}
+
+	void Script::releaseCallbacks() {
+		ScriptVM::ReleaseReference(m_onBegin);
+		ScriptVM::ReleaseReference(m_onUpdate);
+		m_onBegin = LUA_NOREF;
+		m_onUpdate = LUA_NOREF;
+	}
+
+	void Script::resetUpdateTimer() {
+		m_updateElapsed = 0.0;
+		m_updateTimer = 0.0;
+		b_deferred = false;
+		if (m_updateRate <= 0.0f) return;
+		// golden ratio sequence, so any number of scripts with the same rate are spread evenly over the period
+		double phase = std::fmod(s_staggerIndex++ * 0.6180339887498949, 1.0);
+		m_updateTimer = phase * 1000.0 / m_updateRate;
+	}
+
+	void Script::SetUpdateRate(float hz) {
+		m_updateRate = std::max(hz, 0.0f);
+		resetUpdateTimer();
 	}
 
 	void Script::OnImGuiRender() {
@@ -43,6 +93,7 @@ namespace Lobster {
 				// None
 				if (ImGui::Selectable("None", filename.size() == 0)) {
 					filename.clear();
+					GetOwner()->MarkEdited();
 				}
 				// load scripts in resources
 				fs::path subdir = FileSystem::Path(PATH_SCRIPTS);
@@ -51,6 +102,7 @@ namespace Lobster {
 					std::string displayName = dirEntry.path().filename().string();
 					if (ImGui::Selectable(displayName.c_str(), filename == displayName)) {
 						loadScript(displayName.c_str());
+						GetOwner()->MarkEdited();
 					}
 				}
 				ImGui::EndCombo();
@@ -71,24 +123,43 @@ namespace Lobster {
 				}
 			}
 			ImGui::EndChild();
+			if (filename.size() > 0) {
+				ImGui::Text("Loaded in %.2f ms, %.1f KB", m_loadTime, m_memoryFootprint / 1024.0);
+			}
+			// update rate
+			if (ImGui::InputFloat("Update Rate (Hz)", &m_updateRate, 1.0f, 10.0f, "%.1f")) {
+				m_updateRate = std::max(m_updateRate, 0.0f);
+			}
+			if (ImGui::IsItemHovered()) ImGui::SetTooltip("0 to update every frame");
+			if (ImGui::IsItemDeactivatedAfterEdit() && m_prevUpdateRate != m_updateRate) {
+				UndoSystem::GetInstance()->Push(new PropertyAssignmentCommand<float, Script, Script>(this, &m_updateRate, m_prevUpdateRate, m_updateRate, "Set update rate to " + StringOps::ToString(m_updateRate) + " Hz for " + GetOwner()->GetName(), &Script::resetUpdateTimer));
+				resetUpdateTimer();
+			}
+			if (!ImGui::IsItemActive()) m_prevUpdateRate = m_updateRate;
+			// scheduling priority
+			if (ImGui::Checkbox("Low Priority", &b_lowPriority)) {
+				UndoSystem::GetInstance()->Push(new PropertyAssignmentCommand(this, &b_lowPriority, !b_lowPriority, b_lowPriority, std::string(b_lowPriority ? "Lowered" : "Restored") + " script priority for " + GetOwner()->GetName()));
+			}
+			if (ImGui::IsItemHovered()) ImGui::SetTooltip("Deferred to the next frame when scripts are over the frame time budget");
+			// cost of this script file over the last frame, all instances together
+			if (m_stats && m_stats->last.calls[SCRIPT_CALL_UPDATE] > 0) {
+				const ScriptFrameStats& last = m_stats->last;
+				ImGui::Text("Last frame: %.3f ms, %zu updates, %.1f KB allocated", last.TotalTime(), last.calls[SCRIPT_CALL_UPDATE], last.allocated / 1024.0);
+				if (last.deferred > 0) ImGui::Text("Deferred: %zu", last.deferred);
+			}
 		}
 	}
 
 	void Script::Execute(std::string funcName) {
 		if (Application::GetMode() != GAME) return;
 		if (filename.size() == 0 || errmsg.size() > 0) return;
-		LuaRef lua_Func = getGlobal(L, funcName.c_str());
-		try {
-			lua_Func();
-		}
-		catch (LuaException const& e) {
-			// not editing errmsg here (nowhere to display), use log instead
-			static char lastWarn[256] = "";
-			if (strcmp(lastWarn, e.what())) {
-				strcpy(lastWarn, e.what());
-				errmsg = lastWarn;
-			}
+		ScriptProfileScope profile(m_stats, SCRIPT_CALL_EXECUTE);
+		int function = ScriptVM::ResolveFunction(m_env, funcName.c_str());
+		std::string error;
+		if (!ScriptVM::Call(function, error)) {
+			errmsg = funcName + "(): " + error;
 		}
+		ScriptVM::ReleaseReference(function);
 	}
 
 	std::string Script::GetErrmsg() {
@@ -96,9 +167,9 @@ namespace Lobster {
 	}
 
 	LuaRef Script::GetVar(std::string varName) {
-		if (Application::GetMode() != GAME) return LuaRef(L);
-		if (varName.empty() || filename.empty() || errmsg.size() > 0) return LuaRef(L);
-		LuaRef lua_Var = getGlobal(L, varName.c_str());
+		if (Application::GetMode() != GAME) return LuaRef(ScriptVM::GetState());
+		if (varName.empty() || filename.empty() || errmsg.size() > 0) return LuaRef(ScriptVM::GetState());
+		LuaRef lua_Var = ScriptVM::Get(m_env, varName.c_str());
 		if (lua_Var.isNil()) {
 			// not editing errmsg here (nowhere to display), use log instead
 			char buffer[256];			
@@ -112,6 +183,20 @@ namespace Lobster {
 		return lua_Var;
 	}
 
+	void Script::Watch(const std::string& varName) {
+		ScriptVM::Watch(m_env, varName.c_str());
+	}
+
+	bool Script::ConsumeChange(const std::string& varName) {
+		return ScriptVM::ConsumeChange(m_env, varName.c_str());
+	}
+
+	size_t Script::ConsumeUpdateCalls() {
+		size_t calls = s_updateCalls;
+		s_updateCalls = 0;
+		return calls;
+	}
+
 	void Script::OnBegin() {		
 		if (Application::GetMode() != GAME) return;
 		if (filename.size() == 0 || errmsg.size() > 0) return;
@@ -120,24 +205,41 @@ namespace Lobster {
 			loadScript(filename.c_str());
 			b_defer = false;
 		}		
-		LuaRef lua_OnBegin = getGlobal(L, "OnBegin");
-		try {
-			lua_OnBegin();
-		}
-		catch (LuaException const& e) {
-			errmsg += "OnBegin(): " + std::string(e.what()) + "\n";
+		std::string error;
+		ScriptProfileScope profile(m_stats, SCRIPT_CALL_BEGIN);
+		if (!ScriptVM::Call(m_onBegin, error)) {
+			errmsg += "OnBegin(): " + error + "\n";
 		}
+		// OnBegin may define or replace OnUpdate
+		ScriptVM::ReleaseReference(m_onUpdate);
+		m_onUpdate = ScriptVM::ResolveFunction(m_env, "OnUpdate");
 	}
 
 	void Script::OnUpdate(double deltaTime) {
 		if (Application::GetMode() != GAME) return;
 		if (filename.size() == 0 || errmsg.size() > 0) return;
-		LuaRef lua_OnUpdate = getGlobal(L, "OnUpdate");
-		try {
-			lua_OnUpdate(deltaTime);
+		if (m_onUpdate == LUA_REFNIL || m_onUpdate == LUA_NOREF) return;
+		m_updateElapsed += deltaTime;
+		if (m_updateRate > 0.0f && !b_deferred) {
+			m_updateTimer -= deltaTime;
+			if (m_updateTimer > 0.0) return;
+			// stay on the same phase, but do not try to catch up after a long frame
+			m_updateTimer = std::max(m_updateTimer + 1000.0 / m_updateRate, 0.0);
 		}
-		catch (LuaException const& e) {
-			errmsg += "OnUpdate(): " + std::string(e.what()) + "\n";
+		// past the frame budget, low priority scripts wait for the next frame, but never twice in a row
+		if (b_lowPriority && !b_deferred && ScriptProfiler::IsOverBudget()) {
+			b_deferred = true;
+			ScriptProfiler::Defer(m_stats);
+			return;
+		}
+		b_deferred = false;
+		deltaTime = m_updateElapsed;
+		m_updateElapsed = 0.0;
+		s_updateCalls++;
+		ScriptProfileScope profile(m_stats, SCRIPT_CALL_UPDATE);
+		std::string error;
+		if (!ScriptVM::Call(m_onUpdate, deltaTime, error)) {
+			errmsg += "OnUpdate(): " + error + "\n";
 		}
 	}
 
@@ -208,10 +310,7 @@ namespace Lobster {
 		return true;
 	}
 	GameObject* FunctionBinder::GetGameObjectById(Scene* scene, unsigned long long id) {
-		for (GameObject* obj : scene->m_gameObjects) {
-			if (obj->GetId() == id) return obj;
-		}
-		return nullptr;
+		return GameObject::Find(id, scene);
 	}
 	GameObject* FunctionBinder::GetGameObjectByName(Scene* scene, std::string name) {
 		for (GameObject* obj : scene->m_gameObjects) {
@@ -220,7 +319,16 @@ namespace Lobster {
 		return nullptr;
 	}
 	void FunctionBinder::RemoveGameObject(Scene* scene, GameObject* gameObject) {
-		scene->RemoveGameObject(gameObject);
+		//	Deferred, the script may be running inside the scene update loop
+		scene->DestroyGameObject(gameObject);
+	}
+
+	GameObject* FunctionBinder::InstantiatePrefab(Scene* scene, const char* path) {
+		//	Deferred like RemoveGameObject, the instance joins the scene at the end of the frame
+		GameObject* instance = PrefabLibrary::Use(FileSystem::Path(path).c_str())->Instantiate();
+		instance->OnBegin();
+		scene->SpawnGameObject(instance);
+		return instance;
 	}
 
 	void FunctionBinder::SetBlur(bool blur) {
@@ -241,13 +349,17 @@ namespace Lobster {
 		return Application::GetInstance()->OpenSceneIngame(scene);
 	}
 
-	void Script::Bind() {
+	void Script::BindEngine(lua_State* L) {
+		LuaMath::Register(L);
 		// Class/function binding
 		getGlobalNamespace(L)
 			.beginNamespace("Lobster")
 			// Input events
 			.addFunction("IsKeyDown", Input::IsKeyDown)
 			.addFunction("IsKeyUp", Input::IsKeyUp)
+			.addFunction("IsKeyHold", Input::IsKeyHold)
+			.addFunction("IsKeyPressed", Input::IsKeyPressed)
+			.addFunction("IsKeyReleased", Input::IsKeyReleased)
 			.addFunction("GetMousePosX", Input::GetMousePosX)
 			.addFunction("GetMousePosY", Input::GetMousePosY)
 			.addFunction("GetMouseDeltaX", Input::GetMouseDeltaX)
@@ -255,6 +367,8 @@ namespace Lobster {
 			.addFunction("IsMouseDown", Input::IsMouseDown)
 			.addFunction("IsMouseHold", Input::IsMouseHold)
 			.addFunction("IsMouseUp", Input::IsMouseUp)
+			.addFunction("IsMousePressed", Input::IsMousePressed)
+			.addFunction("IsMouseReleased", Input::IsMouseReleased)
 			.addFunction("LockCursor", Input::LockCursor)
 			.addFunction("UnlockCursor", Input::UnlockCursor)
 			.addFunction("DisableCursor", FunctionBinder::DisableCursor)
@@ -276,16 +390,12 @@ namespace Lobster {
 			.addFunction("GetParticleComponent", FunctionBinder::GetParticleComponent)
 			.addFunction("GetScript", FunctionBinder::GetScript)
 			.addFunction("RemoveGameObject", FunctionBinder::RemoveGameObject)
-			// glm::vec3			
-			.beginClass<glm::vec3>("Vec3")
-			.addConstructor<void(*) (float, float, float)>()
-			.addProperty("x", &glm::vec3::x)
-			.addProperty("y", &glm::vec3::y)
-			.addProperty("z", &glm::vec3::z)
-			.endClass()
-			// Transform
+			.addFunction("InstantiatePrefab", FunctionBinder::InstantiatePrefab)
+			// Transform (Vec3, Quat and Mat4 are bound by LuaMath)
 			.beginClass<Transform>("Transform")
 			.addProperty("WorldPosition", &Transform::WorldPosition)
+			.addProperty("LocalRotation", &Transform::LocalRotation)
+			.addFunction("GetMatrix", &Transform::GetMatrix)
 			.addFunction("Up", &Transform::Up)
 			.addFunction("Right", &Transform::Right)
 			.addFunction("Forward", &Transform::Forward)
@@ -332,9 +442,9 @@ namespace Lobster {
 			.endClass()
 			// Sprite
 			.beginClass<Sprite2D>("Sprite2D")
-			.addProperty("x", &Sprite2D::x)
-			.addProperty("y", &Sprite2D::y)
-			.addProperty("alpha", &Sprite2D::alpha)
+			.addProperty("x", &Sprite2D::GetX, &Sprite2D::SetX)
+			.addProperty("y", &Sprite2D::GetY, &Sprite2D::SetY)
+			.addProperty("alpha", &Sprite2D::GetAlpha, &Sprite2D::SetAlpha)
 			.addFunction("IsMouseOver", &Sprite2D::IsMouseOver)
 			.endClass()
 			.deriveClass<ImageSprite2D, Sprite2D>("ImageSprite2D")
@@ -360,11 +470,14 @@ namespace Lobster {
 			.addFunction("GetInt", &Script::GetInt)
 			.addFunction("GetFloat", &Script::GetFloat)
 			.addFunction("GetString", &Script::GetString)
+			.addFunction("SetUpdateRate", &Script::SetUpdateRate)
+			.addFunction("GetUpdateRate", &Script::GetUpdateRate)
 			.endClass()
 			// GameObject
 			.beginClass<GameObject>("GameObject")
 			.addConstructor<void(*)(const char*)>()
 			.addProperty("transform", &GameObject::transform)			
+			.addFunction("GetId", &GameObject::GetId)
 			.addFunction("AddComponent", &GameObject::AddComponent)
 			.addFunction("AddChild", &GameObject::AddChild)
 			.addFunction("Intersects", &GameObject::Intersects)
@@ -378,13 +491,21 @@ namespace Lobster {
 			.addFunction("GetGameObjectByName", &FunctionBinder::GetGameObjectByName)
 			.endClass()
 			.endNamespace();
-		// Object passing
+	}
+
+	void Script::Bind() {
+		// Object passing, into this script's environment only
+		lua_State* L = ScriptVM::GetState();
+		lua_rawgeti(L, LUA_REGISTRYINDEX, m_env);
 		push(L, transform); // shortcut pointer to 'Transform', C++ lifetime
-		lua_setglobal(L, "transform");
+		lua_setfield(L, -2, "transform");
 		push(L, gameObject); // pointer to 'GameObject', C++ lifetime
-		lua_setglobal(L, "this");
+		lua_setfield(L, -2, "this");
 		push(L, Application::GetInstance()->GetCurrentScene()); // pointer to current scene, C++ lifetime
-		lua_setglobal(L, "scene");
+		lua_setfield(L, -2, "scene");
+		ScriptScheduler::PushStarter(L, this); // StartCoroutine(f, ...), coroutines owned by this script
+		lua_setfield(L, -2, "StartCoroutine");
+		lua_pop(L, 1);
 	}
 
 }
\ No newline at end of file
@@ -2,10 +2,13 @@
 #include "pch.h"
 #include "objects/GameObject.h"
 #include "objects/Transform.h"
+#include "utils/Serialization.h"
 
 namespace Lobster
 {
 
+	struct ScriptStats;
+
 	// A helper class to bind functions to Lua through LuaBridge
 	struct FunctionBinder {
 		static void DisableCursor();
@@ -26,6 +29,7 @@ namespace Lobster
 		static GameObject* GetGameObjectById(Scene* scene, unsigned long long id);
 		static GameObject* GetGameObjectByName(Scene* scene, std::string name);
 		static void RemoveGameObject(Scene* scene, GameObject* gameObject);
+		static GameObject* InstantiatePrefab(Scene* scene, const char* path);
 		// renderer related
 		static void SetBlur(bool blur);
 		static void SetSSR(bool ssr);
@@ -36,25 +40,53 @@ namespace Lobster
 	};
     
 	//	This class is a component for user to define custom scripts with Lua.
+	//	All scripts share the ScriptVM state; each instance keeps its own globals in an environment table.
     class Script : public Component {
+		friend class ScriptScheduler;
 	private:
-		lua_State* L;
+		int m_env = LUA_NOREF;	// registry reference of this script's environment table
 		std::string filename;
 		std::string errmsg;	// error message of the script (if any)
 		bool b_defer = false; // whether to load the script on begin
+		double m_loadTime = 0.0;	// time spent loading the script, in ms
+		size_t m_memoryFootprint = 0;	// Lua memory allocated while loading the script, in bytes
+		int m_onBegin = LUA_NOREF;	// registry references of the callbacks, resolved when the script is loaded
+		int m_onUpdate = LUA_NOREF;
+		float m_updateRate = 0.0f;	// OnUpdate calls per second, 0 to update every frame
+		float m_prevUpdateRate = 0.0f;	// used for undo system
+		double m_updateTimer = 0.0;	// ms until the next OnUpdate call
+		double m_updateElapsed = 0.0;	// ms since the last OnUpdate call
+		bool b_lowPriority = false;	// whether OnUpdate may be deferred when scripts are over the frame budget
+		bool b_deferred = false;	// whether the last OnUpdate was deferred
+		ScriptStats* m_stats = nullptr;	// profiling entry of this script file
+		static size_t s_updateCalls;	// OnUpdate calls since the last ConsumeUpdateCalls()
+		static uint s_staggerIndex;	// spreads the update phase of scripts sharing a rate
 
 		// Load or reload a Lua script in relative path into the object.
 		void loadScript(const char* file);
+		void resolveCallbacks();
+		void releaseCallbacks();
+		void resetUpdateTimer();
     public:
 		Script();
 		Script(const char* file);
 		~Script();	
-		// pass class/object information to Lua via LuaBridge
+		// register the engine classes and functions in a Lua state, done once by ScriptVM
+		static void BindEngine(lua_State* L);
+		// pass object information (this, transform, scene) to the script's environment
 		void Bind(); 
 		// these functions should ONLY be called as non-component (e.g. UI button call)
 		void Execute(std::string funcName);
 		std::string GetErrmsg();
 		luabridge::LuaRef GetVar(std::string varName);		
+		// mark a variable as observed, so that ConsumeChange() can tell when the script assigns it
+		void Watch(const std::string& varName);
+		bool ConsumeChange(const std::string& varName);
+		// call OnUpdate at most hz times per second with the time accumulated in between, 0 to call it every frame
+		void SetUpdateRate(float hz);
+		inline float GetUpdateRate() { return m_updateRate; }
+		// number of Lua OnUpdate calls since the last call, for profiling
+		static size_t ConsumeUpdateCalls();
 		// =====================
 		virtual void OnBegin() override;
 		virtual void OnUpdate(double deltaTime) override;
@@ -70,9 +102,15 @@ namespace Lobster
 		friend class cereal::access;
 		template <class Archive> void save(Archive & ar) const {
 			ar(filename);
+			ar(cereal::make_nvp("updateRate", m_updateRate));
+			ar(cereal::make_nvp("lowPriority", b_lowPriority));
 		}
 		template <class Archive> void load(Archive & ar) {
 			ar(filename);
+			// older scenes do not store an update rate nor a priority
+			if (!Serialization::LoadOptional(ar, "updateRate", m_updateRate)) m_updateRate = 0.0f;
+			if (!Serialization::LoadOptional(ar, "lowPriority", b_lowPriority)) b_lowPriority = false;
+			resetUpdateTimer();
 			b_defer = true;
 		}
     };
@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "ScriptProfiler.h"
+#include "scripts/ScriptVM.h"
+
+namespace Lobster
+{
+
+	ScriptProfiler* ScriptProfiler::s_instance = nullptr;
+
+	double ScriptFrameStats::TotalTime() const
+	{
+		double total = 0.0;
+		for (double t : time) total += t;
+		return total;
+	}
+
+	void ScriptProfiler::Initialize(double budget)
+	{
+		if (s_instance != nullptr)
+		{
+			throw std::runtime_error("ScriptProfiler already existed!");
+		}
+		s_instance = new ScriptProfiler();
+		s_instance->m_budget = budget;
+	}
+
+	ScriptStats* ScriptProfiler::Use(const std::string& filename)
+	{
+		auto it = s_instance->m_stats.find(filename);
+		if (it == s_instance->m_stats.end()) it = s_instance->m_stats.emplace(filename, ScriptStats()).first;
+		return &it->second;
+	}
+
+	void ScriptProfiler::Defer(ScriptStats* stats)
+	{
+		if (stats) stats->current.deferred++;
+	}
+
+	void ScriptProfiler::SetSampling(bool sampling)
+	{
+		s_instance->b_sampling = sampling;
+		s_instance->m_samples.clear();
+		// coroutines copy the hook when they are created, the ones already running keep their setting
+		if (sampling) lua_sethook(ScriptVM::GetState(), luaSampleHook, LUA_MASKCOUNT, SampleInterval);
+		else lua_sethook(ScriptVM::GetState(), nullptr, 0, 0);
+	}
+
+	void ScriptProfiler::luaSampleHook(lua_State* L, lua_Debug* ar)
+	{
+		if (!lua_getinfo(L, "Sln", ar)) return;
+		char key[256];
+		snprintf(key, sizeof(key), "%s:%d %s", ar->short_src, ar->currentline, ar->name ? ar->name : "?");
+		s_instance->m_samples[key]++;
+	}
+
+	void ScriptProfiler::EndFrame()
+	{
+		auto start = HighResolutionClock::now();
+		lua_gc(ScriptVM::GetState(), LUA_GCSTEP, 0);
+		Profiler::SubmitData("Lua GC Time", milliseconds_type(HighResolutionClock::now() - start).count());
+		Profiler::SubmitData("Script Time", s_instance->m_frameTime);
+		for (auto& [filename, stats] : s_instance->m_stats) {
+			stats.last = stats.current;
+			stats.current = ScriptFrameStats();
+		}
+		s_instance->m_frameTime = 0.0;
+	}
+
+	ScriptProfileScope::ScriptProfileScope(ScriptStats* stats, ScriptCallType type) :
+		m_stats(stats),
+		m_type(type),
+		m_start(HighResolutionClock::now()),
+		m_memory(stats ? ScriptVM::GetMemoryUsage() : 0)
+	{
+	}
+
+	ScriptProfileScope::~ScriptProfileScope()
+	{
+		if (!m_stats) return;
+		double time = milliseconds_type(HighResolutionClock::now() - m_start).count();
+		size_t memory = ScriptVM::GetMemoryUsage();
+		ScriptFrameStats& frame = m_stats->current;
+		frame.time[m_type] += time;
+		frame.calls[m_type]++;
+		// a collection during the call makes the difference negative, count nothing then
+		if (memory > m_memory) frame.allocated += memory - m_memory;
+		ScriptProfiler::s_instance->m_frameTime += time;
+	}
+
+}
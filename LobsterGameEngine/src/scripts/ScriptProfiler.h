@@ -0,0 +1,76 @@
+#pragma once
+
+namespace Lobster
+{
+
+	enum ScriptCallType
+	{
+		SCRIPT_CALL_BEGIN,
+		SCRIPT_CALL_UPDATE,
+		SCRIPT_CALL_EXECUTE,
+		SCRIPT_CALL_COROUTINE,
+		SCRIPT_CALL_TYPE_COUNT
+	};
+
+	//	Cost of one .lua file over a frame, summed over all of its instances.
+	struct ScriptFrameStats
+	{
+		double time[SCRIPT_CALL_TYPE_COUNT] = {};	// ms
+		size_t calls[SCRIPT_CALL_TYPE_COUNT] = {};
+		double allocated = 0.0;	// bytes allocated by Lua during the calls, collections excluded
+		size_t deferred = 0;	// updates pushed to the next frame by the time budget
+		double TotalTime() const;
+	};
+
+	struct ScriptStats
+	{
+		ScriptFrameStats current;	// frame in progress
+		ScriptFrameStats last;		// last complete frame, for display
+	};
+
+	//	Per-script instrumentation of the Lua callbacks, plus the per-frame time budget of OnUpdate.
+	//	Optionally samples the running Lua code every SampleInterval instructions (lua_sethook), to find hot functions and lines.
+	class ScriptProfiler
+	{
+		friend class ImGuiScene;
+		friend class ScriptProfileScope;
+	public:
+		static constexpr int SampleInterval = 1000;
+	private:
+		static ScriptProfiler* s_instance;
+		std::map<std::string, ScriptStats, std::less<>> m_stats;	// never erased, scripts keep pointers to their entry
+		std::unordered_map<std::string, size_t> m_samples;	// "file:line function" -> samples
+		bool b_sampling = false;
+		double m_budget = 0.0;		// ms of script time per frame before low priority scripts are deferred, 0 for no budget
+		double m_frameTime = 0.0;	// ms of script time so far this frame
+		ScriptProfiler() = default;
+		static void luaSampleHook(lua_State* L, lua_Debug* ar);
+	public:
+		static void Initialize(double budget);
+		//	Returns the stats entry of a script file, creating it if needed. The pointer stays valid.
+		static ScriptStats* Use(const std::string& filename);
+		inline static bool IsOverBudget() { return s_instance->m_budget > 0.0 && s_instance->m_frameTime > s_instance->m_budget; }
+		inline static void SetBudget(double ms) { s_instance->m_budget = ms; }
+		static void Defer(ScriptStats* stats);
+		static void SetSampling(bool sampling);
+		inline static bool IsSampling() { return s_instance->b_sampling; }
+		//	Steps the Lua garbage collector (timed), publishes the frame and starts the next one. Call once per frame.
+		static void EndFrame();
+	};
+
+	//	Times a Lua call and accounts it to a script. stats may be nullptr, then nothing is recorded.
+	class ScriptProfileScope
+	{
+	private:
+		ScriptStats* m_stats;
+		ScriptCallType m_type;
+		std::chrono::time_point<HighResolutionClock> m_start;
+		size_t m_memory;
+	public:
+		ScriptProfileScope(ScriptStats* stats, ScriptCallType type);
+		~ScriptProfileScope();
+		ScriptProfileScope(const ScriptProfileScope&) = delete;
+		ScriptProfileScope& operator=(const ScriptProfileScope&) = delete;
+	};
+
+}
@@ -0,0 +1,236 @@
+#include "pch.h"
+#include "ScriptScheduler.h"
+#include "scripts/Script.h"
+#include "scripts/ScriptProfiler.h"
+#include "scripts/ScriptVM.h"
+#include "system/FrameAllocator.h"
+
+namespace Lobster
+{
+
+	ScriptScheduler* ScriptScheduler::s_instance = nullptr;
+
+	//	Markers yielded in front of the wait arguments, so a plain coroutine.yield(x) is not mistaken for a wait.
+	static char s_waitTime, s_waitUntil, s_waitEvent;
+
+	void ScriptScheduler::Initialize()
+	{
+		if (s_instance != nullptr)
+		{
+			throw std::runtime_error("ScriptScheduler already existed!");
+		}
+		s_instance = new ScriptScheduler();
+		luabridge::getGlobalNamespace(ScriptVM::GetState())
+			.beginNamespace("Lobster")
+			.addCFunction("Wait", luaWait)
+			.addCFunction("WaitUntil", luaWaitUntil)
+			.addCFunction("WaitForEvent", luaWaitForEvent)
+			.addCFunction("SendEvent", luaSendEvent)
+			.endNamespace();
+	}
+
+	void ScriptScheduler::PushStarter(lua_State* L, Script* owner)
+	{
+		lua_pushlightuserdata(L, owner);
+		lua_pushcclosure(L, luaStartCoroutine, 1);
+	}
+
+	void ScriptScheduler::Update(double deltaTime)
+	{
+		ScriptScheduler* s = s_instance;
+		lua_State* L = ScriptVM::GetState();
+		s->m_time += deltaTime;
+
+		FrameVector<uint> due(s->m_ready.begin(), s->m_ready.end());
+		s->m_ready.clear();
+		// timers, earliest first
+		while (!s->m_timers.empty() && s->m_timers.front().time <= s->m_time) {
+			std::pop_heap(s->m_timers.begin(), s->m_timers.end(), std::greater<WakeTime>());
+			uint id = s->m_timers.back().id;
+			s->m_timers.pop_back();
+			auto it = s->m_coroutines.find(id);
+			if (it != s->m_coroutines.end() && it->second.wait == WAIT_TIME) due.push_back(id);
+		}
+		// predicates, polled once per frame
+		FrameVector<uint> polling(s->m_polling.begin(), s->m_polling.end());
+		s->m_polling.clear();
+		for (uint id : polling) {
+			auto it = s->m_coroutines.find(id);
+			if (it == s->m_coroutines.end() || it->second.wait != WAIT_UNTIL) continue;
+			Script* owner = it->second.owner;
+			ScriptProfileScope profile(owner->m_stats, SCRIPT_CALL_COROUTINE);
+			lua_rawgeti(L, LUA_REGISTRYINDEX, it->second.predicate);
+			if (lua_pcall(L, 0, 1, 0) != LUA_OK) {
+				std::string error = "WaitUntil(): " + std::string(lua_tostring(L, -1) ? lua_tostring(L, -1) : "Unknown error");
+				lua_pop(L, 1);
+				if (s->m_coroutines.count(id)) s->fail(owner, error);
+				continue;
+			}
+			bool done = lua_toboolean(L, -1);
+			lua_pop(L, 1);
+			if (done) due.push_back(id);
+			else s->m_polling.push_back(id);
+		}
+
+		for (uint id : due) {
+			auto it = s->m_coroutines.find(id);
+			if (it == s->m_coroutines.end()) continue;
+			ScriptProfileScope profile(it->second.owner->m_stats, SCRIPT_CALL_COROUTINE);
+			s->resume(id, 0, L);
+		}
+	}
+
+	void ScriptScheduler::SendEvent(const char* name)
+	{
+		auto it = s_instance->m_listeners.find(name);
+		if (it == s_instance->m_listeners.end()) return;
+		for (uint id : it->second) {
+			auto c = s_instance->m_coroutines.find(id);
+			if (c == s_instance->m_coroutines.end() || c->second.wait != WAIT_EVENT) continue;
+			c->second.wait = WAIT_FRAME;
+			s_instance->m_ready.push_back(id);
+		}
+		s_instance->m_listeners.erase(it);
+	}
+
+	void ScriptScheduler::Cancel(Script* owner)
+	{
+		if (!s_instance) return;
+		// entries left in the timer heap and the wait lists are skipped once their coroutine is gone
+		std::vector<uint> ids;
+		for (const auto& [id, coroutine] : s_instance->m_coroutines) {
+			if (coroutine.owner == owner) ids.push_back(id);
+		}
+		for (uint id : ids) s_instance->remove(id);
+	}
+
+	size_t ScriptScheduler::ConsumeResumes()
+	{
+		size_t resumes = s_instance->m_resumes;
+		s_instance->m_resumes = 0;
+		return resumes;
+	}
+
+	void ScriptScheduler::resume(uint id, int nargs, lua_State* from)
+	{
+		auto it = m_coroutines.find(id);
+		if (it == m_coroutines.end()) return;
+		Coroutine& coroutine = it->second;
+		Script* owner = coroutine.owner;
+		lua_State* co = coroutine.state;
+		ScriptVM::ReleaseReference(coroutine.predicate);
+		coroutine.predicate = LUA_NOREF;
+		coroutine.wait = WAIT_NONE;
+		// keep the thread reachable while it runs, even if its owner gets cancelled meanwhile
+		lua_rawgeti(from, LUA_REGISTRYINDEX, coroutine.thread);
+		m_resumes++;
+		int status = lua_resume(co, from, nargs);
+		bool alive = m_coroutines.count(id) > 0;
+		if (status == LUA_YIELD) {
+			if (alive) schedule(id, co);
+			else lua_settop(co, 0);
+		}
+		else if (status == LUA_OK) {
+			if (alive) remove(id);
+		}
+		else {
+			luaL_traceback(from, co, lua_tostring(co, -1) ? lua_tostring(co, -1) : "Unknown error", 0);
+			std::string error = "Coroutine: " + std::string(lua_tostring(from, -1));
+			lua_pop(from, 1);
+			if (alive) fail(owner, error);
+		}
+		lua_pop(from, 1);
+	}
+
+	void ScriptScheduler::schedule(uint id, lua_State* co)
+	{
+		Coroutine& coroutine = m_coroutines[id];
+		void* tag = lua_gettop(co) > 0 ? lua_touserdata(co, 1) : nullptr;
+		if (tag == &s_waitTime) {
+			coroutine.wait = WAIT_TIME;
+			m_timers.push_back({ m_time + lua_tonumber(co, 2) * 1000.0, id });
+			std::push_heap(m_timers.begin(), m_timers.end(), std::greater<WakeTime>());
+		}
+		else if (tag == &s_waitUntil) {
+			coroutine.wait = WAIT_UNTIL;
+			lua_pushvalue(co, 2);
+			coroutine.predicate = luaL_ref(co, LUA_REGISTRYINDEX);
+			m_polling.push_back(id);
+		}
+		else if (tag == &s_waitEvent) {
+			coroutine.wait = WAIT_EVENT;
+			m_listeners[lua_tostring(co, 2)].push_back(id);
+		}
+		else {
+			coroutine.wait = WAIT_FRAME;
+			m_ready.push_back(id);
+		}
+		lua_settop(co, 0);
+	}
+
+	void ScriptScheduler::remove(uint id)
+	{
+		auto it = m_coroutines.find(id);
+		if (it == m_coroutines.end()) return;
+		ScriptVM::ReleaseReference(it->second.predicate);
+		ScriptVM::ReleaseReference(it->second.thread);
+		m_coroutines.erase(it);
+	}
+
+	void ScriptScheduler::fail(Script* owner, const std::string& error)
+	{
+		WARN(error);
+		owner->errmsg = error;
+		// the script stops running, so do its coroutines
+		Cancel(owner);
+	}
+
+	int ScriptScheduler::luaStartCoroutine(lua_State* L)
+	{
+		Script* owner = static_cast<Script*>(lua_touserdata(L, lua_upvalueindex(1)));
+		luaL_checktype(L, 1, LUA_TFUNCTION);
+		int nargs = lua_gettop(L) - 1;
+		lua_State* co = lua_newthread(L);
+		lua_insert(L, 1);
+		lua_xmove(L, co, nargs + 1);	// function and arguments
+		uint id = s_instance->m_nextId++;
+		s_instance->m_coroutines[id] = { owner, luaL_ref(L, LUA_REGISTRYINDEX), co, WAIT_NONE, LUA_NOREF };
+		// runs right away until the first wait, like a function call
+		s_instance->resume(id, nargs, L);
+		return 0;
+	}
+
+	int ScriptScheduler::luaWait(lua_State* L)
+	{
+		lua_Number seconds = luaL_optnumber(L, 1, 0.0);
+		lua_settop(L, 0);
+		lua_pushlightuserdata(L, &s_waitTime);
+		lua_pushnumber(L, seconds);
+		return lua_yield(L, 2);
+	}
+
+	int ScriptScheduler::luaWaitUntil(lua_State* L)
+	{
+		luaL_checktype(L, 1, LUA_TFUNCTION);
+		lua_settop(L, 1);
+		lua_pushlightuserdata(L, &s_waitUntil);
+		lua_insert(L, 1);
+		return lua_yield(L, 2);
+	}
+
+	int ScriptScheduler::luaWaitForEvent(lua_State* L)
+	{
+		luaL_checkstring(L, 1);
+		lua_settop(L, 1);
+		lua_pushlightuserdata(L, &s_waitEvent);
+		lua_insert(L, 1);
+		return lua_yield(L, 2);
+	}
+
+	int ScriptScheduler::luaSendEvent(lua_State* L)
+	{
+		SendEvent(luaL_checkstring(L, 1));
+		return 0;
+	}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+namespace Lobster
+{
+
+	class Script;
+
+	//	Runs Lua coroutines started by scripts and resumes them when what they wait for is due.
+	//	From Lua, inside a coroutine started with StartCoroutine(f, ...):
+	//		Lobster.Wait(seconds)		resumes after the given game time, on a min-heap of wake times
+	//		Lobster.WaitUntil(f)		resumes on the first frame f() returns true
+	//		Lobster.WaitForEvent(name)	resumes on the next update after Lobster.SendEvent(name) or ScriptScheduler::SendEvent(name)
+	//		coroutine.yield()			resumes next frame
+	//	Waiting coroutines cost nothing per frame except WaitUntil, whose predicates are polled.
+	//	Only use it from the main thread.
+	class ScriptScheduler
+	{
+	private:
+		enum WaitType { WAIT_NONE, WAIT_TIME, WAIT_UNTIL, WAIT_EVENT, WAIT_FRAME };
+		struct Coroutine
+		{
+			Script* owner;
+			int thread;		// registry reference of the Lua thread, keeps it alive
+			lua_State* state;
+			WaitType wait;
+			int predicate;	// registry reference of the WaitUntil function
+		};
+		struct WakeTime
+		{
+			double time;
+			uint id;
+			bool operator>(const WakeTime& other) const { return time > other.time; }
+		};
+		static ScriptScheduler* s_instance;
+		std::unordered_map<uint, Coroutine> m_coroutines;
+		std::vector<WakeTime> m_timers;		// min-heap
+		std::vector<uint> m_polling;		// coroutines in WaitUntil
+		std::vector<uint> m_ready;			// coroutines to resume on the next update
+		std::unordered_map<std::string, std::vector<uint>> m_listeners;
+		uint m_nextId = 1;
+		double m_time = 0.0;	// game time, in ms
+		size_t m_resumes = 0;	// resumes since the last ConsumeResumes()
+		ScriptScheduler() = default;
+		void resume(uint id, int nargs, lua_State* from);
+		void schedule(uint id, lua_State* co);
+		void remove(uint id);
+		void fail(Script* owner, const std::string& error);
+		static int luaStartCoroutine(lua_State* L);
+		static int luaWait(lua_State* L);
+		static int luaWaitUntil(lua_State* L);
+		static int luaWaitForEvent(lua_State* L);
+		static int luaSendEvent(lua_State* L);
+	public:
+		//	Registers the wait functions in the Lobster namespace. Call after ScriptVM::Initialize().
+		static void Initialize();
+		//	Pushes the StartCoroutine function of a script, to be stored in its environment.
+		static void PushStarter(lua_State* L, Script* owner);
+		//	Resumes every coroutine that is due. deltaTime is in ms.
+		static void Update(double deltaTime);
+		static void SendEvent(const char* name);
+		//	Drops the coroutines of a script, e.g. when it is reloaded or destroyed.
+		static void Cancel(Script* owner);
+		inline static size_t GetCoroutineCount() { return s_instance->m_coroutines.size(); }
+		static size_t ConsumeResumes();
+	};
+
+}
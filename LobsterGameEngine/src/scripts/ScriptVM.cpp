@@ -0,0 +1,270 @@
+#include "pch.h"
+#include "ScriptVM.h"
+#include "scripts/Script.h"
+#include "system/MemoryTracker.h"
+
+namespace Lobster
+{
+
+	ScriptVM* ScriptVM::s_instance = nullptr;
+
+	static size_t s_allocatedBytes = 0;	// bytes requested by Lua since the last ConsumeAllocatedBytes()
+
+	//	Same as the allocator of luaL_newstate, but reports the memory of the Lua state to the MemoryTracker.
+	static void* luaAllocate(void* ud, void* ptr, size_t osize, size_t nsize) {
+		// when ptr is null, osize encodes the type of the object instead of a size
+		long long oldSize = ptr ? (long long)osize : 0;
+		if (nsize == 0) {
+			free(ptr);
+			MemoryTracker::TrackExternal(MEMORY_SCRIPT, -oldSize);
+			return nullptr;
+		}
+		void* block = realloc(ptr, nsize);
+		if (block) MemoryTracker::TrackExternal(MEMORY_SCRIPT, (long long)nsize - oldSize);
+		if (block && (long long)nsize > oldSize) s_allocatedBytes += nsize - oldSize;
+		return block;
+	}
+
+	static int luaPanic(lua_State* L) {
+		WARN("Unprotected error in Lua: {}", lua_tostring(L, -1));
+		return 0;
+	}
+
+	//	Message handler of Call, appends the stack traceback to the error.
+	static int luaTraceback(lua_State* L) {
+		const char* msg = lua_tostring(L, 1);
+		luaL_traceback(L, L, msg ? msg : "(error object is not a string)", 1);
+		return 1;
+	}
+
+	//	__index of an environment with watched names: watched values first, then the shared globals.
+	//	Upvalues: 1 = values of watched names.
+	static int luaWatchedIndex(lua_State* L) {
+		lua_pushvalue(L, 2);
+		if (lua_rawget(L, lua_upvalueindex(1)) != LUA_TNIL) return 1;
+		lua_pop(L, 1);
+		lua_pushglobaltable(L);
+		lua_pushvalue(L, 2);
+		lua_gettable(L, -2);
+		return 1;
+	}
+
+	//	__newindex of an environment with watched names. Only called for names the environment does not hold itself.
+	//	Upvalues: 1 = values of watched names, 2 = watched names -> changed flag.
+	static int luaWatchedNewIndex(lua_State* L) {
+		lua_pushvalue(L, 2);
+		if (lua_rawget(L, lua_upvalueindex(2)) == LUA_TNIL) {
+			lua_pop(L, 1);
+			lua_rawset(L, 1);
+			return 0;
+		}
+		lua_pop(L, 1);
+		lua_pushvalue(L, 2);
+		lua_pushboolean(L, 1);
+		lua_rawset(L, lua_upvalueindex(2));
+		lua_rawset(L, lua_upvalueindex(1));
+		return 0;
+	}
+
+	ScriptVM::ScriptVM()
+	{
+		MemoryScope scope(MEMORY_SCRIPT);
+		L = lua_newstate(luaAllocate, nullptr);
+		if (!L) throw std::runtime_error("Unable to create Lua state");
+		lua_atpanic(L, &luaPanic);
+		luaL_openlibs(L);
+		Script::BindEngine(L);
+	}
+
+	void ScriptVM::Initialize()
+	{
+		if (s_instance != nullptr)
+		{
+			throw std::runtime_error("ScriptVM already existed!");
+		}
+		Timer initTimer;
+		s_instance = new ScriptVM();
+		LOG("Lua VM initialized in {} ms, using {} KB", initTimer.GetElapsedTime(), GetMemoryUsage() / 1024);
+	}
+
+	int ScriptVM::NewEnvironment()
+	{
+		lua_State* L = s_instance->L;
+		// env = setmetatable({}, { __index = _G })
+		lua_newtable(L);
+		lua_newtable(L);
+		lua_pushglobaltable(L);
+		lua_setfield(L, -2, "__index");
+		lua_setmetatable(L, -2);
+		return luaL_ref(L, LUA_REGISTRYINDEX);
+	}
+
+	void ScriptVM::ReleaseEnvironment(int env)
+	{
+		if (!s_instance) return;
+		luaL_unref(s_instance->L, LUA_REGISTRYINDEX, env);
+	}
+
+	std::string ScriptVM::Run(int env, const char* path)
+	{
+		lua_State* L = s_instance->L;
+		int r = luaL_loadfile(L, path);
+		if (r == LUA_OK) {
+			// the first upvalue of a main chunk is its _ENV
+			lua_rawgeti(L, LUA_REGISTRYINDEX, env);
+			lua_setupvalue(L, -2, 1);
+			r = lua_pcall(L, 0, 0, 0);
+		}
+		if (r == LUA_OK) return "";
+		std::string error = lua_tostring(L, -1) ? lua_tostring(L, -1) : "Unknown error";
+		lua_pop(L, 1);
+		return error;
+	}
+
+	luabridge::LuaRef ScriptVM::Get(int env, const char* name)
+	{
+		lua_State* L = s_instance->L;
+		lua_rawgeti(L, LUA_REGISTRYINDEX, env);
+		if (!lua_istable(L, -1)) {
+			lua_pop(L, 1);
+			return luabridge::LuaRef(L);
+		}
+		lua_getfield(L, -1, name);
+		luabridge::LuaRef value = luabridge::LuaRef::fromStack(L);	// pops the value
+		lua_pop(L, 1);
+		return value;
+	}
+
+	int ScriptVM::ResolveFunction(int env, const char* name)
+	{
+		lua_State* L = s_instance->L;
+		lua_rawgeti(L, LUA_REGISTRYINDEX, env);
+		if (!lua_istable(L, -1)) {
+			lua_pop(L, 1);
+			return LUA_REFNIL;
+		}
+		lua_getfield(L, -1, name);
+		if (!lua_isfunction(L, -1)) {
+			lua_pop(L, 2);
+			return LUA_REFNIL;
+		}
+		int ref = luaL_ref(L, LUA_REGISTRYINDEX);
+		lua_pop(L, 1);
+		return ref;
+	}
+
+	void ScriptVM::ReleaseReference(int ref)
+	{
+		if (!s_instance) return;
+		luaL_unref(s_instance->L, LUA_REGISTRYINDEX, ref);
+	}
+
+	bool ScriptVM::pcall(int nargs, std::string& error)
+	{
+		lua_State* L = s_instance->L;
+		// stack: handler, function, args
+		int handler = lua_gettop(L) - nargs - 1;
+		int r = lua_pcall(L, nargs, 0, handler);
+		if (r != LUA_OK) {
+			error = lua_tostring(L, -1) ? lua_tostring(L, -1) : "Unknown error";
+			lua_pop(L, 1);
+		}
+		lua_pop(L, 1); // handler
+		return r == LUA_OK;
+	}
+
+	bool ScriptVM::Call(int function, std::string& error)
+	{
+		if (function == LUA_REFNIL || function == LUA_NOREF) return true;
+		lua_State* L = s_instance->L;
+		lua_pushcfunction(L, luaTraceback);
+		lua_rawgeti(L, LUA_REGISTRYINDEX, function);
+		return pcall(0, error);
+	}
+
+	bool ScriptVM::Call(int function, double arg, std::string& error)
+	{
+		if (function == LUA_REFNIL || function == LUA_NOREF) return true;
+		lua_State* L = s_instance->L;
+		lua_pushcfunction(L, luaTraceback);
+		lua_rawgeti(L, LUA_REGISTRYINDEX, function);
+		lua_pushnumber(L, arg);
+		return pcall(1, error);
+	}
+
+	void ScriptVM::Watch(int env, const char* name)
+	{
+		lua_State* L = s_instance->L;
+		lua_rawgeti(L, LUA_REGISTRYINDEX, env);
+		if (!lua_istable(L, -1) || !lua_getmetatable(L, -1)) {
+			lua_pop(L, 1);
+			return;
+		}
+		// stack: env, mt
+		// the first watch of an environment swaps its metatable handlers for the watching ones
+		if (lua_getfield(L, -1, "__watched") != LUA_TTABLE) {
+			lua_pop(L, 1);
+			lua_newtable(L);	// values
+			lua_newtable(L);	// names -> changed
+			lua_pushvalue(L, -2);
+			lua_setfield(L, -4, "__watched");
+			lua_pushvalue(L, -1);
+			lua_setfield(L, -4, "__changed");
+			lua_pushvalue(L, -2);
+			lua_pushcclosure(L, luaWatchedIndex, 1);
+			lua_setfield(L, -4, "__index");
+			lua_pushcclosure(L, luaWatchedNewIndex, 2);
+			lua_setfield(L, -2, "__newindex");
+			lua_getfield(L, -1, "__watched");
+		}
+		// stack: env, mt, values
+		lua_getfield(L, -2, "__changed");
+		// stack: env, mt, values, changed
+		lua_pushboolean(L, 1);
+		lua_setfield(L, -2, name);
+		// move the current value out of env, so later assignments go through __newindex
+		lua_pushstring(L, name);
+		if (lua_rawget(L, -5) != LUA_TNIL) {
+			lua_setfield(L, -3, name);
+			lua_pushnil(L);
+			lua_setfield(L, -5, name);
+		}
+		else lua_pop(L, 1);
+		lua_pop(L, 4);
+	}
+
+	bool ScriptVM::ConsumeChange(int env, const char* name)
+	{
+		lua_State* L = s_instance->L;
+		bool changed = false;
+		lua_rawgeti(L, LUA_REGISTRYINDEX, env);
+		if (lua_istable(L, -1) && lua_getmetatable(L, -1)) {
+			if (lua_getfield(L, -1, "__changed") == LUA_TTABLE) {
+				lua_getfield(L, -1, name);
+				changed = lua_toboolean(L, -1);
+				lua_pop(L, 1);
+				if (changed) {
+					lua_pushboolean(L, 0);
+					lua_setfield(L, -2, name);
+				}
+			}
+			lua_pop(L, 2);
+		}
+		lua_pop(L, 1);
+		return changed;
+	}
+
+	size_t ScriptVM::ConsumeAllocatedBytes()
+	{
+		size_t bytes = s_allocatedBytes;
+		s_allocatedBytes = 0;
+		return bytes;
+	}
+
+	size_t ScriptVM::GetMemoryUsage()
+	{
+		lua_State* L = s_instance->L;
+		return (size_t)lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+	}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+namespace Lobster
+{
+
+	//	The single Lua state shared by every Script. Engine bindings are registered once, when the VM is initialized.
+	//	Each script instance runs in its own environment table: its globals land there, and reads of anything
+	//	it did not define fall back to the shared globals (standard libraries and the Lobster namespace).
+	//	Only use it from the main thread.
+	class ScriptVM
+	{
+	private:
+		lua_State* L;
+		static ScriptVM* s_instance;
+		ScriptVM();
+		static bool pcall(int nargs, std::string& error);
+	public:
+		static void Initialize();
+		inline static lua_State* GetState() { return s_instance->L; }
+		//	Creates an empty environment and returns its registry reference.
+		static int NewEnvironment();
+		static void ReleaseEnvironment(int env);
+		//	Loads and runs a Lua file inside an environment. Returns the error message, or an empty string on success.
+		static std::string Run(int env, const char* path);
+		//	Returns the value of name as seen by code running in env.
+		static luabridge::LuaRef Get(int env, const char* name);
+		//	Returns a registry reference to the function called name in env, or LUA_REFNIL if there is no such function.
+		//	Resolve callbacks once (on load) and keep the reference, instead of looking them up by name every frame.
+		static int ResolveFunction(int env, const char* name);
+		static void ReleaseReference(int ref);
+		//	Calls a resolved function in protected mode, without exceptions. Calling LUA_REFNIL does nothing.
+		//	Returns false and fills error (with a traceback) if the function raised an error.
+		static bool Call(int function, std::string& error);
+		static bool Call(int function, double arg, std::string& error);
+		//	Starts observing assignments to name in env. Any assignment after this call, from Lua or C++, marks it as changed.
+		static void Watch(int env, const char* name);
+		//	Returns whether the watched name was assigned since the last call, and clears the flag.
+		static bool ConsumeChange(int env, const char* name);
+		//	Bytes allocated by Lua since the last call, i.e. future garbage collector work.
+		static size_t ConsumeAllocatedBytes();
+		//	Total memory used by the Lua state, in bytes.
+		static size_t GetMemoryUsage();
+	};
+
+}
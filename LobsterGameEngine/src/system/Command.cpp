@@ -43,6 +43,10 @@ namespace Lobster {
 		return act + m_object->GetName() + " to " + vect;
 	}
 
+	GameObject* TransformCommand::GetTarget() const {
+		return m_object;
+	}
+
 	TransformColliderCommand::TransformColliderCommand(Collider* collider, Transform t_original, Transform t_new) :
 		m_collider(collider),
 		m_original(t_original),
@@ -78,6 +82,10 @@ namespace Lobster {
 		return act + " a collider in " +  m_collider->GetPhysics()->GetOwner()->GetName() + " by " + vect;
 	}
 
+	GameObject* TransformColliderCommand::GetTarget() const {
+		return CommandTarget(m_collider);
+	}
+
 	DestroyObjectCommand::DestroyObjectCommand(GameObject* object, Scene* scene) :
 		m_object(object),
 		m_scene(scene),
@@ -178,6 +186,10 @@ namespace Lobster {
 		return "Destroyed " + m_object->GetName() + " inside " + m_parent->GetName();
 	}
 
+	GameObject* DestroyChildCommand::GetTarget() const {
+		return m_parent;
+	}
+
 	CreateChildCommand::CreateChildCommand(GameObject* object, GameObject* parent) :
 		m_object(object),
 		m_parent(parent),
@@ -210,6 +222,10 @@ namespace Lobster {
 		return "Created " + m_object->GetName() + " inside " + m_parent->GetName();
 	}
 
+	GameObject* CreateChildCommand::GetTarget() const {
+		return m_parent;
+	}
+
 	DestroyComponentCommand::DestroyComponentCommand(Component* component, GameObject* object) :
 		m_component(component),
 		m_object(object),
@@ -242,6 +258,10 @@ namespace Lobster {
 		return "Destroyed " + m_component->GetTypeName() + " in " + m_object->GetName();
 	}
 
+	GameObject* DestroyComponentCommand::GetTarget() const {
+		return m_object;
+	}
+
 	CreateComponentCommand::CreateComponentCommand(Component* component, GameObject* object) :
 		m_component(component),
 		m_object(object),
@@ -274,6 +294,10 @@ namespace Lobster {
 		return "Created " + m_component->GetTypeName() + " in " + m_object->GetName();
 	}
 
+	GameObject* CreateComponentCommand::GetTarget() const {
+		return m_object;
+	}
+
 	DestroyColliderCommand::DestroyColliderCommand(Collider* collider, PhysicsComponent* component) :
 		m_collider(collider),
 		m_component(component),
@@ -306,6 +330,10 @@ namespace Lobster {
 		return "Destroyed a collider in " + m_component->GetOwner()->GetName();
 	}
 
+	GameObject* DestroyColliderCommand::GetTarget() const {
+		return CommandTarget(m_component);
+	}
+
 	CreateColliderCommand::CreateColliderCommand(Collider* collider, PhysicsComponent* component) :
 		m_collider(collider),
 		m_component(component),
@@ -337,4 +365,8 @@ namespace Lobster {
 	std::string CreateColliderCommand::ToString() const {
 		return "Created a collider in " + m_component->GetOwner()->GetName();
 	}
+
+	GameObject* CreateColliderCommand::GetTarget() const {
+		return CommandTarget(m_component);
+	}
 }
@@ -10,6 +10,7 @@
 namespace Lobster {
 
     class GameObject;
+	class Material;
 
 	class Command {
 	public:
@@ -24,8 +25,18 @@ namespace Lobster {
 
 		//	Convert the command into a string.
 		virtual std::string ToString() const = 0;
+
+		//	The game object whose saved data is changed by this command, used for dirty tracking.
+		//	Commands that only change the root level of the scene return nullptr.
+		virtual GameObject* GetTarget() const { return nullptr; }
 	};
 
+	//	Resolve the owning game object of command subjects.
+	inline GameObject* CommandTarget(Component* component) { return component ? component->GetOwner() : nullptr; }
+	inline GameObject* CommandTarget(Collider* collider) { return collider && collider->GetPhysics() ? collider->GetPhysics()->GetOwner() : nullptr; }
+	//	Materials are saved to their own files, see MaterialLibrary::SaveDirty.
+	inline GameObject* CommandTarget(Material* material) { return nullptr; }
+
 	//	For all commands that are used to translate, rotate or scale a game object.
 	class TransformCommand : public Command {
 	public:
@@ -33,6 +44,7 @@ namespace Lobster {
 		void Exec() override;
 		void Undo() override;
 		std::string ToString() const override;
+		GameObject* GetTarget() const override;
 
 	private:
 		GameObject* m_object;
@@ -47,6 +59,7 @@ namespace Lobster {
 		void Exec() override;
 		void Undo() override;
 		std::string ToString() const override;
+		GameObject* GetTarget() const override;
 
 	private:
 		Collider* m_collider;
@@ -95,6 +108,7 @@ namespace Lobster {
 		void Exec() override;
 		void Undo() override;
 		std::string ToString() const override;
+		GameObject* GetTarget() const override;
 
 	private:
 		GameObject* m_object;
@@ -111,6 +125,7 @@ namespace Lobster {
 		void Exec() override;
 		void Undo() override;
 		std::string ToString() const override;
+		GameObject* GetTarget() const override;
 
 	private:
 		GameObject* m_object;
@@ -127,6 +142,7 @@ namespace Lobster {
 		void Exec() override;
 		void Undo() override;
 		std::string ToString() const override;
+		GameObject* GetTarget() const override;
 
 	private:
 		Component* m_component;
@@ -143,6 +159,7 @@ namespace Lobster {
 		void Exec() override;
 		void Undo() override;
 		std::string ToString() const override;
+		GameObject* GetTarget() const override;
 
 	private:
 		Component* m_component;
@@ -159,6 +176,7 @@ namespace Lobster {
 		void Exec() override;
 		void Undo() override;
 		std::string ToString() const override;
+		GameObject* GetTarget() const override;
 
 	private:
 		Collider* m_collider;
@@ -175,6 +193,7 @@ namespace Lobster {
 		void Exec() override;
 		void Undo() override;
 		std::string ToString() const override;
+		GameObject* GetTarget() const override;
 
 	private:
 		Collider* m_collider;
@@ -211,6 +230,10 @@ namespace Lobster {
 			return m_action;
 		}
 
+		GameObject* GetTarget() const override {
+			return CommandTarget(m_component);
+		}
+
 	private:
 		U* m_component;
 		T* m_prop;
@@ -247,6 +270,10 @@ namespace Lobster {
 			return m_action;
 		}
 
+		GameObject* GetTarget() const override {
+			return CommandTarget(m_component);
+		}
+
 	private:
 		U* m_component;
 		T* m_prop;
@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "FrameAllocator.h"
+
+namespace Lobster
+{
+
+	std::atomic<unsigned long long> FrameArena::s_frame(0);
+
+	void* FrameArena::Buffer::Allocate(size_t size, size_t alignment)
+	{
+		if (size == 0) size = 1;
+		while (current < blocks.size()) {
+			Block& block = blocks[current];
+			size_t start = (offset + alignment - 1) & ~(alignment - 1);
+			if (start + size <= block.size) {
+				offset = start + size;
+				used += size;
+				return block.data + start;
+			}
+			current++;
+			offset = 0;
+		}
+		//	Out of space, chain another block. Reset() folds the chain back into one block.
+		size_t blockSize = std::max(BlockSize, size + MaxAlignment);
+		blocks.push_back({ static_cast<byte*>(::operator new(blockSize)), blockSize });
+		current = blocks.size() - 1;
+		offset = size;
+		used += size;
+		return blocks.back().data;
+	}
+
+	void FrameArena::Buffer::Reset()
+	{
+		//	If the last frame needed several blocks, replace them with a single one large enough for all of it
+		if (blocks.size() > 1) {
+			size_t total = 0;
+			for (const Block& block : blocks) total += block.size;
+			Release();
+			blocks.push_back({ static_cast<byte*>(::operator new(total)), total });
+		}
+		current = 0;
+		offset = 0;
+		used = 0;
+	}
+
+	void FrameArena::Buffer::Release()
+	{
+		for (const Block& block : blocks) ::operator delete(block.data);
+		blocks.clear();
+		current = 0;
+		offset = 0;
+		used = 0;
+	}
+
+	FrameArena::~FrameArena()
+	{
+		m_buffers[0].Release();
+		m_buffers[1].Release();
+	}
+
+	FrameArena& FrameArena::local()
+	{
+		thread_local FrameArena arena;
+		return arena;
+	}
+
+	void FrameArena::sync()
+	{
+		unsigned long long frame = s_frame.load(std::memory_order_relaxed);
+		if (m_frame == frame) return;
+		//	The other buffer holds frame N - 1, which nobody may reference anymore
+		m_active ^= 1;
+		m_buffers[m_active].Reset();
+		//	If this thread skipped frames, what is in the buffer we just left is stale too
+		if (frame - m_frame > 1) m_buffers[m_active ^ 1].Reset();
+		m_frame = frame;
+	}
+
+	void* FrameArena::Allocate(size_t size, size_t alignment)
+	{
+		FrameArena& arena = local();
+		arena.sync();
+		return arena.m_buffers[arena.m_active].Allocate(size, std::max(alignment, (size_t)1));
+	}
+
+	void FrameArena::Free(void* ptr, size_t size)
+	{
+		if (!ptr) return;
+		FrameArena& arena = local();
+		arena.sync();
+		Buffer& buffer = arena.m_buffers[arena.m_active];
+		if (buffer.current >= buffer.blocks.size()) return;
+		byte* top = buffer.blocks[buffer.current].data + buffer.offset;
+		if (static_cast<byte*>(ptr) + size == top) {
+			buffer.offset -= size;
+			buffer.used -= size;
+		}
+	}
+
+	void FrameArena::NextFrame()
+	{
+		s_frame.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	size_t FrameArena::GetBytesUsed()
+	{
+		FrameArena& arena = local();
+		arena.sync();
+		return arena.m_buffers[arena.m_active].used;
+	}
+
+}
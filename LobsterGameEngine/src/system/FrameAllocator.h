@@ -0,0 +1,68 @@
+#pragma once
+
+namespace Lobster
+{
+
+	//	Linear (bump) allocator for data that only lives for the current frame, e.g. render queues or collision scratch lists.
+	//	Every thread owns its own arena, so allocation never takes a lock. Each arena is double-buffered:
+	//	memory handed out during frame N stays valid until the end of frame N + 1 and is recycled in frame N + 2.
+	//	Nothing is freed individually; call NextFrame() once per frame from the main thread instead.
+	//	Containers that outlive a frame must be recreated (not just cleared) every frame, see Renderer::ClearAllQueues().
+	class FrameArena
+	{
+	public:
+		static constexpr size_t BlockSize = 64 * 1024;
+		static constexpr size_t MaxAlignment = 16;
+	private:
+		struct Block
+		{
+			byte* data;
+			size_t size;
+		};
+		struct Buffer
+		{
+			std::vector<Block> blocks;
+			size_t current = 0;		// index of the block being filled
+			size_t offset = 0;		// fill level of the current block
+			size_t used = 0;		// bytes handed out since the last reset
+			void* Allocate(size_t size, size_t alignment);
+			void Reset();
+			void Release();
+		};
+		Buffer m_buffers[2];
+		int m_active = 0;
+		unsigned long long m_frame = 0;
+		static std::atomic<unsigned long long> s_frame;
+		static FrameArena& local();
+		void sync();
+		FrameArena() = default;
+	public:
+		~FrameArena();
+		//	Returns memory valid until the end of the next frame. Never returns nullptr.
+		static void* Allocate(size_t size, size_t alignment = MaxAlignment);
+		//	Gives back the memory if it is the last allocation of the calling thread (e.g. a vector growing), otherwise does nothing.
+		static void Free(void* ptr, size_t size);
+		//	Ends the current frame for all threads. Each arena recycles its older buffer on its next allocation.
+		static void NextFrame();
+		//	Bytes allocated by the calling thread during the current frame.
+		static size_t GetBytesUsed();
+	};
+
+	//	STL allocator adapter on top of FrameArena. All instances are interchangeable.
+	template <typename T>
+	struct FrameAllocator
+	{
+		typedef T value_type;
+		FrameAllocator() = default;
+		template <typename U> FrameAllocator(const FrameAllocator<U>&) {}
+		T* allocate(size_t n) { return static_cast<T*>(FrameArena::Allocate(n * sizeof(T), alignof(T))); }
+		void deallocate(T* ptr, size_t n) { FrameArena::Free(ptr, n * sizeof(T)); }
+		template <typename U> bool operator==(const FrameAllocator<U>&) const { return true; }
+		template <typename U> bool operator!=(const FrameAllocator<U>&) const { return false; }
+	};
+
+	template <typename T>
+	using FrameVector = std::vector<T, FrameAllocator<T>>;
+	typedef std::basic_string<char, std::char_traits<char>, FrameAllocator<char>> FrameString;
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+namespace Lobster
+{
+
+	//	A handle is a 64-bit id made of a slot index (low 32 bits) and a generation (high 32 bits).
+	//	The generation of a slot is bumped every time it is released, so stale handles never resolve to a recycled object.
+	//	A handle of 0 is never issued and means "no object".
+	typedef unsigned long long Handle;
+	static const Handle INVALID_HANDLE = 0;
+
+	//	O(1) mapping from handles to objects. Not thread-safe; only touch it from the main thread.
+	template <typename T>
+	class HandleTable
+	{
+	private:
+		struct Entry
+		{
+			T* object = nullptr;
+			uint generation = 1;
+		};
+		std::vector<Entry> m_entries;
+		std::vector<uint> m_freeList;
+		size_t m_count = 0;
+	public:
+		//	Returns a new handle referring to object.
+		Handle Insert(T* object)
+		{
+			uint index;
+			if (m_freeList.empty()) {
+				index = (uint)m_entries.size();
+				m_entries.emplace_back();
+			}
+			else {
+				index = m_freeList.back();
+				m_freeList.pop_back();
+			}
+			m_entries[index].object = object;
+			m_count++;
+			return MakeHandle(index, m_entries[index].generation);
+		}
+
+		//	Registers object under a specific handle, e.g. an id restored from a save file.
+		//	Returns INVALID_HANDLE if that slot is held by another object.
+		Handle InsertAt(T* object, Handle handle)
+		{
+			uint index = GetIndex(handle);
+			uint generation = GetGeneration(handle);
+			if (generation == 0) return INVALID_HANDLE;
+			if (index >= m_entries.size()) {
+				//	Every slot we skip over becomes free for later insertions
+				for (uint i = (uint)m_entries.size(); i < index; ++i) m_freeList.push_back(i);
+				m_entries.resize((size_t)index + 1);
+			}
+			else if (m_entries[index].object) {
+				return INVALID_HANDLE;
+			}
+			else {
+				auto it = std::find(m_freeList.begin(), m_freeList.end(), index);
+				if (it != m_freeList.end()) {
+					*it = m_freeList.back();
+					m_freeList.pop_back();
+				}
+			}
+			m_entries[index].object = object;
+			m_entries[index].generation = generation;
+			m_count++;
+			return handle;
+		}
+
+		//	Releases the slot of handle. Does nothing if handle is already stale.
+		void Remove(Handle handle)
+		{
+			uint index = GetIndex(handle);
+			if (index >= m_entries.size()) return;
+			Entry& entry = m_entries[index];
+			if (!entry.object || entry.generation != GetGeneration(handle)) return;
+			entry.object = nullptr;
+			if (++entry.generation == 0) entry.generation = 1;
+			m_freeList.push_back(index);
+			m_count--;
+		}
+
+		//	Returns the object of handle, or nullptr if the handle is stale or invalid.
+		T* Get(Handle handle) const
+		{
+			uint index = GetIndex(handle);
+			if (index >= m_entries.size()) return nullptr;
+			const Entry& entry = m_entries[index];
+			return entry.generation == GetGeneration(handle) ? entry.object : nullptr;
+		}
+
+		inline size_t Size() const { return m_count; }
+		inline size_t Capacity() const { return m_entries.size(); }
+
+		static inline Handle MakeHandle(uint index, uint generation) { return ((Handle)generation << 32) | index; }
+		static inline uint GetIndex(Handle handle) { return (uint)(handle & 0xFFFFFFFFull); }
+		static inline uint GetGeneration(Handle handle) { return (uint)(handle >> 32); }
+	};
+
+}
@@ -1,45 +1,96 @@
 #include "pch.h"
 #include "Input.h"
-#include "events/EventCallback.h"
-#include "events/EventDispatcher.h"
+#include "Application.h"
 
 namespace Lobster
 {
 	bool Input::m_locked = false;
-	glm::vec2 Input::m_lastScroll = { 0.0f, 0.0f };
 	glm::vec2 Input::m_lastMouse = { 0.0f, 0.0f };
-	glm::vec2 Input::m_mouseDelta = { 0.0f, 0.0f };
+	InputSnapshot Input::s_current;
+	InputSnapshot Input::s_pending;
+	InputSnapshot Input::s_previous;
+	double Input::s_frameStart = 0.0;
+	bool Input::b_recording = false;
+	std::vector<InputSnapshot> Input::s_recording;
+	std::vector<InputSnapshot> Input::s_replay;
+	size_t Input::s_replayFrame = 0;
 
 	void Input::Initialize()
 	{
-		EventDispatcher::AddCallback(EVENT_MOUSE_SCROLLED, new EventCallback<MouseScrolledEvent>([](MouseScrolledEvent* e) {
-			m_lastScroll.x = e->dx;
-			m_lastScroll.y = e->dy;
-		}));
+		s_current = s_pending = s_previous = InputSnapshot();
 	}
 
 	void Input::Update()
 	{
-		glfwPollEvents();
+		s_previous = s_current;
+		s_pending.keysPressed.reset();
+		s_pending.keysReleased.reset();
+		s_pending.buttonsPressed.reset();
+		s_pending.buttonsReleased.reset();
+		s_pending.transitions.clear();
+		s_pending.scroll = glm::vec2(0.0f, 0.0f);
 
-		// reset scroll
-		m_lastScroll = glm::vec2(0.0f, 0.0f);		
+		// headless runs have no window, their input is empty unless replayed
+		Window* window = Application::GetInstance()->GetWindow();
+		if (window) {
+			// callbacks fill s_pending
+			glfwPollEvents();
 
-		// calculate mouse delta
-		double x, y;
-		glfwGetCursorPos(Application::GetInstance()->GetWindow()->GetPtr(), &x, &y);
-		m_mouseDelta = glm::vec2(x, y) - m_lastMouse;
-		m_lastMouse = glm::vec2(x, y);
+			// calculate mouse delta
+			double x, y;
+			glfwGetCursorPos(window->GetPtr(), &x, &y);
+			s_pending.mouse = glm::vec2(x, y);
+			s_pending.mouseDelta = glm::vec2(x, y) - m_lastMouse;
+			m_lastMouse = glm::vec2(x, y);
 
-		// handle lock
-		if (m_locked) {
-			glfwSetCursorPos(Application::GetInstance()->GetWindow()->GetPtr(), 0, 0);
-			m_lastMouse = glm::vec2(0, 0);
+			// handle lock
+			if (m_locked) {
+				glfwSetCursorPos(window->GetPtr(), 0, 0);
+				m_lastMouse = glm::vec2(0, 0);
+			}
+			s_frameStart = glfwGetTime();
 		}
+
+		// a replay overrides the live input, which is still polled to keep the window responsive
+		if (IsReplaying()) s_current = s_replay[s_replayFrame++];
+		else s_current = s_pending;
+		if (b_recording) s_recording.push_back(s_current);
+	}
+
+	void Input::recordTransition(int code, bool mouse, bool down)
+	{
+		// GLFW reports events when they are polled, so this is the time since the last poll at most
+		s_pending.transitions.push_back({ (glfwGetTime() - s_frameStart) * 1000.0, code, mouse, down });
+	}
+
+	void Input::OnKey(int key, int action)
+	{
+		if (key < 0 || key > GLFW_KEY_LAST || action == GLFW_REPEAT) return;
+		bool down = action == GLFW_PRESS;
+		s_pending.keys[key] = down;
+		if (down) s_pending.keysPressed[key] = true;
+		else s_pending.keysReleased[key] = true;
+		recordTransition(key, false, down);
+	}
+
+	void Input::OnMouseButton(int button, int action)
+	{
+		if (button < 0 || button > GLFW_MOUSE_BUTTON_LAST || action == GLFW_REPEAT) return;
+		bool down = action == GLFW_PRESS;
+		s_pending.buttons[button] = down;
+		if (down) s_pending.buttonsPressed[button] = true;
+		else s_pending.buttonsReleased[button] = true;
+		recordTransition(button, true, down);
+	}
+
+	void Input::OnScroll(double dx, double dy)
+	{
+		s_pending.scroll += glm::vec2(dx, dy);
 	}
 
 	void Input::LockCursor() {
-		glfwSetCursorPos(Application::GetInstance()->GetWindow()->GetPtr(), 0, 0);
+		Window* window = Application::GetInstance()->GetWindow();
+		if (window) glfwSetCursorPos(window->GetPtr(), 0, 0);
 		m_lastMouse = glm::vec2(0, 0);
 		m_locked = true;
 	}
@@ -56,50 +107,58 @@ namespace Lobster
 
 	bool Input::IsKeyUp(int key)
 	{
-		GLFWwindow* window = Application::GetInstance()->GetWindow()->GetPtr();
-		int state = glfwGetKey(window, key);
-		return state == GLFW_RELEASE;
+		return key < 0 || key > GLFW_KEY_LAST || !s_current.keys[key];
 	}
 
 	bool Input::IsKeyDown(int key)
 	{
-		GLFWwindow* window = Application::GetInstance()->GetWindow()->GetPtr();
-		int state = glfwGetKey(window, key);
-		return state == GLFW_PRESS;
+		return key >= 0 && key <= GLFW_KEY_LAST && s_current.keys[key];
 	}
 
 	bool Input::IsKeyHold(int key)
 	{
-		GLFWwindow* window = Application::GetInstance()->GetWindow()->GetPtr();
-		int state = glfwGetKey(window, key);
-		return state == GLFW_REPEAT;
+		return IsKeyDown(key) && s_previous.keys[key];
+	}
+
+	bool Input::IsKeyPressed(int key)
+	{
+		return key >= 0 && key <= GLFW_KEY_LAST && s_current.keysPressed[key];
+	}
+
+	bool Input::IsKeyReleased(int key)
+	{
+		return key >= 0 && key <= GLFW_KEY_LAST && s_current.keysReleased[key];
 	}
 
 	bool Input::IsMouseUp(int button)
 	{
-		GLFWwindow* window = Application::GetInstance()->GetWindow()->GetPtr();
-		int state = glfwGetMouseButton(window, button);
-		return state == GLFW_RELEASE;
+		return button < 0 || button > GLFW_MOUSE_BUTTON_LAST || !s_current.buttons[button];
 	}
 
 	bool Input::IsMouseDown(int button)
 	{
-		GLFWwindow* window = Application::GetInstance()->GetWindow()->GetPtr();
-		int state = glfwGetMouseButton(window, button);
-		return state == GLFW_PRESS;
+		return button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST && s_current.buttons[button];
 	}
 
 	bool Input::IsMouseHold(int button)
 	{
-		GLFWwindow* window = Application::GetInstance()->GetWindow()->GetPtr();
-		int state = glfwGetMouseButton(window, button);
-		return state == GLFW_REPEAT;
+		return IsMouseDown(button) && s_previous.buttons[button];
+	}
+
+	bool Input::IsMousePressed(int button)
+	{
+		return button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST && s_current.buttonsPressed[button];
+	}
+
+	bool Input::IsMouseReleased(int button)
+	{
+		return button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST && s_current.buttonsReleased[button];
 	}
 
 	void Input::GetMousePos(double& x, double& y)
 	{
-		GLFWwindow* window = Application::GetInstance()->GetWindow()->GetPtr();
-		glfwGetCursorPos(window, &x, &y);
+		x = s_current.mouse.x;
+		y = s_current.mouse.y;
 		// non-game mode: calculate the position to that of the game window
 		#if LOBSTER_BUILD_DEBUG
 		{
@@ -122,34 +181,41 @@ namespace Lobster
 	}
 
 	void Input::GetWindowPos(int* x, int* y) {
-		GLFWwindow* window = Application::GetInstance()->GetWindow()->GetPtr();
-		glfwGetWindowPos(window, x, y);
+		Window* window = Application::GetInstance()->GetWindow();
+		if (window) glfwGetWindowPos(window->GetPtr(), x, y);
+		else *x = *y = 0;
 	}
 
 	void Input::GetWindowSize(int* x, int* y) {
-		GLFWwindow* window = Application::GetInstance()->GetWindow()->GetPtr();
-		glfwGetWindowSize(window, x, y);
+		Window* window = Application::GetInstance()->GetWindow();
+		if (window) glfwGetWindowSize(window->GetPtr(), x, y);
+		else {
+			glm::ivec2 size = Application::GetInstance()->GetWindowSize();
+			*x = size.x;
+			*y = size.y;
+		}
 	}
 
 	// Modified version from ImGuizmo::ComputeCameraRay()	
 	void Input::ComputeCameraRay(glm::mat4 view, glm::mat4 proj, glm::vec3& origin, glm::vec3& direction,
 		glm::vec2 window_pos, glm::vec2 window_size)
 	{
-		ImGuiIO& io = ImGui::GetIO();
+		// the snapshot keeps the cursor relative to the glfw window, the window pos and size are in screen
+		// coordinates like the ImGui ones; there is no ImGui context (nor window) when running headless
+		int wx, wy;
+		GetWindowPos(&wx, &wy);
+		glm::vec2 mouse = s_current.mouse + glm::vec2(wx, wy);
 		// if window pos and window size are not input, default to be the size and position of the glfw window
 		if (window_pos[0] < 0 || window_pos[1] < 0) {
-			int wx, wy;
-			GetWindowPos(&wx, &wy);
 			window_pos = glm::vec2(wx, wy);
 		}
 		if (window_size[0] < 0 || window_size[1] < 0) {
-			int wx, wy;
 			GetWindowSize(&wx, &wy);
 			window_size = glm::vec2(wx, wy);
 		}
 		glm::mat4 viewProjInv = glm::inverse(proj * view);
-		float mox = ((io.MousePos.x - window_pos.x) / window_size.x) * 2.f - 1.f;
-		float moy = (1.f - ((io.MousePos.y - window_pos.y) / window_size.y)) * 2.f - 1.f;
+		float mox = ((mouse.x - window_pos.x) / window_size.x) * 2.f - 1.f;
+		float moy = (1.f - ((mouse.y - window_pos.y) / window_size.y)) * 2.f - 1.f;
 
 		glm::vec4 rayOrigin = viewProjInv * glm::vec4(mox, moy, 0.f, 1.f);
 		rayOrigin /= rayOrigin.w;
@@ -160,24 +226,71 @@ namespace Lobster
 	}
 
 	double Input::GetMousePosX() {
-		GLFWwindow* window = Application::GetInstance()->GetWindow()->GetPtr();
-		double x, y;
-		glfwGetCursorPos(window, &x, &y);
-		return x;
+		return s_current.mouse.x;
 	}
 
 	double Input::GetMousePosY() {
-		GLFWwindow* window = Application::GetInstance()->GetWindow()->GetPtr();
-		double x, y;
-		glfwGetCursorPos(window, &x, &y);
-		return y;
+		return s_current.mouse.y;
 	}
 
 	double Input::GetMouseDeltaX() {
-		return m_mouseDelta.x;
+		return s_current.mouseDelta.x;
 	}
 
 	double Input::GetMouseDeltaY() {
-		return m_mouseDelta.y;
+		return s_current.mouseDelta.y;
+	}
+
+	void Input::StartRecording()
+	{
+		s_recording.clear();
+		b_recording = true;
+	}
+
+	bool Input::StopRecording(const std::string& path)
+	{
+		b_recording = false;
+		try {
+			std::ofstream file(path, std::ios::binary);
+			cereal::BinaryOutputArchive oarchive(file);
+			oarchive(s_recording);
+		}
+		catch (std::exception& e) {
+			WARN("Failed to write input recording {}: {}", path, e.what());
+			return false;
+		}
+		LOG("Recorded {} frames of input to {}", s_recording.size(), path);
+		s_recording.clear();
+		return true;
+	}
+
+	bool Input::StartReplay(const std::string& path)
+	{
+		s_replay.clear();
+		s_replayFrame = 0;
+		try {
+			std::ifstream file(path, std::ios::binary);
+			if (!file.is_open()) throw std::runtime_error("cannot open file");
+			cereal::BinaryInputArchive iarchive(file);
+			iarchive(s_replay);
+		}
+		catch (std::exception& e) {
+			WARN("Failed to read input recording {}: {}", path, e.what());
+			s_replay.clear();
+			return false;
+		}
+		return true;
+	}
+
+	void Input::StartReplay(std::vector<InputSnapshot> frames)
+	{
+		s_replay = std::move(frames);
+		s_replayFrame = 0;
+	}
+
+	void Input::StopReplay()
+	{
+		s_replay.clear();
+		s_replayFrame = 0;
 	}
 }
@@ -4,29 +4,80 @@
 
 namespace Lobster
 {
-    
+
+	//	One key or mouse button change, in the order GLFW reported it.
+	struct InputTransition
+	{
+		double time;	// ms since the start of the frame
+		int code;		// key or mouse button
+		bool mouse;
+		bool down;
+		template <class Archive>
+		void serialize(Archive& ar)
+		{
+			ar(time, code, mouse, down);
+		}
+	};
+
+	//	The input state of one frame, filled from the GLFW callbacks. All Input queries read from it.
+	//	Pressed / released bits are kept for the whole frame, so a tap shorter than a frame is not lost.
+	struct InputSnapshot
+	{
+		std::bitset<GLFW_KEY_LAST + 1> keys;		// down at the end of the frame
+		std::bitset<GLFW_KEY_LAST + 1> keysPressed;
+		std::bitset<GLFW_KEY_LAST + 1> keysReleased;
+		std::bitset<GLFW_MOUSE_BUTTON_LAST + 1> buttons;
+		std::bitset<GLFW_MOUSE_BUTTON_LAST + 1> buttonsPressed;
+		std::bitset<GLFW_MOUSE_BUTTON_LAST + 1> buttonsReleased;
+		glm::vec2 mouse = glm::vec2(0.0f);
+		glm::vec2 mouseDelta = glm::vec2(0.0f);
+		glm::vec2 scroll = glm::vec2(0.0f);
+		std::vector<InputTransition> transitions;
+		template <class Archive>
+		void serialize(Archive& ar)
+		{
+			ar(keys, keysPressed, keysReleased, buttons, buttonsPressed, buttonsReleased, mouse, mouseDelta, scroll, transitions);
+		}
+	};
+
 	//	This class is for input polling, both keyboard input and mouse input.
 	//	This class has a static interface, you may call it from anywhere.
+	//	Snapshots can be recorded to a file and replayed later in place of the live input, frame by frame.
     class Input
     {
     private:
 		static bool m_locked;
-        static glm::vec2 m_lastScroll;
 		static glm::vec2 m_lastMouse;
-		static glm::vec2 m_mouseDelta;
+		static InputSnapshot s_current;		// what the queries see
+		static InputSnapshot s_pending;		// being filled by the callbacks for the next frame
+		static InputSnapshot s_previous;
+		static double s_frameStart;			// GLFW time in seconds
+		static bool b_recording;
+		static std::vector<InputSnapshot> s_recording;
+		static std::vector<InputSnapshot> s_replay;
+		static size_t s_replayFrame;
+		static void recordTransition(int code, bool mouse, bool down);
     public:
         //  Interface
 		static void Initialize();
 		static void Update();
+		//	Called by the window callbacks.
+		static void OnKey(int key, int action);
+		static void OnMouseButton(int button, int action);
+		static void OnScroll(double dx, double dy);
 		static void LockCursor();
 		static void UnlockCursor();
 		static bool InsideWindow(const glm::vec2& mouse, const glm::vec2& pos, const glm::vec2& size);
 		static bool IsKeyUp(int key);
 		static bool IsKeyDown(int key);
-		static bool IsKeyHold(int key);
+		static bool IsKeyHold(int key);		// down for more than this frame
+		static bool IsKeyPressed(int key);	// went down during this frame
+		static bool IsKeyReleased(int key);	// went up during this frame
 		static bool IsMouseUp(int button);
 		static bool IsMouseDown(int button);
-		static bool IsMouseHold(int button);		
+		static bool IsMouseHold(int button);
+		static bool IsMousePressed(int button);
+		static bool IsMouseReleased(int button);
 		static void GetMousePos(double& x, double& y);
 		static void GetWindowPos(int* x, int* y);
 		static void GetWindowSize(int* x , int* y);
@@ -36,8 +87,17 @@ namespace Lobster
 		static double GetMousePosY();
 		static double GetMouseDeltaX();
 		static double GetMouseDeltaY();
-		inline static glm::vec2 GetLastScroll() { return m_lastScroll; }
-		inline static glm::vec2 GetMouseDelta() { return m_mouseDelta; }
+		inline static glm::vec2 GetLastScroll() { return s_current.scroll; }
+		inline static glm::vec2 GetMouseDelta() { return s_current.mouseDelta; }
+		inline static const InputSnapshot& GetSnapshot() { return s_current; }
+		//	Record / replay
+		static void StartRecording();
+		static bool StopRecording(const std::string& path);
+		static bool StartReplay(const std::string& path);
+		static void StartReplay(std::vector<InputSnapshot> frames);
+		static void StopReplay();
+		inline static bool IsRecording() { return b_recording; }
+		inline static bool IsReplaying() { return s_replayFrame < s_replay.size(); }
     };
-    
+
 }
@@ -0,0 +1,150 @@
+#include "pch.h"
+#include "MemoryTracker.h"
+
+namespace Lobster
+{
+
+	//	Header placed in front of every tracked block. 16 bytes, so the returned pointer keeps malloc's alignment.
+	struct AllocationHeader
+	{
+		size_t size;
+		size_t tag;
+	};
+	static_assert(sizeof(AllocationHeader) == 16, "AllocationHeader must preserve 16 byte alignment");
+
+	MemoryTracker::TagStats MemoryTracker::s_stats[MEMORY_TAG_COUNT] = {};
+	thread_local MemoryTag MemoryTracker::s_currentTag = MEMORY_GENERAL;
+	std::atomic<size_t> MemoryTracker::s_allocCount(0);
+	std::atomic<size_t> MemoryTracker::s_freeCount(0);
+
+	void* TrackedAllocate(size_t size)
+	{
+		AllocationHeader* header = static_cast<AllocationHeader*>(malloc(sizeof(AllocationHeader) + size));
+		if (!header) return nullptr;
+		MemoryTag tag = MemoryTracker::s_currentTag;
+		header->size = size;
+		header->tag = tag;
+		MemoryTracker::record(tag, (long long)size);
+		MemoryTracker::s_stats[tag].count.fetch_add(1, std::memory_order_relaxed);
+		MemoryTracker::s_allocCount.fetch_add(1, std::memory_order_relaxed);
+		return header + 1;
+	}
+
+	void TrackedFree(void* ptr)
+	{
+		if (!ptr) return;
+		AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+		MemoryTracker::record((MemoryTag)header->tag, -(long long)header->size);
+		MemoryTracker::s_freeCount.fetch_add(1, std::memory_order_relaxed);
+		free(header);
+	}
+
+	void MemoryTracker::record(MemoryTag tag, long long bytes)
+	{
+		TagStats& stats = s_stats[tag];
+		long long live = stats.live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		long long peak = stats.peak.load(std::memory_order_relaxed);
+		while (live > peak && !stats.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+	}
+
+	const char* MemoryTracker::GetTagName(MemoryTag tag)
+	{
+		static const char* names[] = { "General", "Texture", "Mesh", "Material", "Script", "Audio", "Scene" };
+		return tag < MEMORY_TAG_COUNT ? names[tag] : "Unknown";
+	}
+
+	void MemoryTracker::TrackExternal(MemoryTag tag, long long bytes)
+	{
+		record(tag, bytes);
+		if (bytes > 0) s_stats[tag].count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void MemoryTracker::Update()
+	{
+		for (uint i = 0; i < MEMORY_TAG_COUNT; ++i) {
+			TagStats& stats = s_stats[i];
+			if (stats.budget <= 0) continue;
+			bool overBudget = GetLiveBytes((MemoryTag)i) > stats.budget;
+			//	Only warn when crossing the budget, not every frame
+			if (overBudget && !stats.b_overBudget) {
+				WARN("{} memory is over budget: {:.1f} MB used, {:.1f} MB allowed.", GetTagName((MemoryTag)i),
+					GetLiveBytes((MemoryTag)i) / 1048576.0, stats.budget / 1048576.0);
+			}
+			stats.b_overBudget = overBudget;
+		}
+	}
+
+	void MemoryTracker::Dump(const char* path)
+	{
+		std::stringstream ss;
+		ss << "tag,live_bytes,peak_bytes,alloc_count,budget_bytes\n";
+		for (uint i = 0; i < MEMORY_TAG_COUNT; ++i) {
+			MemoryTag tag = (MemoryTag)i;
+			ss << GetTagName(tag) << "," << GetLiveBytes(tag) << "," << GetPeakBytes(tag) << "," << GetAllocCount(tag) << "," << GetBudget(tag) << "\n";
+		}
+		FileSystem::WriteStringStream(path, ss);
+		INFO("Memory stats written to {}", path);
+	}
+
+	void MemoryTracker::ConsumeChurn(size_t& allocs, size_t& frees)
+	{
+		allocs = s_allocCount.exchange(0, std::memory_order_relaxed);
+		frees = s_freeCount.exchange(0, std::memory_order_relaxed);
+	}
+
+}
+
+//	Replacements of the global allocation functions. The aligned variants are left to the standard library.
+void* operator new(size_t size)
+{
+	void* ptr = Lobster::TrackedAllocate(size);
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](size_t size)
+{
+	void* ptr = Lobster::TrackedAllocate(size);
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return Lobster::TrackedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return Lobster::TrackedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	Lobster::TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	Lobster::TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	Lobster::TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	Lobster::TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	Lobster::TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	Lobster::TrackedFree(ptr);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+namespace Lobster
+{
+
+	//	Subsystems memory is accounted to. Allocations made outside of any MemoryScope go to MEMORY_GENERAL.
+	enum MemoryTag : uint
+	{
+		MEMORY_GENERAL,
+		MEMORY_TEXTURE,
+		MEMORY_MESH,
+		MEMORY_MATERIAL,
+		MEMORY_SCRIPT,
+		MEMORY_AUDIO,
+		MEMORY_SCENE,
+		MEMORY_TAG_COUNT
+	};
+
+	//	Tracks every allocation made through the global operator new / delete, which are replaced in MemoryTracker.cpp.
+	//	Each block carries a small header with its size and tag, so live bytes, peak bytes and allocation counts are known per tag.
+	//	Memory that does not go through operator new (Lua states, GPU resources) can be reported with TrackExternal().
+	//	Counters are atomic, so allocations from worker threads are included.
+	class MemoryTracker
+	{
+		friend class MemoryScope;
+		friend void* TrackedAllocate(size_t size);
+		friend void TrackedFree(void* ptr);
+	private:
+		struct TagStats
+		{
+			std::atomic<long long> live;
+			std::atomic<long long> peak;
+			std::atomic<size_t> count;
+			long long budget;
+			bool b_overBudget;
+		};
+		static TagStats s_stats[MEMORY_TAG_COUNT];
+		static thread_local MemoryTag s_currentTag;
+		static std::atomic<size_t> s_allocCount;
+		static std::atomic<size_t> s_freeCount;
+		static void record(MemoryTag tag, long long bytes);
+	public:
+		static const char* GetTagName(MemoryTag tag);
+		inline static long long GetLiveBytes(MemoryTag tag) { return s_stats[tag].live.load(std::memory_order_relaxed); }
+		inline static long long GetPeakBytes(MemoryTag tag) { return s_stats[tag].peak.load(std::memory_order_relaxed); }
+		inline static size_t GetAllocCount(MemoryTag tag) { return s_stats[tag].count.load(std::memory_order_relaxed); }
+		inline static long long GetBudget(MemoryTag tag) { return s_stats[tag].budget; }
+		//	Sets the number of live bytes above which a warning is raised. 0 means no budget.
+		inline static void SetBudget(MemoryTag tag, long long bytes) { s_stats[tag].budget = bytes; }
+		//	Accounts memory allocated outside of operator new. Pass a negative size when it is released.
+		static void TrackExternal(MemoryTag tag, long long bytes);
+		//	Checks budgets; called once per frame. Warnings are raised here rather than inside operator new.
+		static void Update();
+		//	Writes the stats of every tag to a text file.
+		static void Dump(const char* path);
+		//	Returns the number of heap allocations and deallocations since the last call, then resets both counters.
+		static void ConsumeChurn(size_t& allocs, size_t& frees);
+	};
+
+	//	Accounts all allocations of the current thread to a tag until the scope ends. Scopes can nest.
+	class MemoryScope
+	{
+	private:
+		MemoryTag m_previousTag;
+	public:
+		MemoryScope(MemoryTag tag) : m_previousTag(MemoryTracker::s_currentTag) { MemoryTracker::s_currentTag = tag; }
+		~MemoryScope() { MemoryTracker::s_currentTag = m_previousTag; }
+		MemoryScope(const MemoryScope&) = delete;
+		MemoryScope& operator=(const MemoryScope&) = delete;
+	};
+
+}
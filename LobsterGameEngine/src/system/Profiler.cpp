@@ -20,10 +20,71 @@ namespace Lobster
 		s_instance = new Profiler;
 	}
 
-	void Profiler::SubmitData(const std::string & name, double data)
+	void Profiler::SubmitData(const char* name, double data)
 	{
-		s_instance->m_profilerData[name] = data;
+		auto it = s_instance->m_profilerData.find(name);
+		if (it != s_instance->m_profilerData.end()) it->second = data;
+		else s_instance->m_profilerData.emplace(name, data);
 		s_instance->m_cumulativeTime = 0.0;
 	}
 
+	void Profiler::SubmitCounter(const char* name, double value)
+	{
+		auto it = s_instance->m_profilerCounters.find(name);
+		if (it != s_instance->m_profilerCounters.end()) it->second = value;
+		else s_instance->m_profilerCounters.emplace(name, value);
+	}
+
+	void Profiler::StartRecording()
+	{
+		s_instance->b_recording = true;
+		s_instance->m_recordColumns.clear();
+		s_instance->m_recordRows.clear();
+	}
+
+	void Profiler::RecordFrame()
+	{
+		if (!s_instance->b_recording) return;
+		auto& columns = s_instance->m_recordColumns;
+		std::vector<double> row(columns.size(), std::numeric_limits<double>::quiet_NaN());
+		auto record = [&](const std::string& name, double value) {
+			auto it = columns.find(name);
+			if (it == columns.end()) {
+				it = columns.emplace(name, columns.size()).first;
+				row.push_back(0.0);
+			}
+			row[it->second] = value;
+		};
+		for (const auto& [name, value] : s_instance->m_profilerData) record(name + " [ms]", value);
+		for (const auto& [name, value] : s_instance->m_profilerCounters) record(name, value);
+		s_instance->m_recordRows.push_back(std::move(row));
+	}
+
+	bool Profiler::WriteRecording(const char* path)
+	{
+		std::ofstream file(path);
+		if (!file.is_open()) {
+			WARN("Unable to write profiler recording to {}", path);
+			return false;
+		}
+		const auto& columns = s_instance->m_recordColumns;
+		std::vector<const std::string*> names(columns.size());
+		for (const auto& [name, index] : columns) names[index] = &name;
+		file << "frame";
+		for (const std::string* name : names) file << "," << *name;
+		file << "\n";
+		for (size_t frame = 0; frame < s_instance->m_recordRows.size(); frame++) {
+			const std::vector<double>& row = s_instance->m_recordRows[frame];
+			file << frame;
+			// columns first seen in a later frame are left empty in earlier rows
+			for (size_t i = 0; i < names.size(); i++) {
+				file << ",";
+				if (i < row.size() && !std::isnan(row[i])) file << row[i];
+			}
+			file << "\n";
+		}
+		LOG("Wrote {} frames of profiler data to {}", s_instance->m_recordRows.size(), path);
+		return true;
+	}
+
 }
@@ -11,12 +11,25 @@ namespace Lobster
 		double m_interval;
 		double m_cumulativeTime;
 		Timer m_timer;
-		std::map<std::string, double> m_profilerData;
+		//	Transparent comparators, so submitting with a string literal does not build a std::string every frame.
+		std::map<std::string, double, std::less<>> m_profilerData;
+		//	Unitless values (counts, bytes) shown below the timings.
+		std::map<std::string, double, std::less<>> m_profilerCounters;
+		//	Per-frame recording, one row per frame and one column per timing / counter name.
+		bool b_recording = false;
+		std::map<std::string, size_t, std::less<>> m_recordColumns;
+		std::vector<std::vector<double>> m_recordRows;
 		static Profiler* s_instance;
 	public:
 		Profiler();
 		static void Initialize();
-		static void SubmitData(const std::string& name, double data);
+		static void SubmitData(const char* name, double data);
+		static void SubmitCounter(const char* name, double value);
+		static void StartRecording();
+		//	Appends the current timings and counters as one row, if recording. Call once at the end of every frame.
+		static void RecordFrame();
+		//	Writes the recording as CSV. Timing columns are suffixed with " [ms]".
+		static bool WriteRecording(const char* path);
 	};
 
 }
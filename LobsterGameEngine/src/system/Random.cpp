@@ -0,0 +1,42 @@
+#include "pch.h"
+#include "Random.h"
+
+namespace Lobster
+{
+
+	Random Random::s_streams[RANDOM_STREAM_COUNT];
+	unsigned long long Random::s_seed = 0;
+
+	Random::Random(unsigned long long seed, unsigned long long sequence)
+	{
+		Seed(seed, sequence);
+	}
+
+	void Random::Seed(unsigned long long seed, unsigned long long sequence)
+	{
+		m_state = 0;
+		m_increment = (sequence << 1) | 1;	// must be odd
+		Next();
+		m_state += seed;
+		Next();
+	}
+
+	uint Random::Next()
+	{
+		unsigned long long state = m_state;
+		m_state = state * 6364136223846793005ULL + m_increment;
+		uint xorshifted = (uint)(((state >> 18) ^ state) >> 27);
+		uint rotation = (uint)(state >> 59);
+		return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+	}
+
+	void Random::SetSeed(unsigned long long seed)
+	{
+		s_seed = seed;
+		for (int i = 0; i < RANDOM_STREAM_COUNT; i++) {
+			s_streams[i].Seed(seed, i);
+		}
+		srand((unsigned int)seed);
+	}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+namespace Lobster
+{
+
+	//	One stream per system that needs randomness, so extra draws in one system never shift the sequence of another.
+	enum RandomStream
+	{
+		RANDOM_DEFAULT,
+		RANDOM_PARTICLES,
+		RANDOM_STREAM_COUNT
+	};
+
+	//	Small, fast and seedable random number generator (PCG32).
+	//	The same seed gives the same sequence on every machine and build, which replays rely on.
+	class Random
+	{
+	private:
+		unsigned long long m_state;
+		unsigned long long m_increment;
+		static Random s_streams[RANDOM_STREAM_COUNT];
+		static unsigned long long s_seed;
+	public:
+		Random(unsigned long long seed = 0, unsigned long long sequence = 0);
+		void Seed(unsigned long long seed, unsigned long long sequence = 0);
+		uint Next();
+		inline float NextFloat() { return (Next() >> 8) * (1.0f / 16777216.0f); }	// [0, 1)
+		inline float Range(float min, float max) { return min + (max - min) * NextFloat(); }
+		//	Restarts every stream from seed. Also seeds the C library rand(), which Lua's math.random uses.
+		static void SetSeed(unsigned long long seed);
+		inline static unsigned long long GetSeed() { return s_seed; }
+		inline static Random& Stream(RandomStream stream) { return s_streams[stream]; }
+	};
+
+}
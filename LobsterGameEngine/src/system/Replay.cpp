@@ -0,0 +1,147 @@
+#include "pch.h"
+#include "Replay.h"
+
+namespace Lobster
+{
+
+	bool Replay::b_capturing = false;
+	bool Replay::b_skipFrame = false;
+	ReplayData Replay::s_capture;
+	ReplayData Replay::s_playback;
+
+	void Replay::StartCapture(const std::string& scene, unsigned long long seed, bool midFrame)
+	{
+		b_skipFrame = midFrame;
+		s_capture = ReplayData();
+		s_capture.scene = scene;
+		s_capture.seed = seed;
+		b_capturing = true;
+	}
+
+	void Replay::CaptureFrame(double deltaTime, int fixedUpdates)
+	{
+		if (!b_capturing) return;
+		if (b_skipFrame) {
+			b_skipFrame = false;
+			return;
+		}
+		s_capture.frames.push_back({ deltaTime, fixedUpdates, Input::GetSnapshot() });
+	}
+
+	bool Replay::StopCapture(const std::string& path)
+	{
+		if (!b_capturing) return false;
+		b_capturing = false;
+		try {
+			std::ofstream file(path, std::ios::binary);
+			if (!file.is_open()) throw std::runtime_error("cannot open file");
+			cereal::BinaryOutputArchive oarchive(file);
+			oarchive(s_capture);
+		}
+		catch (std::exception& e) {
+			WARN("Failed to write replay {}: {}", path, e.what());
+			return false;
+		}
+		LOG("Captured {} frames to {}", s_capture.frames.size(), path);
+		s_capture = ReplayData();
+		return true;
+	}
+
+	bool Replay::LoadPlayback(const std::string& path)
+	{
+		s_playback = ReplayData();
+		try {
+			std::ifstream file(path, std::ios::binary);
+			if (!file.is_open()) throw std::runtime_error("cannot open file");
+			cereal::BinaryInputArchive iarchive(file);
+			iarchive(s_playback);
+		}
+		catch (std::exception& e) {
+			WARN("Failed to read replay {}: {}", path, e.what());
+			s_playback = ReplayData();
+			return false;
+		}
+		return true;
+	}
+
+	static bool isTiming(const std::string& column)
+	{
+		static const std::string suffix = " [ms]";
+		return column.size() >= suffix.size() && column.compare(column.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	//	Reads a Profiler recording into one list of values per timing column.
+	static bool readTimings(const std::string& path, std::map<std::string, std::vector<double>>& timings)
+	{
+		std::ifstream file(path);
+		if (!file.is_open()) return false;
+		std::string line, cell;
+		if (!std::getline(file, line)) return false;
+		std::vector<std::string> names;
+		std::stringstream header(line);
+		while (std::getline(header, cell, ',')) names.push_back(cell);
+		while (std::getline(file, line)) {
+			std::stringstream row(line);
+			for (size_t i = 0; std::getline(row, cell, ',') && i < names.size(); i++) {
+				if (cell.empty() || !isTiming(names[i])) continue;
+				timings[names[i]].push_back(std::atof(cell.c_str()));
+			}
+		}
+		return true;
+	}
+
+	static void summarize(std::vector<double>& values, double& mean, double& p95)
+	{
+		mean = values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+		if (values.empty()) {
+			p95 = 0.0;
+			return;
+		}
+		size_t index = (size_t)(values.size() * 0.95);
+		if (index >= values.size()) index = values.size() - 1;
+		std::nth_element(values.begin(), values.begin() + index, values.end());
+		p95 = values[index];
+	}
+
+	//	Differences of a timing below this many ms are jitter, however fine the timer that measured it.
+	static const double s_noiseFloor = 0.05;
+
+	//	Smallest step between two distinct values of a column, the resolution it was measured with.
+	static double resolution(std::vector<double> values)
+	{
+		std::sort(values.begin(), values.end());
+		double step = 0.0;
+		for (size_t i = 1; i < values.size(); i++) {
+			double gap = values[i] - values[i - 1];
+			if (gap > 0.0 && (step == 0.0 || gap < step)) step = gap;
+		}
+		return step;
+	}
+
+	int Replay::DiffRecordings(const std::string& baseline, const std::string& candidate, double threshold)
+	{
+		std::map<std::string, std::vector<double>> before, after;
+		if (!readTimings(baseline, before) || !readTimings(candidate, after)) {
+			std::cout << "Unable to read " << baseline << " or " << candidate << std::endl;
+			return -1;
+		}
+		int regressions = 0;
+		std::cout << fmt::format("{:<40} {:>12} {:>12} {:>12} {:>12}", "Timing", "mean before", "mean after", "p95 before", "p95 after") << std::endl;
+		for (auto& [name, values] : before) {
+			auto it = after.find(name);
+			if (it == after.end()) continue;
+			// differences within a step of the coarser recording are rounding, e.g. recordings made with whole ms timers
+			double noise = std::max({ s_noiseFloor, resolution(values), resolution(it->second) });
+			double meanBefore, p95Before, meanAfter, p95After;
+			summarize(values, meanBefore, p95Before);
+			summarize(it->second, meanAfter, p95After);
+			bool slower = (meanAfter > meanBefore * (1.0 + threshold) && meanAfter - meanBefore > noise) ||
+				(p95After > p95Before * (1.0 + threshold) && p95After - p95Before > noise);
+			if (slower) regressions++;
+			std::cout << fmt::format("{:<40} {:>12.3f} {:>12.3f} {:>12.3f} {:>12.3f}{}", name, meanBefore, meanAfter, p95Before, p95After, slower ? "  REGRESSION" : "") << std::endl;
+		}
+		std::cout << regressions << " regression(s)" << std::endl;
+		return regressions;
+	}
+
+}
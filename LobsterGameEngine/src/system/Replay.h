@@ -0,0 +1,60 @@
+#pragma once
+#include "system/Input.h"
+
+namespace Lobster
+{
+
+	struct ReplayFrame
+	{
+		double deltaTime;	// ms
+		int fixedUpdates;	// FixedUpdate calls in this frame
+		InputSnapshot input;
+		template <class Archive>
+		void serialize(Archive& ar)
+		{
+			ar(deltaTime, fixedUpdates, input);
+		}
+	};
+
+	//	Everything needed to re-simulate a game session: the scene as it was when the game started,
+	//	the random seed, and per frame the time step, fixed update count and input.
+	struct ReplayData
+	{
+		static constexpr uint Version = 1;
+		unsigned long long seed = 0;
+		std::string scene;	// serialized scene
+		std::vector<ReplayFrame> frames;
+		template <class Archive>
+		void serialize(Archive& ar)
+		{
+			uint version = Version;
+			ar(version);
+			if (version != Version) throw std::runtime_error("Unsupported replay version " + std::to_string(version));
+			ar(seed, scene, frames);
+		}
+	};
+
+	//	Captures game sessions and loads them back for headless re-simulation (see Config::replayCapturePath / replayPath).
+	//	Comparing the per-frame profiler recordings of two re-simulations (DiffRecordings) finds performance regressions.
+	class Replay
+	{
+	private:
+		static bool b_capturing;
+		static bool b_skipFrame;
+		static ReplayData s_capture;
+		static ReplayData s_playback;
+	public:
+		//	midFrame: the game begins during the current frame, which is then not captured.
+		static void StartCapture(const std::string& scene, unsigned long long seed, bool midFrame);
+		//	Call once per frame, after the frame is simulated.
+		static void CaptureFrame(double deltaTime, int fixedUpdates);
+		static bool StopCapture(const std::string& path);
+		inline static bool IsCapturing() { return b_capturing; }
+		static bool LoadPlayback(const std::string& path);
+		inline static const ReplayData& GetPlayback() { return s_playback; }
+		//	Compares two Profiler recordings of the same replay, column by column for every timing.
+		//	Prints the mean and 95th percentile of both and returns how many timings got slower than threshold (0.1 = 10%).
+		static int DiffRecordings(const std::string& baseline, const std::string& candidate, double threshold);
+	};
+
+}
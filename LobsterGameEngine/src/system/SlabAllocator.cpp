@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "SlabAllocator.h"
+
+namespace Lobster
+{
+
+	SlabAllocator& SlabAllocator::Get()
+	{
+		//	Function-local so that objects created during static initialization can still be allocated.
+		//	Intentionally leaked, so blocks freed during static destruction still land in a valid free list.
+		static SlabAllocator* instance = new SlabAllocator;
+		return *instance;
+	}
+
+	void* SlabAllocator::Allocate(size_t size)
+	{
+		if (size == 0) size = 1;
+		if (size > MaxBlockSize) return ::operator new(size);
+
+		SlabAllocator& allocator = Get();
+		size_t index = (size - 1) / Granularity;
+		size_t blockSize = (index + 1) * Granularity;
+		std::lock_guard<std::mutex> lock(allocator.m_mutex);
+		SizeClass& sizeClass = allocator.m_classes[index];
+		//	Carve a new slab into blocks when the free list runs dry
+		if (!sizeClass.freeList) {
+			byte* slab = static_cast<byte*>(::operator new(SlabSize));
+			sizeClass.slabs.push_back(slab);
+			size_t count = SlabSize / blockSize;
+			for (size_t i = count; i > 0; --i) {
+				FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * blockSize);
+				block->next = sizeClass.freeList;
+				sizeClass.freeList = block;
+			}
+		}
+		FreeBlock* block = sizeClass.freeList;
+		sizeClass.freeList = block->next;
+		sizeClass.live++;
+		allocator.m_allocCount++;
+		return block;
+	}
+
+	void SlabAllocator::Free(void* ptr, size_t size)
+	{
+		if (!ptr) return;
+		if (size == 0) size = 1;
+		if (size > MaxBlockSize) {
+			::operator delete(ptr);
+			return;
+		}
+
+		SlabAllocator& allocator = Get();
+		std::lock_guard<std::mutex> lock(allocator.m_mutex);
+		SizeClass& sizeClass = allocator.m_classes[(size - 1) / Granularity];
+		FreeBlock* block = static_cast<FreeBlock*>(ptr);
+		block->next = sizeClass.freeList;
+		sizeClass.freeList = block;
+		sizeClass.live--;
+		allocator.m_freeCount++;
+	}
+
+	size_t SlabAllocator::GetLiveCount()
+	{
+		SlabAllocator& allocator = Get();
+		std::lock_guard<std::mutex> lock(allocator.m_mutex);
+		size_t live = 0;
+		for (const SizeClass& sizeClass : allocator.m_classes) live += sizeClass.live;
+		return live;
+	}
+
+	size_t SlabAllocator::GetSlabCount()
+	{
+		SlabAllocator& allocator = Get();
+		std::lock_guard<std::mutex> lock(allocator.m_mutex);
+		size_t slabs = 0;
+		for (const SizeClass& sizeClass : allocator.m_classes) slabs += sizeClass.slabs.size();
+		return slabs;
+	}
+
+	void SlabAllocator::ConsumeChurn(size_t& allocs, size_t& frees)
+	{
+		SlabAllocator& allocator = Get();
+		std::lock_guard<std::mutex> lock(allocator.m_mutex);
+		allocs = allocator.m_allocCount;
+		frees = allocator.m_freeCount;
+		allocator.m_allocCount = 0;
+		allocator.m_freeCount = 0;
+	}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+namespace Lobster
+{
+
+	//	Size-class slab allocator for small objects that are created and destroyed all the time (game objects, components).
+	//	Blocks are carved out of fixed size slabs and recycled through a free list per size class,
+	//	so allocation and deallocation are O(1) and objects of the same size end up packed next to each other.
+	//	Requests larger than MaxBlockSize fall back to the global heap.
+	class SlabAllocator
+	{
+	public:
+		static constexpr size_t Granularity = 16;
+		static constexpr size_t MaxBlockSize = 1024;
+		static constexpr size_t SlabSize = 64 * 1024;
+	private:
+		struct FreeBlock { FreeBlock* next; };
+		struct SizeClass
+		{
+			FreeBlock* freeList = nullptr;
+			std::vector<byte*> slabs;
+			size_t live = 0;
+		};
+		SizeClass m_classes[MaxBlockSize / Granularity];
+		std::mutex m_mutex;
+		size_t m_allocCount = 0;
+		size_t m_freeCount = 0;
+		static SlabAllocator& Get();
+		SlabAllocator() = default;
+	public:
+		static void* Allocate(size_t size);
+		static void Free(void* ptr, size_t size);
+		//	Number of blocks currently handed out across all size classes.
+		static size_t GetLiveCount();
+		static size_t GetSlabCount();
+		//	Returns the number of allocations and deallocations since the last call, then resets both counters.
+		static void ConsumeChurn(size_t& allocs, size_t& frees);
+	};
+
+	//	Inherit from this to route new / delete of a class hierarchy through the SlabAllocator.
+	//	Deletion through a base pointer must go through a virtual destructor so the right size is passed back.
+	struct SlabAllocated
+	{
+		static void* operator new(size_t size) { return SlabAllocator::Allocate(size); }
+		static void operator delete(void* ptr, size_t size) { SlabAllocator::Free(ptr, size); }
+	};
+
+}
@@ -56,7 +56,7 @@ namespace Lobster
 				endTime = m_endTime;
 			}
 
-			return std::chrono::duration_cast<std::chrono::milliseconds>(endTime - m_startTime).count();
+			return milliseconds_type(endTime - m_startTime).count();
 		}
 
 		double GetDeltaTime()
@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "system/UndoSystem.h"
+#include "objects/GameObject.h"
 
 namespace Lobster {
 	UndoSystem* UndoSystem::m_instance = nullptr;
@@ -43,6 +44,7 @@ namespace Lobster {
 			m_undo_str.pop_front();
 			m_redo.push(event);
 			event->Undo();
+			markDirty(event);
 			LOG("Undo performed. Description: {}", event->ToString());
 		}
 	}
@@ -59,6 +61,7 @@ namespace Lobster {
 			m_undo.push(event);
 			m_undo_str.push(event->ToString());
 			event->Exec();
+			markDirty(event);
 			LOG("Redo performed. Description: {}", event->ToString());
 		}
 	}
@@ -78,6 +81,11 @@ namespace Lobster {
 		return redo_strings;
 	}
 
+	void UndoSystem::markDirty(Command* command) {
+		GameObject* target = command->GetTarget();
+		if (target) target->MarkDirty();
+	}
+
 	void UndoSystem::Push(Command* command) {
 		while (!m_redo.empty()) {
 			delete m_redo.top();
@@ -89,6 +97,7 @@ namespace Lobster {
 		if (c != nullptr) delete c;
 
 		m_undo_str.push(command->ToString());
+		markDirty(command);
 		
 		// Set the modified flag as true (the asterisk * display in title)
 		Application::GetInstance()->SetSaved(false);
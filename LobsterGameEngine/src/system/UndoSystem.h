@@ -30,6 +30,8 @@ namespace Lobster {
 
 	private:
 		static UndoSystem* m_instance;
+		//	Flags the object touched by command so that the next save re-serializes it.
+		void markDirty(Command* command);
 		CircularBuffer<Command*> m_undo;
 		CircularBuffer<std::string> m_undo_str;
 		std::stack<Command*> m_redo;
@@ -0,0 +1,17 @@
+#pragma once
+
+namespace Lobster {
+	//	Helpers for the cereal archives of scenes. Call by Serialization::func_name().
+	namespace Serialization {
+		//	Reads a field saved with cereal::make_nvp(name, ...) if it is the next node of the archive, for the fields
+		//	added after scenes were saved without them. Returns false and leaves value untouched when it is not there.
+		template <class T>
+		inline bool LoadOptional(cereal::JSONInputArchive& ar, const char* name, T& value)
+		{
+			const char* next = ar.getNodeName();
+			if (!next || strcmp(next, name) != 0) return false;
+			ar(cereal::make_nvp(name, value));
+			return true;
+		}
+	}
+}
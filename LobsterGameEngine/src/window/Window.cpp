@@ -3,6 +3,7 @@
 #include "events/EventCollection.h"
 #include "events/EventDispatcher.h"
 #include "events/EventQueue.h"
+#include "system/Input.h"
 #include "stb_image.h"
 
 namespace Lobster
@@ -91,6 +92,7 @@ namespace Lobster
 
 		/* Listen for GLFW Callback */
 		glfwSetKeyCallback(m_window, [](GLFWwindow* window, int key, int scancode, int action, int mods) {
+			Input::OnKey(key, action);
 			switch (action) {
 			case GLFW_PRESS:
 				EventQueue::GetInstance()->AddEvent<KeyPressedEvent>(key, false, mods);
@@ -104,6 +106,7 @@ namespace Lobster
 			}
 		});
 		glfwSetMouseButtonCallback(m_window, [](GLFWwindow* window, int button, int action, int mods) {
+			Input::OnMouseButton(button, action);
 			switch (action) {
 			case GLFW_PRESS:
 				EventQueue::GetInstance()->AddEvent<MousePressedEvent>(button, false);
@@ -117,6 +120,7 @@ namespace Lobster
 			}
 		});
 		glfwSetScrollCallback(m_window, [](GLFWwindow* window, double xOffset, double yOffset) {
+			Input::OnScroll(xOffset, yOffset);
 			EventQueue::GetInstance()->AddEvent<MouseScrolledEvent>((float)xOffset, (float)yOffset);
 		});
 		glfwSetWindowCloseCallback(m_window, [](GLFWwindow* window) {
@@ -127,15 +131,15 @@ namespace Lobster
 		});
 
 		/* Listen for Lobster Callback */
-		//EventDispatcher::AddCallback(EVENT_KEY_PRESSED, new EventCallback<KeyPressedEvent>([this](KeyPressedEvent* e) {
+		//EventChannel<KeyPressedEvent>::Subscribe([this](KeyPressedEvent* e) {
 		//	if (e->Key == GLFW_KEY_ESCAPE)
 		//	{
 		//		b_isRunning = false;
 		//	}
-		//}));
-		EventDispatcher::AddCallback(EVENT_WINDOW_CLOSED, new EventCallback<WindowClosedEvent>([this](WindowClosedEvent* e) {
+		//});
+		EventChannel<WindowClosedEvent>::Subscribe([this](WindowClosedEvent* e) {
 			b_isRunning = false;
-		}));
+		});
 
 		b_isRunning = true;
 	}
@@ -0,0 +1,53 @@
+#pragma once
+
+namespace Lobster
+{
+
+	//	The positional arguments of a tool command, read in order after its name. A required argument
+	//	that is missing makes the command line invalid, an optional one gives its default value.
+	class Arguments
+	{
+	public:
+		static constexpr int Invalid = 2;	// exit code of a command run with invalid arguments, main prints its usage
+	private:
+		int m_argc;
+		char** m_argv;
+		int m_next = 2;			// argv[1] is the command
+		bool b_valid = true;
+		const char* next()
+		{
+			return m_next < m_argc ? m_argv[m_next++] : nullptr;
+		}
+	public:
+		Arguments(int argc, char** argv) : m_argc(argc), m_argv(argv) {}
+		inline const char* GetCommand() const { return m_argc >= 2 ? m_argv[1] : ""; }
+		const char* String()
+		{
+			const char* value = next();
+			if (!value) b_valid = false;
+			return value ? value : "";
+		}
+		const char* String(const char* defaultValue)
+		{
+			const char* value = next();
+			return value ? value : defaultValue;
+		}
+		int Int()
+		{
+			return std::atoi(String());
+		}
+		int Int(int defaultValue)
+		{
+			const char* value = next();
+			return value ? std::atoi(value) : defaultValue;
+		}
+		size_t Count(size_t defaultValue)
+		{
+			const char* value = next();
+			return value ? (size_t)std::strtoull(value, nullptr, 10) : defaultValue;
+		}
+		//	Whether every required argument was given. Check it before running the command.
+		inline bool IsValid() const { return b_valid; }
+	};
+
+}
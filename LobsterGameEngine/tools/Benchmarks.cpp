@@ -0,0 +1,383 @@
+#include "pch.h"
+#include "Benchmarks.h"
+#include "Arguments.h"
+#include "Application.h"
+#include "audio/AudioStream.h"
+#include "audio/AudioSystem.h"
+#include "components/MeshComponent.h"
+#include "events/EventQueue.h"
+#include "graphics/2D/GlyphAtlas.h"
+#include "graphics/2D/SpriteBatcher.h"
+#include "graphics/ParticlePool.h"
+#include "graphics/ParticleSorter.h"
+#include "graphics/Scene.h"
+#include "objects/GameObject.h"
+#include "objects/Prefab.h"
+#include "scripts/Script.h"
+#include "scripts/ScriptProfiler.h"
+#include "system/MemoryTracker.h"
+#include "system/Random.h"
+#include "system/SlabAllocator.h"
+
+namespace Lobster
+{
+
+	int ParticleBenchmark(Arguments& args)
+	{
+		size_t count = args.Count(1000000);
+		const int frames = 300;
+		ParticlePool pool(count);
+		Random random(1);
+		auto spawn = [&](float age) {
+			glm::vec3 velocity(random.Range(-1.0f, 1.0f), random.Range(2.0f, 5.0f), random.Range(-1.0f, 1.0f));
+			float lifetime = random.Range(1.0f, 5.0f);
+			pool.Emit(glm::vec3(0.0f), velocity, lifetime, 1.0f, 0xFFFFFFFF, age * lifetime);
+		};
+		for (size_t i = 0; i < count; i++) {
+			spawn(random.NextFloat());
+		}
+		std::vector<ParticleVertex> vertices(count);
+		ParticleForces forces;
+		forces.gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+		forces.drag = 0.1f;
+		auto start = HighResolutionClock::now();
+		for (int frame = 0; frame < frames; frame++) {
+			pool.Integrate(1.0f / 60.0f, forces);
+			size_t killed = pool.Kill();
+			for (size_t i = 0; i < killed; i++) {
+				spawn(0.0f);
+			}
+			pool.WriteVertices(vertices.data());
+		}
+		double frameTime = milliseconds_type(HighResolutionClock::now() - start).count() / frames;
+		std::cout << count << " particles: " << frameTime << " ms / frame" << std::endl;
+		return 0;
+	}
+
+	int SortBenchmark(Arguments& args)
+	{
+		size_t count = args.Count(100000);
+		const int frames = 300;
+		ThreadPool::Initialize(std::max(1u, std::thread::hardware_concurrency()));
+		ParticlePool pool(count);
+		Random random(1);
+		for (size_t i = 0; i < count; i++) {
+			glm::vec3 position(random.Range(-10.0f, 10.0f), random.Range(-10.0f, 10.0f), random.Range(-10.0f, 10.0f));
+			glm::vec3 velocity(random.Range(-1.0f, 1.0f), random.Range(-1.0f, 1.0f), random.Range(-1.0f, 1.0f));
+			pool.Emit(position, velocity, FLT_MAX);
+		}
+		const glm::vec3 eye(0.0f, 0.0f, 30.0f);
+		ParticleForces forces;
+		ParticleSorter radix, incremental;
+		double radixTime = 0.0, incrementalTime = 0.0;
+		for (int frame = 0; frame < frames; frame++) {
+			pool.Integrate(1.0f / 60.0f, forces);
+			auto start = HighResolutionClock::now();
+			radix.Reset();
+			radix.Sort(pool, eye);
+			auto middle = HighResolutionClock::now();
+			incremental.Sort(pool, eye);
+			auto end = HighResolutionClock::now();
+			radixTime += milliseconds_type(middle - start).count();
+			incrementalTime += milliseconds_type(end - middle).count();
+		}
+		std::cout << count << " particles: " << radixTime / frames << " ms / radix sort, " << incrementalTime / frames << " ms / incremental sort" << std::endl;
+		return 0;
+	}
+
+	int AudioStreamBenchmark(Arguments& args)
+	{
+		const char* path = args.String();
+		const char* dir = args.String();
+		if (!args.IsValid()) return Arguments::Invalid;
+		AudioSystem::Initialize(dir);
+		AudioClip* clip = AudioSystem::AddAudioClip(path);
+		if (!clip) return 1;
+		auto start = HighResolutionClock::now();
+		clip->Play();
+		while (clip->GetSourceState() == AL_PLAYING) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+		double seconds = std::chrono::duration<double>(HighResolutionClock::now() - start).count();
+		size_t underruns = clip->GetStream()->GetUnderruns();
+		long long peak = MemoryTracker::GetPeakBytes(MEMORY_AUDIO);
+		std::cout << path << ": played " << seconds << " s, " << underruns << " underruns, peak audio memory " << peak / 1024 << " KB" << std::endl;
+		AudioSystem::Shutdown();
+		return underruns == 0 ? 0 : 1;
+	}
+
+	int AudioCallbackBenchmark(Arguments& args)
+	{
+		const char* path = args.String();
+		int count = args.Int();
+		const char* dir = args.String();
+		if (!args.IsValid()) return Arguments::Invalid;
+		// the callbacks come through the event queue, the ThreadPool is never started
+		EventQueue::Initialize();
+		EventDispatcher::Initialize();
+		AudioSystem::Initialize(dir);
+		int finished = 0;
+		auto start = HighResolutionClock::now();
+		for (int i = 0; i < count; i++) {
+			AudioClip* clip = AudioSystem::AddAudioClip(path);
+			if (!clip) return 1;
+			clip->Play([&finished]() { finished++; });
+		}
+		while (finished < count) {
+			while (Event* event = EventQueue::GetInstance()->Next()) {
+				EventDispatcher::Dispatch(event);
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		double seconds = std::chrono::duration<double>(HighResolutionClock::now() - start).count();
+		std::cout << count << " clips finished in " << seconds << " s on 1 audio thread" << std::endl;
+		AudioSystem::Shutdown();
+		return 0;
+	}
+
+	int TextBenchmark(Arguments& args)
+	{
+		const char* path = args.String();
+		int pixelSize = args.Int(24);
+		int frames = args.Int(3600);
+		if (!args.IsValid() || frames < 1) return Arguments::Invalid;
+		GlyphAtlas* atlas = GlyphAtlas::Use(path, pixelSize);
+		if (!atlas) return 1;
+		FT_Face face = atlas->GetFace();
+		std::vector<GlyphQuad> quads;
+		std::vector<byte> buffer;
+		double atlasTime = 0.0, renderTime = 0.0;
+		for (int frame = 0; frame < frames; frame++) {
+			// a score going up every frame
+			std::string text = "Score: " + std::to_string(frame * 10);
+			auto start = HighResolutionClock::now();
+			quads.clear();
+			atlas->Layout(text, 0.f, pixelSize * 2 * 0.66f, quads);
+			auto middle = HighResolutionClock::now();
+			// measure, then render into a new RGBA buffer, one glyph at a time
+			int pixelWidth = 0;
+			for (unsigned char c : text) {
+				FT_Load_Char(face, c, FT_LOAD_RENDER);
+				pixelWidth += face->glyph->bitmap.width ? face->glyph->bitmap.width : (face->glyph->advance.x >> 6);
+			}
+			int ww = pixelSize * (int)text.size();
+			int hh = pixelSize * 2;
+			buffer.assign((size_t)ww * hh * 4, 0);
+			int off = std::max(0, (ww - pixelWidth) / 2);	// centered
+			for (unsigned char c : text) {
+				FT_Load_Char(face, c, FT_LOAD_RENDER);
+				const FT_Bitmap& bmp = face->glyph->bitmap;
+				int top = (int)(hh * 0.66) - face->glyph->bitmap_top;
+				for (int h = 0; h < (int)bmp.rows; h++) {
+					for (int w = 0; w < (int)bmp.width; w++) {
+						int px = off + w, py = top + h;
+						if (px < 0 || px >= ww || py < 0 || py >= hh) continue;
+						byte* pixel = &buffer[((size_t)py * ww + px) * 4];
+						pixel[0] = pixel[1] = pixel[2] = 255;
+						pixel[3] = bmp.buffer[h * bmp.width + w];
+					}
+				}
+				off += face->glyph->advance.x >> 6;
+			}
+			auto end = HighResolutionClock::now();
+			atlasTime += milliseconds_type(middle - start).count();
+			renderTime += milliseconds_type(end - middle).count();
+		}
+		std::cout << frames << " changes at " << pixelSize << " px: " << atlasTime / frames << " ms / change with the glyph atlas, " << renderTime / frames << " ms / change rendering the string" << std::endl;
+		GlyphAtlas::Shutdown();
+		return 0;
+	}
+
+	//	A HUD: count sprites in layers z layers, each layer mixing the textures. Sprite i uses texture
+	//	i % textures and the layer i % layers.
+	static void buildHud(FrameVector<RenderOverlayCommand>& commands, size_t count, int textures, int layers)
+	{
+		commands.reserve(count);
+		for (size_t i = 0; i < count; i++) {
+			RenderOverlayCommand command;
+			// only compared, never bound
+			command.UseTexture = reinterpret_cast<Texture2D*>((uintptr_t)(i % textures + 1) * 64);
+			command.x = (float)(i % 64) * 16.f;
+			command.y = (float)(i / 64) * 16.f;
+			command.w = command.h = 16.f;
+			command.alpha = 1.f;
+			command.z = (int)(i % layers);
+			commands.push_back(command);
+		}
+	}
+
+	//	Whether batching huds gives the draw calls it should, prints the cases that don't.
+	static bool checkBatches()
+	{
+		struct Case { size_t count; int textures; int layers; size_t batches; };
+		const Case cases[] = {
+			{ 1000, 1, 4, 1 },		// one texture, whatever the layers
+			{ 9, 9, 1, 2 },			// one texture more than a draw samples
+			{ 16, 16, 2, 2 },		// 8 textures in each of 2 layers, a batch per layer
+			{ 1000, 20, 4, 3 }		// 5 textures in each of 4 layers: 5 + 3, 2 + 5 + 1, 4
+		};
+		SpriteBatcher batcher;
+		bool passed = true;
+		for (const Case& c : cases) {
+			FrameArena::NextFrame();
+			FrameVector<RenderOverlayCommand> commands;
+			buildHud(commands, c.count, c.textures, c.layers);
+			batcher.Build(commands);
+			if (batcher.GetBatchCount() != c.batches) {
+				std::cerr << c.count << " sprites, " << c.textures << " textures in " << c.layers << " layers: " << batcher.GetBatchCount() << " batches, expected " << c.batches << std::endl;
+				passed = false;
+			}
+		}
+		return passed;
+	}
+
+	int SpriteBenchmark(Arguments& args)
+	{
+		size_t count = args.Count(1000);
+		int textures = std::max(1, args.Int(4));
+		const int frames = 300;
+		if (!checkBatches()) return 1;
+		SpriteBatcher batcher;
+		double buildTime = 0.0;
+		for (int frame = 0; frame < frames; frame++) {
+			FrameArena::NextFrame();
+			FrameVector<RenderOverlayCommand> commands;
+			buildHud(commands, count, textures, 4);
+			auto start = HighResolutionClock::now();
+			batcher.Build(commands);
+			buildTime += milliseconds_type(HighResolutionClock::now() - start).count();
+		}
+		std::cout << count << " sprites, " << textures << " textures: " << buildTime / frames << " ms / frame, " << batcher.GetBatchCount() << " draw calls" << std::endl;
+		return 0;
+	}
+
+	//	Starts the engine without window nor renderer on an empty scene, for the benchmarks of scene objects.
+	static void startHeadless(Application& app)
+	{
+		app.GetConfig().headless = true;
+		app.Initialize();
+	}
+
+	int ChurnBenchmark(Arguments& args)
+	{
+		size_t count = args.Count(10000);
+		const int frames = 300;
+		Application app;
+		startHeadless(app);
+		Scene* scene = app.GetCurrentScene();
+		std::vector<GameObject*> spawned, previous;
+		size_t allocs, frees, slabAllocs = 0, slabFrees = 0;
+		SlabAllocator::ConsumeChurn(allocs, frees);
+		double frameTime = 0.0;
+		for (int frame = 0; frame < frames; frame++) {
+			auto start = HighResolutionClock::now();
+			// the objects of the last frame go, as many new ones come
+			for (GameObject* gameObject : previous) {
+				scene->DestroyGameObject(gameObject);
+			}
+			spawned.clear();
+			for (size_t i = 0; i < count; i++) {
+				GameObject* gameObject = new GameObject("churn");
+				scene->SpawnGameObject(gameObject);
+				spawned.push_back(gameObject);
+			}
+			scene->FlushPending();
+			frameTime += milliseconds_type(HighResolutionClock::now() - start).count();
+			std::swap(spawned, previous);
+			SlabAllocator::ConsumeChurn(allocs, frees);
+			slabAllocs += allocs;
+			slabFrees += frees;
+		}
+		std::cout << count << " objects spawned and destroyed per frame: " << frameTime / frames << " ms / frame, " << slabAllocs / frames << " slab allocs, " << slabFrees / frames << " slab frees / frame" << std::endl;
+		app.Shutdown();
+		return 0;
+	}
+
+	int ScriptBenchmark(Arguments& args)
+	{
+		size_t count = args.Count(10000);
+		const char* file = args.String("benchmarks/Update.lua");
+		const int frames = 300;
+		Application app;
+		startHeadless(app);
+		Scene* scene = app.GetCurrentScene();
+		auto start = HighResolutionClock::now();
+		Script* first = nullptr;
+		for (size_t i = 0; i < count; i++) {
+			GameObject* gameObject = new GameObject("script");
+			Script* script = new Script(file);
+			gameObject->AddComponent(script);
+			script->Bind();	// loaded before it had an object, pass it its transform now
+			scene->AddGameObject(gameObject);
+			if (!first) first = script;
+		}
+		scene->OnBegin();
+		double loadTime = milliseconds_type(HighResolutionClock::now() - start).count();
+		if (first && !first->GetErrmsg().empty()) {
+			std::cerr << file << ": " << first->GetErrmsg() << std::endl;
+			app.Shutdown();
+			return 1;
+		}
+		Script::ConsumeUpdateCalls();
+		double updateTime = 0.0;
+		for (int frame = 0; frame < frames; frame++) {
+			start = HighResolutionClock::now();
+			scene->OnUpdate(1000.0 / 60.0);
+			updateTime += milliseconds_type(HighResolutionClock::now() - start).count();
+			ScriptProfiler::EndFrame();
+			FrameArena::NextFrame();
+		}
+		size_t updates = Script::ConsumeUpdateCalls();
+		std::cout << count << " scripts: " << loadTime << " ms to load, " << updateTime / frames << " ms / frame, " << updates / frames << " updates / frame" << std::endl;
+		app.Shutdown();
+		return 0;
+	}
+
+	//	The JSON record of a game object, as saved in a scene.
+	static std::string record(GameObject* gameObject)
+	{
+		std::stringstream ss;
+		{
+			cereal::JSONOutputArchive oarchive(ss);
+			gameObject->Serialize(oarchive);
+		}
+		return ss.str();
+	}
+
+	int PrefabBenchmark(Arguments& args)
+	{
+		size_t count = args.Count(1000);
+		const char* mesh = args.String("meshes/Barrel_01.obj");
+		Application app;
+		startHeadless(app);
+		Scene* scene = app.GetCurrentScene();
+		GameObject* source = new GameObject("prefab");
+		source->AddComponent(new MeshComponent(FileSystem::Path(mesh).c_str()));
+		std::string full = record(source);
+		// the source stays alive until the end, so its mesh stays loaded for the copies
+		Prefab* prefab = Prefab::Create(source, FileSystem::Path("save/Benchmark.prefab").c_str());
+		auto start = HighResolutionClock::now();
+		GameObject* instance = nullptr;
+		for (size_t i = 0; i < count; i++) {
+			instance = prefab->Instantiate();
+			scene->AddGameObject(instance);
+		}
+		double instantiateTime = milliseconds_type(HighResolutionClock::now() - start).count();
+		size_t instanceSize = record(instance).size();
+		start = HighResolutionClock::now();
+		for (size_t i = 0; i < count; i++) {
+			GameObject* copy = new GameObject("copy");
+			std::stringstream ss(full);
+			cereal::JSONInputArchive iarchive(ss);
+			copy->Deserialize(iarchive);
+			scene->AddGameObject(copy);
+		}
+		double loadTime = milliseconds_type(HighResolutionClock::now() - start).count();
+		std::cout << count << " copies of " << mesh << ": " << instantiateTime / count << " ms / instance (" << instanceSize << " bytes saved), "
+			<< loadTime / count << " ms / full load (" << full.size() << " bytes saved)" << std::endl;
+		delete source;
+		app.Shutdown();
+		return 0;
+	}
+
+}
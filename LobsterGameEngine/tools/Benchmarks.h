@@ -0,0 +1,37 @@
+#pragma once
+
+namespace Lobster
+{
+
+	class Arguments;
+
+	//	The commands of LobsterBenchmarks, each reads its arguments and returns the exit code of the program.
+
+	//	[count]: simulates count particles (default 1M) for 300 frames at 60 Hz and prints the time per frame.
+	int ParticleBenchmark(Arguments& args);
+	//	[count]: depth sorts count moving particles (default 100k) for 300 frames and prints the time per sort,
+	//	with and without the order of the previous frame.
+	int SortBenchmark(Arguments& args);
+	//	<file> <dir>: streams an audio file to the null device in dir, prints the underruns and the peak audio memory.
+	int AudioStreamBenchmark(Arguments& args);
+	//	<file> <count> <dir>: plays count clips of an audio file with callbacks on the null device in dir, without a ThreadPool.
+	int AudioCallbackBenchmark(Arguments& args);
+	//	<font> [size] [frames]: changes a score text every frame (default 3600 frames, a minute at 60 Hz) and prints the
+	//	time per change with the glyph atlas, and rendering the whole string as text sprites used to (without the upload).
+	int TextBenchmark(Arguments& args);
+	//	[count] [textures]: batches count overlay sprites (default 1000) using textures textures (default 4) for 300
+	//	frames and prints the time per frame and the number of draw calls. Fails if huds with a known number of
+	//	draw calls don't batch to it.
+	int SpriteBenchmark(Arguments& args);
+	//	[count]: spawns count game objects (default 10k) every frame for 300 frames in a headless engine, destroying
+	//	the ones of the frame before, and prints the time per frame and the slab allocations.
+	int ChurnBenchmark(Arguments& args);
+	//	[count] [script]: updates count game objects (default 10k) each running a script under res/scripts (default
+	//	benchmarks/Update.lua) for 300 frames in a headless engine and prints the time per frame.
+	int ScriptBenchmark(Arguments& args);
+	//	[count] [mesh]: instantiates count copies (default 1000) of a prefab of a mesh under res (default
+	//	meshes/Barrel_01.obj) in a headless engine, then loads as many full records of the same object, and prints
+	//	the time per copy and the saved size of each.
+	int PrefabBenchmark(Arguments& args);
+
+}
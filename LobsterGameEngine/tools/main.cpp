@@ -0,0 +1,47 @@
+#include "pch.h"
+#include "Arguments.h"
+#include "Benchmarks.h"
+
+//	Entry point of LobsterBenchmarks, which runs one of the engine benchmarks outside the shipping engine:
+//	  LobsterBenchmarks <command> [arguments]
+//	See Benchmarks.h for what each command measures.
+
+namespace
+{
+	struct Command
+	{
+		const char* name;
+		const char* usage;
+		int (*run)(Lobster::Arguments& args);
+	};
+
+	const Command s_commands[] = {
+		{ "particles", "[count]", Lobster::ParticleBenchmark },
+		{ "sort", "[count]", Lobster::SortBenchmark },
+		{ "audio-stream", "<file> <dir>", Lobster::AudioStreamBenchmark },
+		{ "audio-callbacks", "<file> <count> <dir>", Lobster::AudioCallbackBenchmark },
+		{ "text", "<font> [size] [frames]", Lobster::TextBenchmark },
+		{ "sprites", "[count] [textures]", Lobster::SpriteBenchmark },
+		{ "churn", "[count]", Lobster::ChurnBenchmark },
+		{ "scripts", "[count] [script]", Lobster::ScriptBenchmark },
+		{ "prefab", "[count] [mesh]", Lobster::PrefabBenchmark }
+	};
+}
+
+int main(int argc, char** argv)
+{
+	Lobster::Arguments args(argc, argv);
+	std::string name = args.GetCommand();
+	for (const Command& command : s_commands)
+	{
+		if (name != command.name) continue;
+		int result = command.run(args);
+		if (result == Lobster::Arguments::Invalid)
+			std::cerr << "Usage: " << argv[0] << " " << command.name << " " << command.usage << std::endl;
+		return result;
+	}
+	std::cerr << "Usage: " << argv[0] << " <command> [arguments], commands:" << std::endl;
+	for (const Command& command : s_commands)
+		std::cerr << "  " << command.name << " " << command.usage << std::endl;
+	return Lobster::Arguments::Invalid;
+}
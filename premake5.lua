@@ -315,4 +315,99 @@ project "LobsterGameEngine"
 
 		defines {
 			"LOBSTER_PLATFORM_MAC"
-		}
\ No newline at end of file
+		}
+-- Benchmarks of the engine systems, kept out of the shipping executable (see LobsterGameEngine/tools/main.cpp)
+project "LobsterBenchmarks"
+	location "LobsterGameEngine"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	dependson { "GLFW", "GLAD", "ImGui", "ImGuizmo" }
+
+	defines "LOBSTER_BUILD_TEMPLATE"
+	targetdir "bin/%{cfg.buildcfg}/tools"
+	objdir "bin/int/%{cfg.buildcfg}/tools"
+	optimize "Full"
+
+	libdirs	{
+		"%{prj.location}/vendor/assimp/lib",
+		"%{prj.location}/vendor/openal/libs/Win64",
+		"%{prj.location}/vendor/freetype/win64",
+		"%{prj.location}/vendor/lua535/lua"
+	}
+
+	files {
+		"%{prj.location}/src/**.h",
+		"%{prj.location}/src/**.cpp",
+		"%{prj.location}/tools/**.h",
+		"%{prj.location}/tools/**.cpp"
+	}
+	removefiles { "%{prj.location}/src/main.cpp" }
+
+	includedirs {
+		"%{prj.location}/src",
+		"%{prj.location}/vendor/assimp/include",
+		"%{prj.location}/vendor/stb",
+		"%{prj.location}/vendor/cereal/include",
+		"%{prj.location}/vendor/glm",
+		"%{prj.location}/vendor/glfw/include",
+		"%{prj.location}/vendor/glad/include",
+		"%{prj.location}/vendor/imgui",
+		"%{prj.location}/vendor/imguizmo",
+		"%{prj.location}/vendor/json/include",
+		"%{prj.location}/vendor/spdlog/include",
+		"%{prj.location}/vendor/openal/include",
+		"%{prj.location}/vendor/freetype/include",
+		"%{prj.location}/vendor/lua535"
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+		debugdir "bin/%{cfg.buildcfg}/tools"
+		defines { "LOBSTER_PLATFORM_WIN" }
+
+		pchheader "pch.h"
+		pchsource "%{prj.location}/src/pch.cpp"
+
+		links {
+			"GLFW",
+			"assimp-vc140-mt",
+			"ImGui",
+			"ImGuizmo",
+			"GLAD",
+			"opengl32",
+			"OpenAL32",
+			"freetype"
+		}
+
+		local tools_path = "../bin/%{cfg.buildcfg}/tools/"
+		prebuildcommands {
+			"{MKDIR} " .. tools_path .. "resources/",
+			"{COPY} res/ " .. tools_path .. "resources/",
+			"{COPY} vendor/assimp/lib/ " .. tools_path,
+			"{COPY} vendor/lua535/lua/dll/ " .. tools_path,
+			"{COPY} vendor/freetype/win64/ " .. tools_path
+		}
+
+	filter "system:macosx"
+		pchheader "src/pch.h"
+		pchsource "%{prj.location}/src/pch.cpp"
+		xcodebuildsettings { ["ALWAYS_SEARCH_USER_PATHS"] = "YES" }
+
+		links {
+			"GLFW",
+			"assimp4.1.0",
+			"ImGui",
+			"ImGuizmo",
+			"GLAD",
+			"freetype",
+			"Cocoa.framework",
+			"OpenAL.framework",
+			"OpenGL.framework",
+			"IOKit.framework",
+			"CoreVideo.framework"
+		}
+
+		defines {
+			"LOBSTER_PLATFORM_MAC"
+		}